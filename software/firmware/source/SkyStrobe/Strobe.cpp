@@ -25,6 +25,7 @@
 #include "Strobe.h"
 #include "EEPROM.h"
 #include "TrafficHelper.h"
+#include "Threat.h"
 
 static int StrobePin = SOC_UNUSED_PIN;
 uint32_t StrobeSetupMarker = 0;
@@ -35,8 +36,24 @@ static bool StrobeState = false;   /* true = lit */
 static int StrobeOnMS  = 0;        /* how long each flash */
 static int StrobeOffMS = 0;        /* how long between flashes */
 static int alarm_level = ALARM_LEVEL_NONE;
+static int demand = 0;             /* threat level the pattern below is for */
+static strobe_pattern_t Pattern = { 0, 0, 0, 0, 0 };
 bool self_test_strobe = true;
 
+/*
+ * Choose the flash pattern for the given conspicuity demand (0..100)
+ * from the configured no-alarm and alarm patterns.  Cheap enough to
+ * redo on every pass, which also picks up changed settings.
+ */
+static void Strobe_Pattern(int new_demand)
+{
+  demand = new_demand;
+
+  strobe_pattern_t noalarm = { flashes_noalarm, ms_noalarm, gap_noalarm, 0, period_noalarm };
+  strobe_pattern_t alarm   = { flashes_alarm,   ms_alarm,   gap_alarm,   0, period_alarm   };
+  Threat_Pattern(demand, &noalarm, &alarm, &Pattern);
+}
+
 void Strobe_setup(void)
 {
   StrobePauseMarker = StrobeSetupMarker = millis();
@@ -60,15 +77,9 @@ void Strobe_Start()
 
     if (StrobePin != SOC_UNUSED_PIN) {
 
-        if (alarm_level >= ALARM_LEVEL_LOW) {
-          StrobeFlashes = flashes_alarm;
-          StrobeOnMS = ms_alarm;
-          StrobeOffMS = gap_alarm;
-        } else {
-          StrobeFlashes = flashes_noalarm;
-          StrobeOnMS = ms_noalarm;
-          StrobeOffMS = gap_noalarm;
-        }
+        StrobeFlashes = Pattern.flashes;
+        StrobeOnMS = Pattern.on_ms;
+        StrobeOffMS = Pattern.gap_ms;
 
         digitalWrite(StrobePin, HIGH);
         blue_LED(true);                  // defined in Sound.cpp
@@ -83,10 +94,13 @@ void Strobe_Start()
 
     if (settings->bridge != BRIDGE_SERIAL) {
         Serial.print("Strobe flash at alarm level: ");
-        Serial.println(alarm_level);
+        Serial.print(alarm_level);
+        Serial.print(" demand: ");
+        Serial.println(demand);
     }
     if (settings->protocol == PROTOCOL_NMEA) {
-        snprintf_P(NMEAbuf, sizeof(NMEAbuf)-4, PSTR("$PSKSF,%d*"), alarm_level);
+        snprintf_P(NMEAbuf, sizeof(NMEAbuf)-4, PSTR("$PSKSF,%d,%d,%d,%d,%d*"),
+            alarm_level, demand, Pattern.flashes, Pattern.on_ms, Pattern.period_ms);
         NMEA_Out(NMEAbuf);
     }
 }
@@ -147,15 +161,18 @@ void Strobe_loop(void)
           if (millis() > StrobeSetupMarker + 1000 * self_test_sec)
               self_test_strobe = false;
           alarm_level = ((millis() & 0x6000) == 0x6000) ? ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
+          Strobe_Pattern(alarm_level > ALARM_LEVEL_NONE ? 100 : 0);
       } else {
           alarm_level = max_alarm_level;
+          Strobe_Pattern(Threat.demand);
       }
       if (settings->strobe == STROBE_ALWAYS || self_test_strobe ||
+           (settings->strobe == STROBE_ALARM && demand > 0) ||
            (settings->strobe == STROBE_AIRBORNE && 
                 (ThisAircraft.airborne ||                /* fail safe: */
                   (hasGNSS() == false && millis() > StrobeSetupMarker + 360000)))) {
-         uint32_t pause_ms = alarm_level > ALARM_LEVEL_NONE ? pause_alarm : pause_noalarm;
-         if (millis() > StrobePauseMarker + pause_ms)
+         /* re-evaluated on every pass, so a new threat cuts a long pause short */
+         if (millis() > StrobePauseMarker + Pattern.pause_ms)
              Strobe_Start();
       }
   }
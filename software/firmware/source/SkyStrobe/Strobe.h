@@ -36,6 +36,12 @@
 #define STROBE_PERIOD_NOALARM   2400
 #define STROBE_MS_PAUSE_NOALARM (2400-STROBE_FLASHES_NOALARM*(STROBE_MS_NOALARM+STROBE_MS_GAP)+STROBE_MS_GAP)
 
+/* limits on the patterns interpolated between the two above by the traffic
+   threat level: no more than 100 bursts a minute (the upper limit for an
+   anticollision light in FAR 23.1401), and the LEDs lit 20% of the time */
+#define STROBE_MIN_PERIOD        600
+#define STROBE_MAX_DUTY           20   /* percent */
+
 /* even if not airborne, demo strobe and sound for the first 2 minutes as a test */
 #define STROBE_INITIAL_RUN        60
 
@@ -0,0 +1,86 @@
+/*
+ * Threat.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "Threat.h"
+#include "Strobe.h"
+
+/*
+ * Seconds to the closest point of approach, assuming straight tracks,
+ * or -1 if not converging.  The other aircraft is at (north, east)
+ * meters from us, speeds are in m/s, tracks in degrees.
+ * Also returns the predicted horizontal miss distance.
+ */
+float Threat_TCPA(float north, float east, float speed, float track,
+                  float own_speed, float own_track, float *miss)
+{
+  float trk = track * (float) (M_PI / 180.0);
+  float own_trk = own_track * (float) (M_PI / 180.0);
+
+  /* velocity of the other aircraft relative to us, m/s */
+  float vn = speed * cosf(trk) - own_speed * cosf(own_trk);
+  float ve = speed * sinf(trk) - own_speed * sinf(own_trk);
+  float v2 = vn * vn + ve * ve;
+  if (v2 < 1.0)
+      return -1;
+
+  float t = -(north * vn + east * ve) / v2;
+  if (t < 0)
+      return -1;        /* diverging */
+
+  float n = north + vn * t;
+  float e = east  + ve * t;
+  *miss = sqrtf(n * n + e * e);
+  return t;
+}
+
+/*
+ * The flash pattern for the given conspicuity demand (0..100), between
+ * the no-alarm pattern (at 0) and the alarm pattern (at 100), within
+ * the rate and duty-cycle limits.  The pause fields of the inputs are
+ * not used, it is derived from the interpolated period.
+ */
+void Threat_Pattern(int demand, const strobe_pattern_t *noalarm,
+                    const strobe_pattern_t *alarm, strobe_pattern_t *out)
+{
+#define LERP(a,b)  (((int)(a) * (100 - demand) + (int)(b) * demand + 50) / 100)
+
+  int flashes = LERP(noalarm->flashes,   alarm->flashes);
+  int on_ms   = LERP(noalarm->on_ms,     alarm->on_ms);
+  int gap_ms  = LERP(noalarm->gap_ms,    alarm->gap_ms);
+  int period  = LERP(noalarm->period_ms, alarm->period_ms);
+
+  if (flashes < 1)
+      flashes = 1;
+  if (period < STROBE_MIN_PERIOD)
+      period = STROBE_MIN_PERIOD;
+  int lit = flashes * on_ms;
+  if (lit * 100 > period * STROBE_MAX_DUTY)
+      period = (lit * 100) / STROBE_MAX_DUTY;
+  int pause = period - flashes * (on_ms + gap_ms) + gap_ms;
+  if (pause < gap_ms)
+      pause = gap_ms;
+
+  out->flashes   = flashes;
+  out->on_ms     = on_ms;
+  out->gap_ms    = gap_ms;
+  out->pause_ms  = pause;
+  out->period_ms = period;
+}
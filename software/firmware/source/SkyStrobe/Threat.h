@@ -0,0 +1,38 @@
+/*
+ * Threat.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAT_H
+#define THREAT_H
+
+/* the arithmetic behind the threat-driven strobe pattern, no Arduino
+   dependencies so that it also builds on a host (see tests/test_strobe.cpp) */
+
+typedef struct strobe_pattern_struct {
+    int       flashes;    /* flashes in a burst */
+    int       on_ms;      /* length of each flash */
+    int       gap_ms;     /* between flashes in a burst */
+    int       pause_ms;   /* from the end of the last flash to the next burst */
+    int       period_ms;  /* from burst to burst */
+} strobe_pattern_t;
+
+float Threat_TCPA(float north, float east, float speed, float track,
+                  float own_speed, float own_track, float *miss);
+void  Threat_Pattern(int demand, const strobe_pattern_t *noalarm,
+                  const strobe_pattern_t *alarm, strobe_pattern_t *out);
+
+#endif /* THREAT_H */
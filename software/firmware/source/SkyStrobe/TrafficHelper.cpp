@@ -23,6 +23,7 @@
 #include "NMEAHelper.h"
 #include "EEPROMHelper.h"
 #include "Sound.h"
+#include "Threat.h"
 
 #include "SkyStrobe.h"
 
@@ -31,8 +32,10 @@ traffic_by_dist_t traffic[MAX_TRACKING_OBJECTS];
 
 static unsigned long UpdateTrafficTimeMarker = 0;
 static unsigned long Traffic_Sound_TimeMarker = 0;
+static unsigned long Traffic_Threat_TimeMarker = 0;
 
 int max_alarm_level = ALARM_LEVEL_NONE;       /* global, used for visual displays */
+threat_t Threat = { 0, 0, THREAT_HORIZON, 0 };  /* global, used for strobe pattern */
 
 
 void Traffic_Add()
@@ -151,7 +154,6 @@ static void Traffic_Sound()
 //  int bearing;
 //  char message[80];
   int sound_level_ndx = 0;
-  max_alarm_level = ALARM_LEVEL_NONE;          /* global, used for strobe pattern */
   int sound_alarm_level = ALARM_LEVEL_NONE;    /* local, used for sound alerts */
 
   for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
@@ -159,11 +161,6 @@ static void Traffic_Sound()
 
        if ((ThisAircraft.timestamp <= Container[i].timestamp + SOUND_EXPIRATION_TIME)) {
 
-         /* find the maximum alarm level, whether to be alerted or not */
-         if (Container[i].alarm_level > max_alarm_level) {
-             max_alarm_level = Container[i].alarm_level;
-         }
-
          /* figure out what is the highest alarm level needing a sound alert */
          if (Container[i].alarm_level > sound_alarm_level
                   && Container[i].alarm_level > Container[i].alert_level) {
@@ -192,17 +189,125 @@ static void Traffic_Sound()
 
 }
 
+/*
+ * Seconds to the closest point of approach, assuming straight tracks,
+ * or -1 if not converging or if the position is not known.
+ * Also returns the predicted horizontal miss distance.
+ */
+static float Traffic_TCPA(traffic_t *fop, float *miss)
+{
+  if (fop->RelativeNorth == 0 && fop->RelativeEast == 0)
+      return -1;        /* PFLAU only, position unknown */
+
+  float own_speed = ThisAircraft.GroundSpeed;
+  if (settings->protocol == PROTOCOL_NMEA)
+      own_speed *= _GPS_MPS_PER_KNOT;          /* from RMC, in knots */
+
+  return Threat_TCPA(fop->RelativeNorth, fop->RelativeEast,
+                     fop->GroundSpeed, fop->Track,
+                     own_speed, ThisAircraft.Track, miss);
+}
+
+/*
+ * Scan all current traffic for threats: aircraft predicted to pass
+ * within THREAT_MISS_DIST within THREAT_HORIZON seconds, or signaled
+ * as an alarm by the FLARM device.  The demand rises as the time to
+ * the closest approach shrinks, is weighted towards traffic ahead
+ * (which can see our strobe), and rises further with more threats.
+ */
+static void Traffic_Threat()
+{
+  int max_score = 0;
+  int count = 0;
+  float min_tcpa = THREAT_HORIZON;
+  int bearing = 0;
+
+  max_alarm_level = ALARM_LEVEL_NONE;
+
+  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    traffic_t *fop = &Container[i];
+    if (fop->ID == 0)
+        continue;
+    if (ThisAircraft.timestamp > fop->timestamp + SOUND_EXPIRATION_TIME)
+        continue;
+
+    /* find the maximum alarm level, whether to be alerted or not */
+    if (fop->alarm_level > max_alarm_level)
+        max_alarm_level = fop->alarm_level;
+
+    float tcpa = THREAT_HORIZON + 1;
+    if (fabs(fop->RelativeVertical) <= VERTICAL_SEPARATION) {
+        float miss;
+        float t = Traffic_TCPA(fop, &miss);
+        if (t >= 0 && miss <= THREAT_MISS_DIST)
+            tcpa = t;
+    }
+    /* FLARM alarm levels imply an upper bound on the time to impact */
+    if (fop->alarm_level >= ALARM_LEVEL_URGENT)
+        tcpa = min(tcpa, 8.0f);
+    else if (fop->alarm_level == ALARM_LEVEL_IMPORTANT)
+        tcpa = min(tcpa, 12.0f);
+    else if (fop->alarm_level == ALARM_LEVEL_LOW)
+        tcpa = min(tcpa, 18.0f);
+    if (tcpa > THREAT_HORIZON)
+        continue;
+
+    ++count;
+
+    int rel;
+    if (fop->RelativeNorth == 0 && fop->RelativeEast == 0) {
+        rel = fop->RelativeBearing;
+    } else {
+        rel = (int) degrees(atan2f(fop->RelativeEast, fop->RelativeNorth))
+                - (int) ThisAircraft.Track;
+        if (rel > 180)   rel -= 360;
+        if (rel < -180)  rel += 360;
+    }
+
+    int score;
+    if (tcpa <= THREAT_URGENT)
+        score = 100;
+    else
+        score = (int) (100 * (THREAT_HORIZON - tcpa) / (THREAT_HORIZON - THREAT_URGENT));
+    score = (score * (3 + cos(radians(rel)))) / 4;  /* head-on 1, from behind 1/2 */
+
+    if (score > max_score || count == 1) {
+        max_score = score;
+        bearing = rel;
+    }
+    if (tcpa < min_tcpa)
+        min_tcpa = tcpa;
+  }
+
+  if (count > 1)
+      max_score += THREAT_EXTRA * (count - 1);
+  if (max_score > 100)
+      max_score = 100;
+  if (count > 0 && max_score == 0)
+      max_score = 1;          /* any threat at all counts */
+
+  Threat.demand  = max_score;
+  Threat.count   = count;
+  Threat.tcpa    = (uint8_t) min_tcpa;
+  Threat.bearing = bearing;
+}
+
 void Traffic_setup()
 {
   UpdateTrafficTimeMarker = millis();
   Traffic_Sound_TimeMarker = millis();
+  Traffic_Threat_TimeMarker = millis();
 }
 
 void Traffic_loop()
 {
   time_t timenow = now();
   if (timenow > ThisAircraft.timestamp + ENTRY_EXPIRATION_TIME) {
-      return;    /* data stream broken */
+      /* data stream broken, do not keep flashing for stale threats */
+      max_alarm_level = ALARM_LEVEL_NONE;
+      Threat.demand = 0;
+      Threat.count = 0;
+      return;
   }
 
   if (isTimeToUpdateTraffic()) {
@@ -219,6 +324,11 @@ void Traffic_loop()
     UpdateTrafficTimeMarker = millis();
   }
 
+  if (isTimeToThreat()) {
+      Traffic_Threat();
+      Traffic_Threat_TimeMarker = millis();
+  }
+
   if (isTimeToSound()) {
       Traffic_Sound();
       Traffic_Sound_TimeMarker = millis();
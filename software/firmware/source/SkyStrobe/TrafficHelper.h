@@ -84,6 +84,20 @@ typedef struct traffic_by_dist_struct {
 
 #define TRAFFIC_ALERT_SOUND     1
 
+/* conspicuity demand, computed from all current traffic, drives the strobe */
+#define isTimeToThreat()        (millis() - Traffic_Threat_TimeMarker > 500)
+#define THREAT_HORIZON          30   /* seconds to CPA, ignore traffic farther out in time */
+#define THREAT_URGENT            8   /* seconds to CPA, full demand at or below this */
+#define THREAT_MISS_DIST       300   /* meters, predicted miss distance counted as a threat */
+#define THREAT_EXTRA            10   /* demand added for each additional threat */
+
+typedef struct threat_struct {
+    uint8_t   demand;     /* 0 = no threat, 100 = use the full alarm pattern */
+    uint8_t   count;      /* number of threats within the horizon */
+    uint8_t   tcpa;       /* seconds to the nearest closest approach */
+    int16_t   bearing;    /* relative bearing of the most pressing threat, -180..180 */
+} threat_t;
+
 void Traffic_setup        (void);
 void Traffic_loop         (void);
 void Traffic_Add          (void);
@@ -96,5 +110,6 @@ int  traffic_cmp_by_distance(const void *, const void *);
 extern traffic_t ThisAircraft, Container[MAX_TRACKING_OBJECTS], fo, EmptyFO;
 extern traffic_by_dist_t traffic[MAX_TRACKING_OBJECTS];
 extern int max_alarm_level;
+extern threat_t Threat;
 
 #endif /* TRAFFICHELPER_H */
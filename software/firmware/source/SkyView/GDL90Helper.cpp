@@ -25,6 +25,7 @@
 #include "NMEAHelper.h"
 #include "TrafficHelper.h"
 #include "WiFiHelper.h"
+#include "InputHelper.h"
 
 #include "SkyView.h"
 
@@ -32,21 +33,13 @@ extern "C" {
 #include <gdl90.h>
 }
 
-#define GDL90_RINGBUF_SIZE  sizeof(gdl_message_escaped_t)
-
 static unsigned long GDL90_Data_TimeMarker = 0;
 static unsigned long GDL90_HeartBeat_TimeMarker = 0;
 static unsigned long GDL90_OwnShip_TimeMarker = 0;
-static unsigned char gdl90_ringbuf[GDL90_RINGBUF_SIZE];
-static unsigned int gdl90buf_head = 0;
-static unsigned char prev_c = 0;
-
-gdl_message_t message;
+static float GDL90_geo_altitude = 0;   /* feet */
 
-gdl90_msg_heartbeat heartbeat;
-gdl90_msg_traffic_report_t gdl_traffic;
-gdl90_msg_traffic_report_t ownship;
-gdl90_msg_ownship_geo_altitude geo_altitude;
+/* a framer per input source, so that bytes from two ports never mix */
+static gdl90_stream_t gdl90_stream[INPUT_SRC_COUNT];
 
 const uint8_t gdl90_to_aircraft_type[] PROGMEM = {
 	AIRCRAFT_TYPE_UNKNOWN,
@@ -67,150 +60,96 @@ const uint8_t gdl90_to_aircraft_type[] PROGMEM = {
 	AIRCRAFT_TYPE_RESERVED
 };
 
-static void GDL90_Parse_Character(char c)
+static void GDL90_HeartBeat(gdl90_msg_heartbeat *heartbeat)
 {
-    unsigned int gdl90buf_tail;
-    size_t msg_size;
-
-    if (c == GDL90_CONTROL_ESCAPE) {
-      prev_c = c;
-      return;
-    } else if (prev_c == GDL90_CONTROL_ESCAPE) {
-      prev_c = c;
-      c ^= GDL90_ESCAPE_BYTE;
-    } else {
-      prev_c = c;
-    }
-
-    gdl90_ringbuf[gdl90buf_head % GDL90_RINGBUF_SIZE] = c;
-    gdl90buf_head++;
-
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_HEARTBEAT + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_HEARTBEAT) {
-
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
-
-      if (decode_gdl90_heartbeat(&message, &heartbeat)) {
-
-//      print_gdl90_heartbeat(&heartbeat);
-
-        GDL90_HeartBeat_TimeMarker = millis();
-      }
-    }
-
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_OWNSHIP_GEOMETRIC + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_OWNSHIP_GEOMETRIC) {
-
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
-
-      decode_gdl90_ownship_geo_altitude(&message, &geo_altitude);
-//    print_gdl90_ownship_geo_altitude(&geo_altitude);
-    }
+//  print_gdl90_heartbeat(heartbeat);
 
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_TRAFFIC_REPORT + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_TRAFFIC_REPORT) {
-
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
-
-      if (decode_gdl90_traffic_report(&message, &gdl_traffic)) {
-
-//      print_gdl90_traffic_report(&gdl_traffic);
+  GDL90_HeartBeat_TimeMarker = millis();
+}
 
-        fo = EmptyFO;
+static void GDL90_GeoAltitude(gdl90_msg_ownship_geo_altitude *geo_altitude)
+{
+//  print_gdl90_ownship_geo_altitude(geo_altitude);
 
-        fo.ID          = gdl_traffic.address;
-        fo.IDType      = gdl_traffic.addressType == ADS_B_WITH_ICAO_ADDRESS ?
-                                          ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
+  GDL90_geo_altitude = geo_altitude->ownshipGeoAltitude;
+}
 
-        fo.latitude    = gdl_traffic.latitude;
-        fo.longitude   = gdl_traffic.longitude;
-        fo.altitude    = gdl_traffic.altitude  / _GPS_FEET_PER_METER;
+static void GDL90_Traffic(gdl90_msg_traffic_report_t *gdl_traffic)
+{
+//  print_gdl90_traffic_report(gdl_traffic);
 
-        fo.alarm_level = gdl_traffic.trafficAlertStatus == TRAFFIC_ALERT ?
-                                            ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
-        fo.Track       = gdl_traffic.trackOrHeading;           // degrees
-        fo.ClimbRate   = gdl_traffic.verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
-        fo.TurnRate    = 0;
-        fo.GroundSpeed = gdl_traffic.horizontalVelocity * _GPS_MPS_PER_KNOT;
-        fo.AcftType    = GDL90_TO_AT(gdl_traffic.emitterCategory);
+  fo = EmptyFO;
 
-        memcpy(fo.callsign, gdl_traffic.callsign, sizeof(fo.callsign));
+  fo.ID          = gdl_traffic->address;
+  fo.IDType      = gdl_traffic->addressType == ADS_B_WITH_ICAO_ADDRESS ?
+                                    ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
 
-        fo.timestamp   = now();
+  fo.latitude    = gdl_traffic->latitude;
+  fo.longitude   = gdl_traffic->longitude;
+  fo.altitude    = gdl_traffic->altitude  / _GPS_FEET_PER_METER;
 
-        Traffic_Update(&fo);
-        Traffic_Add();
-      }
-    }
+  fo.alarm_level = gdl_traffic->trafficAlertStatus == TRAFFIC_ALERT ?
+                                      ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
+  fo.Track       = gdl_traffic->trackOrHeading;           // degrees
+  fo.ClimbRate   = gdl_traffic->verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
+  fo.TurnRate    = 0;
+  fo.GroundSpeed = gdl_traffic->horizontalVelocity * _GPS_MPS_PER_KNOT;
+  fo.AcftType    = GDL90_TO_AT(gdl_traffic->emitterCategory);
 
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_OWNSHIP_REPORT + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_OWNSHIP_REPORT) {
+  memcpy(fo.callsign, gdl_traffic->callsign, sizeof(fo.callsign));
 
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
+  fo.timestamp   = now();
 
-      if (decode_gdl90_traffic_report(&message, &ownship)) {
+  Traffic_Update(&fo);
+  Traffic_Add();
+}
 
-//      print_gdl90_traffic_report(&ownship);
+static void GDL90_OwnShip(gdl90_msg_traffic_report_t *ownship)
+{
+//  print_gdl90_traffic_report(ownship);
 
-        ThisAircraft.ID          = ownship.address;
-        ThisAircraft.IDType      = ownship.addressType == ADS_B_WITH_ICAO_ADDRESS ?
-                                          ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
+  ThisAircraft.ID          = ownship->address;
+  ThisAircraft.IDType      = ownship->addressType == ADS_B_WITH_ICAO_ADDRESS ?
+                                    ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
 
-        ThisAircraft.latitude    = ownship.latitude;
-        ThisAircraft.longitude   = ownship.longitude;
+  ThisAircraft.latitude    = ownship->latitude;
+  ThisAircraft.longitude   = ownship->longitude;
 
-        if (ownship.altitude != 101375 /* 0xFFF */ ) {
-          ThisAircraft.altitude  = ownship.altitude / _GPS_FEET_PER_METER;
-        } else if (geo_altitude.ownshipGeoAltitude != 0) {
-          ThisAircraft.altitude  = geo_altitude.ownshipGeoAltitude / _GPS_FEET_PER_METER;
-        }
+  if (ownship->altitude != 101375 /* 0xFFF */ ) {
+    ThisAircraft.altitude  = ownship->altitude / _GPS_FEET_PER_METER;
+  } else if (GDL90_geo_altitude != 0) {
+    ThisAircraft.altitude  = GDL90_geo_altitude / _GPS_FEET_PER_METER;
+  }
 
-        ThisAircraft.alarm_level = ownship.trafficAlertStatus == TRAFFIC_ALERT ?
-                                            ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
-        ThisAircraft.Track       = ownship.trackOrHeading;           // degrees
-        ThisAircraft.ClimbRate   = ownship.verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
-        ThisAircraft.TurnRate    = 0;
-        ThisAircraft.GroundSpeed = ownship.horizontalVelocity * _GPS_MPS_PER_KNOT;
-        ThisAircraft.AcftType    = GDL90_TO_AT(ownship.emitterCategory);
+  ThisAircraft.alarm_level = ownship->trafficAlertStatus == TRAFFIC_ALERT ?
+                                      ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
+  ThisAircraft.Track       = ownship->trackOrHeading;           // degrees
+  ThisAircraft.ClimbRate   = ownship->verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
+  ThisAircraft.TurnRate    = 0;
+  ThisAircraft.GroundSpeed = ownship->horizontalVelocity * _GPS_MPS_PER_KNOT;
+  ThisAircraft.AcftType    = GDL90_TO_AT(ownship->emitterCategory);
 
-        memcpy(ThisAircraft.callsign, ownship.callsign, sizeof(ThisAircraft.callsign));
+  memcpy(ThisAircraft.callsign, ownship->callsign, sizeof(ThisAircraft.callsign));
 
-        ThisAircraft.timestamp   = now();
+  ThisAircraft.timestamp   = now();
 
-        GDL90_OwnShip_TimeMarker = millis();
-      }
-    }
+  GDL90_OwnShip_TimeMarker = millis();
 }
 
+static const gdl90_callbacks_t GDL90_callbacks = {
+  GDL90_HeartBeat,
+  GDL90_OwnShip,
+  GDL90_GeoAltitude,
+  GDL90_Traffic
+};
+
 void GDL90_setup()
 {
   if (settings->protocol == PROTOCOL_GDL90) {
 
     gdl90_crcInit();
+    for (int src = 0; src < INPUT_SRC_COUNT; src++)
+      gdl90_stream_init(&gdl90_stream[src]);
 
     switch (settings->connection)
     {
@@ -321,55 +260,52 @@ void GDL90_bridge_buffer(char c)
 void GDL90_loop()
 {
   size_t size;
+  uint8_t batch[INPUT_BATCH];
 
   switch (settings->connection)
   {
   case CON_SERIAL:
-    while (SerialInput.available() > 0) {
-      char c = SerialInput.read();
-      GDL90_bridge_buffer(c);
-      GDL90_Parse_Character(c);
+    /* the serial port, then the microUSB port, each a batch at a time */
+    for (int src = INPUT_SRC_SERIAL; src <= INPUT_SRC_USB; src++) {
+      size = Input_read(src, batch, sizeof(batch));
+      if (size == 0)
+        continue;
+      for (size_t i=0; i < size; i++)
+        GDL90_bridge_buffer(batch[i]);
+      gdl90_stream_parse(&gdl90_stream[src], batch, size, &GDL90_callbacks);
       GDL90_Data_TimeMarker = millis();
     }
-    /* read data from microUSB port */
-#if !defined(RASPBERRY_PI)
-    if (Serial != SerialInput)
-#endif
-    {
-      while (Serial.available() > 0) {
-        char c = Serial.read();
-        GDL90_bridge_buffer(c);
-        GDL90_Parse_Character(c);
-        GDL90_Data_TimeMarker = millis();
-      }
-    }
     break;
   case CON_WIFI_UDP:
-    size = SoC->WiFi_Receive_UDP((uint8_t *) UDPpacketBuffer, sizeof(UDPpacketBuffer));
-    if (size > 0) {
+    /* everything queued since the last pass, one datagram at a time */
+    while ((size = SoC->WiFi_Receive_UDP((uint8_t *) UDPpacketBuffer,
+                                         sizeof(UDPpacketBuffer))) > 0) {
       for (size_t i=0; i < size; i++) {
         char c = UDPpacketBuffer[i];
         if (settings->bridge == BRIDGE_SERIAL)
             GDL90_bridge_buffer(c);   // only output complete sentences
         else
             Serial.print(c);          // as received, unfiltered
-        GDL90_Parse_Character(c);
       }
+      /* whole datagram through the framer in one pass */
+      gdl90_stream_parse(&gdl90_stream[INPUT_SRC_SERIAL],
+                         (const uint8_t *) UDPpacketBuffer,
+                         size, &GDL90_callbacks);
       GDL90_Data_TimeMarker = millis();
     }
     break;
   case CON_BLUETOOTH_SPP:
   case CON_BLUETOOTH_LE:
-    if (SoC->Bluetooth) {
-      while (SoC->Bluetooth->available() > 0) {
-        char c = SoC->Bluetooth->read();
+    size = Input_read(INPUT_SRC_BT, batch, sizeof(batch));
+    if (size > 0) {
+      for (size_t i=0; i < size; i++) {
         if (settings->bridge == BRIDGE_SERIAL)
-            GDL90_bridge_buffer(c);
+            GDL90_bridge_buffer(batch[i]);
         else
-            Serial.print(c);
-        GDL90_Parse_Character(c);
-        GDL90_Data_TimeMarker = millis();
+            Serial.print((char) batch[i]);
       }
+      gdl90_stream_parse(&gdl90_stream[INPUT_SRC_BT], batch, size, &GDL90_callbacks);
+      GDL90_Data_TimeMarker = millis();
     }
     break;
   case CON_NONE:
@@ -0,0 +1,232 @@
+/*
+ * InputHelper.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SoCHelper.h"
+#include "EEPROMHelper.h"
+#include "NMEAHelper.h"
+#include "GDL90Helper.h"
+#include "TrafficHelper.h"
+#include "InputHelper.h"
+
+#include "SkyView.h"
+
+input_ring_t input_ring[INPUT_SRC_COUNT];
+
+static inline uint16_t Input_waiting(input_ring_t *rp)
+{
+  return (uint16_t) (rp->head - rp->tail) & (INPUT_RING_SIZE - 1);
+}
+
+static inline bool Input_room(input_ring_t *rp)
+{
+  return (Input_waiting(rp) < INPUT_RING_SIZE - 1);
+}
+
+/* the caller has checked Input_room() */
+static inline void Input_put(input_ring_t *rp, uint8_t c)
+{
+  uint16_t head = rp->head;
+  rp->buf[head] = c;
+  rp->head = (head + 1) & (INPUT_RING_SIZE - 1);
+  rp->bytes++;
+}
+
+static void Input_done(input_ring_t *rp, bool pending)
+{
+  uint16_t waiting = Input_waiting(rp);
+  if (waiting > rp->peak)
+    rp->peak = waiting;
+  if (pending)
+    rp->full++;
+}
+
+#if defined(RASPBERRY_PI)
+static FILE *replay_file = NULL;
+static unsigned long replay_TimeMarker = 0;
+
+/*
+ * Feed a recorded input stream (as captured from the serial port, NMEA or
+ * GDL90) through the same rings and parsers as live input, at the rate of
+ * a 38400 baud port.  At the end of the file, report and exit.
+ */
+bool Input_replay(const char *path)
+{
+  replay_file = fopen(path, "rb");
+  if (replay_file == NULL) {
+    perror(path);
+    return false;
+  }
+  settings->connection = CON_SERIAL;
+  replay_TimeMarker = millis();
+  return true;
+}
+
+static void Input_replay_pump()
+{
+  input_ring_t *rp = &input_ring[INPUT_SRC_SERIAL];
+  unsigned long elapsed = millis() - replay_TimeMarker;
+  size_t due = (elapsed * INPUT_REPLAY_BPS) / 1000;
+
+  if (due == 0)
+    return;
+  replay_TimeMarker += (due * 1000) / INPUT_REPLAY_BPS;
+
+  int c = 0;
+  while (due-- > 0 && Input_room(rp) && (c = fgetc(replay_file)) != EOF)
+    Input_put(rp, (uint8_t) c);
+  Input_done(rp, false);
+
+  if (c == EOF && Input_waiting(rp) == 0) {
+    printf("Replay done: %u bytes, peak %u waiting, %d aircraft at end\n",
+           rp->bytes, rp->peak, Traffic_Count());
+    fclose(replay_file);
+    replay_file = NULL;
+    exit(EXIT_SUCCESS);
+  }
+}
+#endif /* RASPBERRY_PI */
+
+/*
+ * Move whatever the devices have received into the rings.  Where there
+ * is a pump task, only it may call this.
+ */
+void Input_pump()
+{
+  input_ring_t *rp;
+
+  switch (settings->connection)
+  {
+  case CON_SERIAL:
+#if defined(RASPBERRY_PI)
+    if (replay_file) {
+      Input_replay_pump();
+      break;
+    }
+#endif
+    rp = &input_ring[INPUT_SRC_SERIAL];
+    while (Input_room(rp) && SerialInput.available() > 0)
+      Input_put(rp, SerialInput.read());
+    Input_done(rp, SerialInput.available() > 0);
+
+    /* data from microUSB port */
+#if !defined(RASPBERRY_PI)
+    if ((void *) &Serial != (void *) &SerialInput)
+#endif
+    {
+      rp = &input_ring[INPUT_SRC_USB];
+      while (Input_room(rp) && Serial.available() > 0)
+        Input_put(rp, Serial.read());
+      Input_done(rp, Serial.available() > 0);
+    }
+    break;
+  case CON_BLUETOOTH_SPP:
+  case CON_BLUETOOTH_LE:
+    if (SoC->Bluetooth) {
+      rp = &input_ring[INPUT_SRC_BT];
+      while (Input_room(rp) && SoC->Bluetooth->available() > 0)
+        Input_put(rp, SoC->Bluetooth->read());
+      Input_done(rp, SoC->Bluetooth->available() > 0);
+    }
+    break;
+  case CON_WIFI_UDP:
+  case CON_NONE:
+  default:
+    break;
+  }
+}
+
+#if defined(INPUT_PUMP_TASK)
+#define INPUT_STACK_SZ    (256*8)
+static TaskHandle_t Input_Task_Handle = NULL;
+
+/*
+ * Runs on the same core as loop(), at a higher priority, so the ring
+ * indices need no more than being volatile: each is written by one side.
+ */
+static void Input_Task(void *pvParameters)
+{
+  for ( ;; ) {
+    Input_pump();
+    vTaskDelay(pdMS_TO_TICKS(INPUT_PUMP_MS));
+  }
+}
+#endif /* INPUT_PUMP_TASK */
+
+void Input_setup()
+{
+  switch (settings->protocol)
+  {
+  case PROTOCOL_GDL90:
+    GDL90_setup();
+    break;
+  case PROTOCOL_NMEA:
+  default:
+    NMEA_setup();
+    break;
+  }
+
+#if defined(INPUT_PUMP_TASK)
+  xTaskCreateUniversal(Input_Task, "Input pump", INPUT_STACK_SZ, NULL, 2,
+                       &Input_Task_Handle, CONFIG_ARDUINO_RUNNING_CORE);
+#endif
+}
+
+/* up to max bytes, all from one source */
+size_t Input_read(int src, uint8_t *buf, size_t max)
+{
+  input_ring_t *rp = &input_ring[src];
+  size_t n = 0;
+  uint16_t tail = rp->tail;
+  uint16_t head = rp->head;
+
+  while (n < max && tail != head) {
+    buf[n++] = rp->buf[tail];
+    tail = (tail + 1) & (INPUT_RING_SIZE - 1);
+  }
+  rp->tail = tail;
+  return n;
+}
+
+/* Parse a batch of what has come in, from each source */
+void Input_loop()
+{
+#if !defined(INPUT_PUMP_TASK)
+  Input_pump();
+#endif
+
+  switch (settings->protocol)
+  {
+  case PROTOCOL_GDL90:
+    GDL90_loop();
+    break;
+  case PROTOCOL_NMEA:
+  default:
+    NMEA_loop();
+    break;
+  }
+}
+
+void Input_fini()
+{
+#if defined(INPUT_PUMP_TASK)
+  if (Input_Task_Handle != NULL) {
+    vTaskDelete(Input_Task_Handle);
+    Input_Task_Handle = NULL;
+  }
+#endif
+}
@@ -0,0 +1,76 @@
+/*
+ * InputHelper.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUTHELPER_H
+#define INPUTHELPER_H
+
+/*
+ * Bytes from each input device are moved into a ring of their own as
+ * soon as they arrive, and parsed from there in batches by NMEA_loop()
+ * or GDL90_loop().  On the ESP32 the rings are filled by a task of their
+ * own, so that slow display, web or voice work in the main loop does not
+ * let the device buffers overflow.  Elsewhere they are filled at the start
+ * of each pass through Input_loop().  UDP input is already queued whole
+ * datagrams at a time, see libraries/UDPRing.
+ */
+
+enum
+{
+  INPUT_SRC_SERIAL,       /* SerialInput, or a replay file on the RPi */
+  INPUT_SRC_USB,          /* Serial, if not the same as SerialInput */
+  INPUT_SRC_BT,           /* Bluetooth SPP or LE */
+  INPUT_SRC_COUNT
+};
+
+#if defined(ESP8266)
+#define INPUT_RING_SIZE     1024      /* a power of 2 */
+#else
+#define INPUT_RING_SIZE     4096
+#endif
+#define INPUT_BATCH         512       /* bytes parsed per source per pass */
+
+#if defined(ESP32)
+#define INPUT_PUMP_TASK
+#define INPUT_PUMP_MS       10
+#endif
+
+#if defined(RASPBERRY_PI)
+#define INPUT_REPLAY_BPS    3840      /* as from a 38400 baud port */
+#endif
+
+typedef struct input_ring_struct {
+  uint8_t           buf[INPUT_RING_SIZE];
+  volatile uint16_t head;             /* written only by the pump */
+  volatile uint16_t tail;             /* written only by the parser */
+  uint32_t          bytes;
+  uint32_t          full;             /* times found full with input waiting */
+  uint16_t          peak;             /* most bytes waiting at once */
+} input_ring_t;
+
+void   Input_setup(void);
+void   Input_pump(void);
+void   Input_loop(void);
+void   Input_fini(void);
+size_t Input_read(int, uint8_t *, size_t);
+#if defined(RASPBERRY_PI)
+bool   Input_replay(const char *);
+#endif
+
+extern input_ring_t input_ring[INPUT_SRC_COUNT];
+
+#endif /* INPUTHELPER_H */
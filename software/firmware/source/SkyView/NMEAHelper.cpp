@@ -24,6 +24,7 @@
 #include "TrafficHelper.h"
 #include "EEPROMHelper.h"
 #include "WiFiHelper.h"
+#include "InputHelper.h"
 
 #include "SkyView.h"
 
@@ -409,6 +410,7 @@ void NMEA_bridge_buffer(char c)
 void NMEA_loop()
 {
   size_t size;
+  uint8_t batch[INPUT_BATCH];
 
 #if !defined(EXCLUDE_HEARTBEAT)
   char buf[40];
@@ -428,29 +430,27 @@ void NMEA_loop()
   switch (settings->connection)
   {
   case CON_SERIAL:
-    while (SerialInput.available() > 0) {
-      char c = SerialInput.read();
+    size = Input_read(INPUT_SRC_SERIAL, batch, sizeof(batch));
+    for (size_t i=0; i < size; i++) {
+      char c = batch[i];
       Serial.print(c);
       NMEA_bridge_buffer(c);
       NMEA_Parse_Character(c);
       NMEA_TimeMarker = millis();
     }
-    /* read data from microUSB port */
-#if !defined(RASPBERRY_PI)
-    if ((void *) &Serial != (void *) &SerialInput)
-#endif
-    {
-      while (Serial.available() > 0) {
-        char c = Serial.read();
-        NMEA_bridge_buffer(c);
-        NMEA_Parse_Character(c);
-        NMEA_TimeMarker = millis();
-      }
+    /* data from microUSB port */
+    size = Input_read(INPUT_SRC_USB, batch, sizeof(batch));
+    for (size_t i=0; i < size; i++) {
+      char c = batch[i];
+      NMEA_bridge_buffer(c);
+      NMEA_Parse_Character(c);
+      NMEA_TimeMarker = millis();
     }
     break;
   case CON_WIFI_UDP:
-    size = SoC->WiFi_Receive_UDP((uint8_t *) UDPpacketBuffer, sizeof(UDPpacketBuffer));
-    if (size > 0) {
+    /* everything queued since the last pass, one datagram at a time */
+    while ((size = SoC->WiFi_Receive_UDP((uint8_t *) UDPpacketBuffer,
+                                         sizeof(UDPpacketBuffer))) > 0) {
       for (size_t i=0; i < size; i++) {
         char c = UDPpacketBuffer[i];
         if (settings->bridge == BRIDGE_SERIAL)
@@ -464,16 +464,15 @@ void NMEA_loop()
     break;
   case CON_BLUETOOTH_SPP:
   case CON_BLUETOOTH_LE:
-    if (SoC->Bluetooth) {
-      while (SoC->Bluetooth->available() > 0) {
-        char c = SoC->Bluetooth->read();
-        if (settings->bridge == BRIDGE_SERIAL)
-            NMEA_bridge_buffer(c);
-        else
-            Serial.print(c);
-        NMEA_Parse_Character(c);
-        NMEA_TimeMarker = millis();
-      }
+    size = Input_read(INPUT_SRC_BT, batch, sizeof(batch));
+    for (size_t i=0; i < size; i++) {
+      char c = batch[i];
+      if (settings->bridge == BRIDGE_SERIAL)
+          NMEA_bridge_buffer(c);
+      else
+          Serial.print(c);
+      NMEA_Parse_Character(c);
+      NMEA_TimeMarker = millis();
     }
     break;
   case CON_NONE:
@@ -147,17 +147,8 @@ void OLED_loop()
         char brg_str [4];
         char elev_str[6];
 
-        for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-          if (Container[i].ID && (now() - Container[i].timestamp) <= OLED_EXPIRATION_TIME) {
-
-            traffic[j].fop = &Container[i];
-            traffic[j].distance = sqrtf(Container[i].RelativeNorth * Container[i].RelativeNorth +
-                                        Container[i].RelativeEast  * Container[i].RelativeEast);
-            j++;
-          }
-        }
-
-        qsort(traffic, j, sizeof(traffic_by_dist_t), traffic_cmp_by_distance);
+        /* already in order of distance */
+        j = Traffic_by_Distance(traffic, OLED_EXPIRATION_TIME);
 
         odisplay.fillRect(x, y, odisplay.width(), odisplay.height() - y, BLACK);
 
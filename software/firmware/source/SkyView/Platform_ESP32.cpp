@@ -968,9 +968,7 @@ static void ESP32_TTS(char *message, int voice)
           word = strtok (NULL, " ");
 
           yield();
-
-          /* Poll input source(s) */
-          Input_loop();
+          /* input keeps arriving into its rings from the pump task */
       }
 
       if (wdt_status) {
@@ -40,6 +40,8 @@
 #include "TrafficHelper.h"
 #include "EEPROMHelper.h"
 #include "WiFiHelper.h"
+#include <UDPRing.h>
+#include "InputHelper.h"
 #include "GDL90Helper.h"
 #include "BatteryHelper.h"
 #include "JSONHelper.h"
@@ -138,6 +140,8 @@ std::string input_line;
 #include <unistd.h>
 
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 
 static uint32_t SerialNumber = 0;
 
@@ -252,9 +256,77 @@ static void RPi_EPD_update(int val)
   EPD_Update_Sync(val);
 }
 
+static int RPi_UDP_fd = -1;
+
+static void RPi_UDP_setup()
+{
+  unsigned int port = (settings->protocol == PROTOCOL_GDL90 ?
+                       GDL90_DST_PORT : NMEA_UDP_PORT);
+  struct sockaddr_in addr;
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    perror("socket");
+    return;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port        = htons(port);
+
+  if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    perror("bind");
+    close(fd);
+    return;
+  }
+
+  RPi_UDP_fd = fd;
+  Serial.print(F("UDP server has started at port: "));
+  Serial.println(port);
+}
+
+/*
+ * Take as many datagrams as there is room for in the ring with a single
+ * recvmmsg() call, directly into the ring slots.  Anything more waits in
+ * the kernel socket buffer for the next pass - which is much larger than
+ * the ring, so unlike on the ESP nothing is dropped here.
+ */
+static void RPi_UDP_loop()
+{
+  struct mmsghdr     msgs[UDP_RING_FRAMES];
+  struct iovec       iov [UDP_RING_FRAMES];
+  struct sockaddr_in from[UDP_RING_FRAMES];
+
+  if (RPi_UDP_fd < 0)
+    return;
+
+  int n = UDP_Ring_Free();
+  if (n == 0)
+    return;
+
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < n; i++) {
+    iov[i].iov_base = UDP_Ring_Slot(i);
+    iov[i].iov_len  = UDP_RING_FRAME_SIZE;
+    msgs[i].msg_hdr.msg_iov     = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+    msgs[i].msg_hdr.msg_name    = &from[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+  }
+
+  int got = recvmmsg(RPi_UDP_fd, msgs, n, MSG_DONTWAIT, NULL);
+  for (int i = 0; i < got; i++) {
+    size_t size = msgs[i].msg_len;
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+      size = UDP_RING_FRAME_SIZE + 1;       /* counted as truncated */
+    UDP_Ring_Commit(from[i].sin_addr.s_addr, ntohs(from[i].sin_port), size, millis());
+  }
+}
+
 static size_t RPi_WiFi_Receive_UDP(uint8_t *buf, size_t max_size)
 {
-  return 0; /* TBD */
+  return UDP_Ring_Pop(buf, max_size);
 }
 
 static int RPi_WiFi_clients_count()
@@ -493,8 +565,8 @@ static void RPi_TTS(char *message, int voice)
         play_file(pcm_handle, filename, buf, frames);
         word = strtok (NULL, " ");
 
-        /* Poll input source(s) */
-        Input_loop();
+        /* collect input, to be parsed after the message */
+        Input_pump();
     }
 
     snd_pcm_drain(pcm_handle);
@@ -698,28 +770,16 @@ static void RPi_ParseSettings()
   }
 }
 
-/* Poll input source(s) */
-void Input_loop() {
-  switch (settings->protocol)
-  {
-  case PROTOCOL_GDL90:
-    GDL90_loop();
-    break;
-  case PROTOCOL_NMEA:
-  default:
-    NMEA_loop();
-    break;
-  }
-}
-
 int main(int argc, char *argv[])
 {
   bool isSysVinit = false;
+  const char *replay = NULL;
   int opt;
 
-  while ((opt = getopt(argc, argv, "b")) != -1) {
+  while ((opt = getopt(argc, argv, "br:")) != -1) {
       switch (opt) {
       case 'b': isSysVinit = true; break;
+      case 'r': replay = optarg; break;     /* recorded input to play back */
       default: break;
       }
   }
@@ -744,6 +804,10 @@ int main(int argc, char *argv[])
 
   RPi_ParseSettings();
 
+  if (replay && !Input_replay(replay)) {
+      exit(EXIT_FAILURE);
+  }
+
   Battery_setup();
   SoC->Button_setup();
 
@@ -779,16 +843,10 @@ int main(int argc, char *argv[])
     SoC_fini();
   }
 
-  switch (settings->protocol)
-  {
-  case PROTOCOL_GDL90:
-    GDL90_setup();
-    break;
-  case PROTOCOL_NMEA:
-  default:
-    NMEA_setup();
-    break;
-  }
+  Input_setup();
+
+  if (settings->connection == CON_WIFI_UDP)
+    RPi_UDP_setup();
 
   if (!SoC->DB_init()) {
       fprintf( stderr, "Unable to open aircrafts database(s)\n\n" );
@@ -806,10 +864,14 @@ int main(int argc, char *argv[])
 
     SoC->Button_loop();
 
+    RPi_UDP_loop();
+
     Input_loop();
 
     Traffic_loop();
 
+    Traffic_Publish();
+
     switch (hw_info.display)
     {
     case DISPLAY_EPD_2_7:
@@ -25,7 +25,9 @@
 #include <raspi/raspi.h>
 
 /* Maximum of tracked flying objects is now SoC-specific constant */
-#define MAX_TRACKING_OBJECTS    9
+#if !defined(MAX_TRACKING_OBJECTS)
+#define MAX_TRACKING_OBJECTS    20  /* up to 32 */
+#endif
 
 #define PCM_DEVICE              "default"
 #define WAV_FILE_PREFIX         "Audio/"
@@ -49,6 +49,7 @@
 #include "WebHelper.h"
 #include "BatteryHelper.h"
 #include "GDL90Helper.h"
+#include "InputHelper.h"
 
 #include "SkyView.h"
 
@@ -59,20 +60,6 @@ hardware_info_t hw_info = {
   .display  = DISPLAY_NONE
 };
 
-/* Poll input source(s) */
-void Input_loop() {
-  switch (settings->protocol)
-  {
-  case PROTOCOL_GDL90:
-    GDL90_loop();
-    break;
-  case PROTOCOL_NMEA:
-  default:
-    NMEA_loop();
-    break;
-  }
-}
-
 void setup()
 {
   hw_info.soc = SoC_setup(); // Has to be very first procedure in the execution order
@@ -92,16 +79,7 @@ void setup()
   Battery_setup();
   SoC->Button_setup();
 
-  switch (settings->protocol)
-  {
-  case PROTOCOL_GDL90:
-    GDL90_setup();
-    break;
-  case PROTOCOL_NMEA:
-  default:
-    NMEA_setup();
-    break;
-  }
+  Input_setup();
 
   /* If a Dongle is connected - try to wake it up */
   if (settings->connection == CON_SERIAL &&
@@ -144,6 +122,8 @@ void loop()
 
   Traffic_loop();
 
+  Traffic_Publish();
+
   EPD_loop();
 
   Traffic_ClearExpired();
@@ -169,6 +149,8 @@ void shutdown(const char *msg)
     SerialInput.flush();
   }
 
+  Input_fini();
+
   if (SoC->Bluetooth) {
     SoC->Bluetooth->fini();
   }
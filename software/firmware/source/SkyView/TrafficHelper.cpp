@@ -32,11 +32,192 @@
 traffic_t ThisAircraft, Container[MAX_TRACKING_OBJECTS], fo, EmptyFO;
 traffic_by_dist_t traffic[MAX_TRACKING_OBJECTS];
 
+/*
+ * The displays draw from a copy of Container[], nearest first, taken by
+ * Traffic_Publish() once per pass after the input has been parsed - so
+ * they see each update whole, and never an entry halfway through one.
+ */
+traffic_t TrafficSnapshot[MAX_TRACKING_OBJECTS];
+static int      snapshot_count = 0;
+static uint32_t snapshot_seq   = 0;
+static uint32_t traffic_seq    = 0;    /* bumped on every change */
+
 static unsigned long UpdateTrafficTimeMarker = 0;
 static unsigned long Traffic_Voice_TimeMarker = 0;
 
 int max_alarm_level = ALARM_LEVEL_NONE;
 
+/*
+ * Container[] is indexed by a small open-addressing hash table on ID,
+ * and the occupied slots are kept in order of distance (and alarm),
+ * so that lookups are O(1) and the display pages need not sort.
+ */
+static uint8_t hash_slot[TRAFFIC_HASH_SIZE];     /* Container index + 1, or 0 */
+static uint8_t dist_order[MAX_TRACKING_OBJECTS]; /* Container indices, nearest first */
+static uint8_t dist_pos[MAX_TRACKING_OBJECTS];   /* position of each index in dist_order */
+static uint8_t alarm_order[MAX_TRACKING_OBJECTS]; /* Container indices, most alarming first */
+static uint8_t alarm_pos[MAX_TRACKING_OBJECTS];
+static int     order_count = 0;
+
+static bool Traffic_Nearer(int a, int b)
+{
+  return (Container[a].distance < Container[b].distance);
+}
+
+/* higher alarm level first, then by distance adjusted for altitude difference */
+static bool Traffic_More_Alarming(int a, int b)
+{
+  if (Container[a].alarm_level != Container[b].alarm_level)
+    return (Container[a].alarm_level > Container[b].alarm_level);
+  return (Container[a].adj_dist < Container[b].adj_dist);
+}
+
+static inline uint32_t Traffic_Hash(uint32_t ID)
+{
+  return (ID ^ (ID >> 7) ^ (ID >> 15)) & (TRAFFIC_HASH_SIZE - 1);
+}
+
+static void Traffic_Hash_Insert(int ndx)
+{
+  uint32_t h = Traffic_Hash(Container[ndx].ID);
+  while (hash_slot[h])
+    h = (h + 1) & (TRAFFIC_HASH_SIZE - 1);
+  hash_slot[h] = ndx + 1;
+}
+
+/* after a removal the probe chains may be broken, so rebuild - it is tiny */
+static void Traffic_Hash_Rebuild()
+{
+  memset(hash_slot, 0, sizeof(hash_slot));
+  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    if (Container[i].ID)
+      Traffic_Hash_Insert(i);
+  }
+}
+
+int Traffic_Find(uint32_t ID)
+{
+  if (ID == 0)
+    return -1;
+
+  uint32_t h = Traffic_Hash(ID);
+  while (hash_slot[h]) {
+    int ndx = hash_slot[h] - 1;
+    if (Container[ndx].ID == ID)
+      return ndx;
+    h = (h + 1) & (TRAFFIC_HASH_SIZE - 1);
+  }
+  return -1;
+}
+
+/* move one entry up or down within an ordered view until it is in place */
+static void Traffic_Sift(uint8_t *order, uint8_t *pos, int ndx,
+                         bool (*before)(int, int))
+{
+  int p = pos[ndx];
+
+  while (p > 0 && before(ndx, order[p-1])) {
+    order[p] = order[p-1];
+    pos[order[p]] = p;
+    p--;
+  }
+  while (p < order_count - 1 && before(order[p+1], ndx)) {
+    order[p] = order[p+1];
+    pos[order[p]] = p;
+    p++;
+  }
+  order[p] = ndx;
+  pos[ndx] = p;
+}
+
+static void Traffic_Unlink(uint8_t *order, uint8_t *pos, int ndx)
+{
+  for (int p = pos[ndx]; p < order_count - 1; p++) {
+    order[p] = order[p+1];
+    pos[order[p]] = p;
+  }
+}
+
+void Traffic_Reorder(int ndx)
+{
+  if (Container[ndx].ID == 0)
+    return;
+  traffic_seq++;
+  Traffic_Sift(dist_order,  dist_pos,  ndx, Traffic_Nearer);
+  Traffic_Sift(alarm_order, alarm_pos, ndx, Traffic_More_Alarming);
+}
+
+void Traffic_Store(int ndx, traffic_t *fop)
+{
+  uint32_t oldID = Container[ndx].ID;
+
+  if (fop->ID == 0) {
+    Traffic_Remove(ndx);
+    return;
+  }
+
+  Container[ndx] = *fop;
+  traffic_seq++;
+
+  if (oldID == 0) {
+    /* new entry, append to the views then move into place */
+    dist_order[order_count]  = ndx;
+    dist_pos[ndx]            = order_count;
+    alarm_order[order_count] = ndx;
+    alarm_pos[ndx]           = order_count;
+    order_count++;
+    Traffic_Hash_Insert(ndx);
+  } else if (oldID != fop->ID) {
+    Traffic_Hash_Rebuild();
+  }
+
+  Traffic_Reorder(ndx);
+}
+
+void Traffic_Remove(int ndx)
+{
+  if (Container[ndx].ID == 0)
+    return;
+
+  Traffic_Unlink(dist_order,  dist_pos,  ndx);
+  Traffic_Unlink(alarm_order, alarm_pos, ndx);
+  order_count--;
+
+  Container[ndx] = EmptyFO;
+  traffic_seq++;
+  Traffic_Hash_Rebuild();
+}
+
+void Traffic_Publish()
+{
+  if (snapshot_seq == traffic_seq)
+    return;
+
+  for (int p=0; p < MAX_TRACKING_OBJECTS; p++)
+    TrafficSnapshot[p] = (p < order_count ? Container[dist_order[p]] : EmptyFO);
+  snapshot_count = order_count;
+  snapshot_seq   = traffic_seq;
+}
+
+/* fill a list of current traffic from the snapshot, nearest first */
+int Traffic_by_Distance(traffic_by_dist_t *list, time_t expiration)
+{
+  int j = 0;
+  time_t timenow = now();
+
+  for (int p=0; p < snapshot_count; p++) {
+    traffic_t *fop = &TrafficSnapshot[p];
+    if ((timenow - fop->timestamp) <= expiration) {
+      list[j].fop = fop;
+      list[j].distance = fop->distance;
+      j++;
+    }
+  }
+
+  return j;
+}
+
+
 void Traffic_Add()
 {
     // Traffic_Update(&fo);    // already done in NMEAHelper.cpp
@@ -50,98 +231,89 @@ void Traffic_Add()
     if ( settings->filter == TRAFFIC_FILTER_OFF  ||
         (fo.RelativeVertical > -500 && fo.RelativeVertical <  500) ) {
 
-      int i;
+      int i = Traffic_Find(fo.ID);
 
-      for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
+      if (i >= 0) {
         traffic_t *cip = &Container[i];
-        if (cip->ID == fo.ID) {
-          fo.alert = cip->alert;
-          fo.alert_level = cip->alert_level;
-          if (fo.packet_type == 2) {  // PFLAU
-            time_t interval = fo.timestamp - cip->timestamp;
-            if (interval <= 3) {
-              if (cip->packet_type == 1) {  // previous data was from PFLAA
-                if (interval > 0) {  // new data
+        fo.alert = cip->alert;
+        fo.alert_level = cip->alert_level;
+        if (fo.packet_type == 2) {  // PFLAU
+          time_t interval = fo.timestamp - cip->timestamp;
+          if (interval <= 3) {
+            if (cip->packet_type == 1) {  // previous data was from PFLAA
+              if (interval > 0) {  // new data
 #if 0
-                  // PFLAU following PFLAA, use the track, groundspeed, etc from the previous packet
-                  fo.IDType = cip->IDType;
-                  fo.Track = cip->Track;
-                  fo.GroundSpeed = cip->GroundSpeed;
-                  //fo.ClimbRate = cip->ClimbRate;   not available, empty in the PFLAA
-                  fo.AcftType = cip->AcftType;
-                  *cip = fo;
+                // PFLAU following PFLAA, use the track, groundspeed, etc from the previous packet
+                fo.IDType = cip->IDType;
+                fo.Track = cip->Track;
+                fo.GroundSpeed = cip->GroundSpeed;
+                //fo.ClimbRate = cip->ClimbRate;   not available, empty in the PFLAA
+                fo.AcftType = cip->AcftType;
+                *cip = fo;
 #else
-                  // or, keep the previous data and only change the fields known from the PFLAU
-                  // directly from the PFLAU:
-                  cip->alarm_level = fo.alarm_level;
-                  cip->distance = fo.distance;
-                  cip->RelativeVertical = fo.RelativeVertical;
-                  cip->RelativeBearing = fo.RelativeBearing;
-                  // computed in Traffic_Update():
-                  cip->adj_dist = fo.adj_dist;
-                  cip->RelativeNorth = fo.RelativeNorth;
-                  cip->RelativeEast = fo.RelativeEast;
-                  // fields kept: IDType, Track, GroundSpeed, AcftType
+                // or, keep the previous data and only change the fields known from the PFLAU
+                // directly from the PFLAU:
+                cip->alarm_level = fo.alarm_level;
+                cip->distance = fo.distance;
+                cip->RelativeVertical = fo.RelativeVertical;
+                cip->RelativeBearing = fo.RelativeBearing;
+                // computed in Traffic_Update():
+                cip->adj_dist = fo.adj_dist;
+                cip->RelativeNorth = fo.RelativeNorth;
+                cip->RelativeEast = fo.RelativeEast;
+                // fields kept: IDType, Track, GroundSpeed, AcftType
+                Traffic_Reorder(i);
 #endif
-                }  // else (PFLAU & PFLAA from same time) ignore the PFLAU
-              } else {
-                // compute track from the two distance/bearing points
-                // also taking into account that this aircraft has moved too
-                //  (very approximate since the time interval units are coarse)
-                float our_move = ThisAircraft.GroundSpeed * 0.5 /*MPS_PER_KNOT*/ * interval;
-                float x = fo.distance * sin(D2R * (float)fo.RelativeBearing)
-                             - cip->distance * sin(D2R * (float)cip->RelativeBearing);
-                float y = our_move + fo.distance * cos(D2R * (float)fo.RelativeBearing) 
-                             - cip->distance * cos(D2R * (float)cip->RelativeBearing);
-                fo.Track = R2D * atan2(x,y) + ThisAircraft.Track;
-                *cip = fo;
-              }
+              }  // else (PFLAU & PFLAA from same time) ignore the PFLAU
             } else {
-              // if PFLAU with no recent history, track remains unknown
-              fo.Track = 0;
-              *cip = fo;
+              // compute track from the two distance/bearing points
+              // also taking into account that this aircraft has moved too
+              //  (very approximate since the time interval units are coarse)
+              float our_move = ThisAircraft.GroundSpeed * 0.5 /*MPS_PER_KNOT*/ * interval;
+              float x = fo.distance * sin(D2R * (float)fo.RelativeBearing)
+                           - cip->distance * sin(D2R * (float)cip->RelativeBearing);
+              float y = our_move + fo.distance * cos(D2R * (float)fo.RelativeBearing) 
+                           - cip->distance * cos(D2R * (float)cip->RelativeBearing);
+              fo.Track = R2D * atan2(x,y) + ThisAircraft.Track;
+              Traffic_Store(i, &fo);
             }
           } else {
-            // PFLAA - copy all the data from the new packet
-            *cip = fo;
+            // if PFLAU with no recent history, track remains unknown
+            fo.Track = 0;
+            Traffic_Store(i, &fo);
           }
-          return;
+        } else {
+          // PFLAA - copy all the data from the new packet
+          Traffic_Store(i, &fo);
         }
+        return;
       }
 
-      int max_dist_ndx = 0;
-      int min_level_ndx = 0;
-      float max_distance = 0;
-
       for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
 
         if (! Container[i].ID) {
-            Container[i] = fo;            // use an empty slot
+            Traffic_Store(i, &fo);        // use an empty slot
             return;
         }
 
         if (ThisAircraft.timestamp > Container[i].timestamp + ENTRY_EXPIRATION_TIME) {
-            Container[i] = fo;            // overwrite expired
+            Traffic_Store(i, &fo);        // overwrite expired
             return;
         }
-
-        float distance = Container[i].distance;
-        if  (distance > max_distance) {
-          max_dist_ndx = i;
-          max_distance = distance;
-        }
-        if (Container[i].alarm_level < Container[min_level_ndx].alarm_level)
-            min_level_ndx = i;
       }
 
+      /* the store is full, the views give the candidates for replacement */
+      int min_level_ndx = alarm_order[order_count - 1];
+      int max_dist_ndx  = dist_order[order_count - 1];
+
       if (fo.alarm_level > Container[min_level_ndx].alarm_level) {
-        Container[min_level_ndx] = fo;     // alarming traffic overrides
+        Traffic_Store(min_level_ndx, &fo);  // alarming traffic overrides
         return;
       }
 
-      if (fo_distance <  max_distance &&
+      if (fo_distance <  Container[max_dist_ndx].distance &&
           fo.alarm_level >= Container[max_dist_ndx].alarm_level) {
-        Container[max_dist_ndx] = fo;      // overwrite farthest traffic
+        Traffic_Store(max_dist_ndx, &fo);   // overwrite farthest traffic
         return;
       }
     }
@@ -350,26 +522,23 @@ static void Traffic_Voice()
   max_alarm_level = ALARM_LEVEL_NONE;
   int sound_alarm_level = ALARM_LEVEL_NONE;
 
-  for (i=0; i < MAX_TRACKING_OBJECTS; i++) {
+  /* walk the traffic most alarming first, thus the first one found */
+  /* needing a sound alert has the highest level and is the nearest  */
+  for (int p=0; p < order_count; p++) {
 
-    if (Container[i].ID && (ThisAircraft.timestamp <= Container[i].timestamp + VOICE_EXPIRATION_TIME)) {
+    i = alarm_order[p];
 
-         /* find the maximum alarm level, whether to be alerted or not */
-         if (Container[i].alarm_level > max_alarm_level) {
+    if (ThisAircraft.timestamp <= Container[i].timestamp + VOICE_EXPIRATION_TIME) {
+
+         if (ntraffic == 0) {
              max_alarm_level = Container[i].alarm_level;
          }
 
-         /* figure out what is the highest alarm level needing a sound alert */
-         if (Container[i].alarm_level > sound_alarm_level
-                  && Container[i].alarm_level > Container[i].alert_level) {
-             sound_alarm_level = Container[i].alarm_level;
-             sound_alarm_ndx = i;
-         } else if (Container[i].alarm_level == sound_alarm_level
-                  && Container[i].alarm_level > Container[i].alert_level) {  // can't be NONE
-             if (sound_alarm_ndx < 0)
-                 sound_alarm_ndx = i;
-             else if (Container[i].adj_dist < Container[sound_alarm_ndx].adj_dist)
+         if (Container[i].alarm_level > Container[i].alert_level) {
+             if (sound_alarm_ndx < 0) {
+                 sound_alarm_level = Container[i].alarm_level;
                  sound_alarm_ndx = i;
+             }
          } else if (Container[i].distance < ALARM_ZONE_CLOSE
                   && (Container[i].alert & TRAFFIC_ALERT_VOICE) == 0) {
              if (sound_advisory_ndx < 0)
@@ -378,9 +547,6 @@ static void Traffic_Voice()
                  sound_advisory_ndx = i;
          }
 
-         // traffic[ntraffic].fop = &Container[i];
-         // traffic[ntraffic].distance = Container[i].distance;
-         
          ntraffic++;
        }
   }
@@ -394,6 +560,7 @@ static void Traffic_Voice()
       fop->alert_level = sound_alarm_level;
          /* no more alerts for this aircraft at this alarm level */
       fop->timestamp = now();
+      traffic_seq++;
   }
 
   if (max_alarm_level > ALARM_LEVEL_NONE)    // do not create distractions
@@ -406,6 +573,7 @@ static void Traffic_Voice()
       fop->alert |= TRAFFIC_ALERT_VOICE;
           /* no more advisories for this aircraft until it expires or alarms */
       fop->timestamp = now();
+      traffic_seq++;
   }
 }
 
@@ -427,9 +595,10 @@ void Traffic_loop()
       traffic_t *fop = &Container[i];
       if (fop->ID) {
         if (timenow > fop->timestamp + ENTRY_EXPIRATION_TIME) {    // 5s
-            *fop = EmptyFO;
+            Traffic_Remove(i);
         } else if (ThisAircraft.timestamp >= fop->timestamp + TRAFFIC_VECTOR_UPDATE_INTERVAL) {  // 2s
             Traffic_Update(fop);
+            Traffic_Reorder(i);
         }
       }
     }
@@ -450,47 +619,12 @@ void Traffic_ClearExpired()
   for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
     if (Container[i].ID &&
         (timenow > Container[i].timestamp + ENTRY_EXPIRATION_TIME)) {
-      Container[i] = EmptyFO;
+      Traffic_Remove(i);
     }
   }
 }
 
 int Traffic_Count()
 {
-  int count = 0;
-
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-    if (Container[i].ID) {
-      count++;
-    }
-  }
-
-  return count;
-}
-
-/* still used by EPD_Draw_Text() */
-int traffic_cmp_by_distance(const void *a, const void *b)
-{
-  traffic_by_dist_t *ta = (traffic_by_dist_t *)a;
-  traffic_by_dist_t *tb = (traffic_by_dist_t *)b;
-
-  if (ta->distance >  tb->distance) return  1;
-  if (ta->distance <  tb->distance) return -1;
-  return  0;
+  return order_count;
 }
-
-/* could have been used by Traffic_Voice() */
-#if 0
-int traffic_cmp_by_alarm(const void *a, const void *b)
-{
-  traffic_by_dist_t *ta = (traffic_by_dist_t *)a;
-  traffic_by_dist_t *tb = (traffic_by_dist_t *)b;
-
-  if (ta->fop->alarm_level >  tb->fop->alarm_level) return -1;   // sort descending
-  if (ta->fop->alarm_level <  tb->fop->alarm_level) return  1;
-  /* if same alarm level, then decide by distance (adjusted for altitude difference) */
-  if (ta->fop->adj_dist >  tb->fop->adj_dist) return  1;
-  if (ta->fop->adj_dist <  tb->fop->adj_dist) return -1;
-  return  0;
-}
-#endif
@@ -68,6 +68,13 @@ typedef struct traffic_by_dist_struct {
   float     distance;
 } traffic_by_dist_t;
 
+/* ID hash index size, a power of 2 and at least 2 x MAX_TRACKING_OBJECTS */
+#define TRAFFIC_HASH_SIZE       64
+
+#if MAX_TRACKING_OBJECTS > 32
+#error "MAX_TRACKING_OBJECTS must not exceed 32"
+#endif
+
 #define ALARM_ZONE_NONE         10000  // meters
 #define ALARM_ZONE_CLOSE        6000
 
@@ -98,11 +105,17 @@ void Traffic_loop         (void);
 void Traffic_Add          (void);
 void Traffic_Update       (traffic_t *);
 void Traffic_ClearExpired (void);
+void Traffic_Publish      (void);
 int  Traffic_Count        (void);
 
-int  traffic_cmp_by_distance(const void *, const void *);
+int  Traffic_Find         (uint32_t);
+void Traffic_Store        (int, traffic_t *);
+void Traffic_Remove       (int);
+void Traffic_Reorder      (int);
+int  Traffic_by_Distance  (traffic_by_dist_t *, time_t);
 
 extern traffic_t ThisAircraft, Container[MAX_TRACKING_OBJECTS], fo, EmptyFO;
 extern traffic_by_dist_t traffic[MAX_TRACKING_OBJECTS];
+extern traffic_t TrafficSnapshot[MAX_TRACKING_OBJECTS];
 
 #endif /* TRAFFICHELPER_H */
@@ -276,22 +276,22 @@ static void EPD_Draw_Radar()
     float trCos = cos(D2R * (float)ThisAircraft.Track);
 
     for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].ID && (now() - Container[i].timestamp) <= EPD_EXPIRATION_TIME) {
+      if (TrafficSnapshot[i].ID && (now() - TrafficSnapshot[i].timestamp) <= EPD_EXPIRATION_TIME) {
 
         float rel_x;
         float rel_y;
         float tgtSin;
         float tgtCos;
 
-        bool isTeam = (Container[i].ID == settings->team) ;
+        bool isTeam = (TrafficSnapshot[i].ID == settings->team) ;
 
-        rel_x = Container[i].RelativeEast;
+        rel_x = TrafficSnapshot[i].RelativeEast;
         if (fabs(rel_x) > range)  continue;
-        rel_y = Container[i].RelativeNorth;
+        rel_y = TrafficSnapshot[i].RelativeNorth;
         if (fabs(rel_y) > range)  continue;
 
-        tgtSin = sin(D2R * (float)Container[i].Track);
-        tgtCos = cos(D2R * (float)Container[i].Track);
+        tgtSin = sin(D2R * (float)TrafficSnapshot[i].Track);
+        tgtCos = cos(D2R * (float)TrafficSnapshot[i].Track);
 
         for (int i=0; i < ICON_TARGETS_POINTS; i++) {
           epd_Points[i][0] = epd_Target[i][0];
@@ -300,13 +300,13 @@ static void EPD_Draw_Radar()
         }
 #if 0
         Serial.print(F(" ID="));
-        Serial.print((Container[i].ID >> 16) & 0xFF, HEX);
-        Serial.print((Container[i].ID >>  8) & 0xFF, HEX);
-        Serial.print((Container[i].ID      ) & 0xFF, HEX);
+        Serial.print((TrafficSnapshot[i].ID >> 16) & 0xFF, HEX);
+        Serial.print((TrafficSnapshot[i].ID >>  8) & 0xFF, HEX);
+        Serial.print((TrafficSnapshot[i].ID      ) & 0xFF, HEX);
         Serial.println();
 
-        Serial.print(F(" RelativeNorth=")); Serial.println(Container[i].RelativeNorth);
-        Serial.print(F(" RelativeEast="));  Serial.println(Container[i].RelativeEast);
+        Serial.print(F(" RelativeNorth=")); Serial.println(TrafficSnapshot[i].RelativeNorth);
+        Serial.print(F(" RelativeEast="));  Serial.println(TrafficSnapshot[i].RelativeEast);
 #endif
         switch (settings->orientation) {
           case DIRECTION_NORTH_UP:
@@ -358,7 +358,7 @@ static void EPD_Draw_Radar()
 
         //if (x > radius || x < -radius || y > radius || y < -radius)  continue;
 
-        scale = Container[i].alarm_level + 1;
+        scale = TrafficSnapshot[i].alarm_level + 1;
 
         switch(scale)
         {
@@ -396,7 +396,7 @@ static void EPD_Draw_Radar()
 
         int16_t x3 = radar_center_x + x + (int16_t) round(epd_Points[3][0]);
         int16_t y3 = radar_center_y - y + (int16_t) round(epd_Points[3][1]);
-        if (Container[i].RelativeVertical >   EPD_RADAR_V_THRESHOLD) {
+        if (TrafficSnapshot[i].RelativeVertical >   EPD_RADAR_V_THRESHOLD) {
           // draw a '+' next to target triangle
           display->drawLine(x3 - 2,
                             y3,
@@ -408,7 +408,7 @@ static void EPD_Draw_Radar()
                             x3,
                             y3 - 2,
                             GxEPD_BLACK);
-        } else if (Container[i].RelativeVertical < - EPD_RADAR_V_THRESHOLD) {
+        } else if (TrafficSnapshot[i].RelativeVertical < - EPD_RADAR_V_THRESHOLD) {
           // draw a '-' next to target triangle
           display->drawLine(x3 - 2,
                             y3,
@@ -40,14 +40,8 @@ static void EPD_Draw_Text()
   char id_text   [TEXT_VIEW_LINE_LENGTH];
   char id2_text  [TEXT_VIEW_LINE_LENGTH];
 
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-    if (Container[i].ID && (now() - Container[i].timestamp) <= EPD_EXPIRATION_TIME) {
-
-      traffic[j].fop = &Container[i];
-      traffic[j].distance = Container[i].distance;
-      j++;
-    }
-  }
+  /* already in order of distance */
+  j = Traffic_by_Distance(traffic, EPD_EXPIRATION_TIME);
 
   if (j > 0) {
 
@@ -56,8 +50,6 @@ static void EPD_Draw_Text()
     float disp_dist;
     int   disp_alt, disp_spd;
 
-    qsort(traffic, j, sizeof(traffic_by_dist_t), traffic_cmp_by_distance);
-
     if (EPD_current > j) {
       EPD_current = j;
     }
@@ -25,6 +25,8 @@
 #include "NMEAHelper.h"
 #include "BatteryHelper.h"
 #include "GDL90Helper.h"
+#include <UDPRing.h>
+#include "InputHelper.h"
 
 #define NOLOGO
 
@@ -458,7 +460,7 @@ void handleRoot() {
   time_t timestamp = now();
   char str_Vcc[8];
 
-  size_t size = 2400;
+  size_t size = 2500 + 140 * UDP_MAX_SOURCES;
   char *offset;
   size_t len = 0;
 
@@ -508,6 +510,21 @@ void handleRoot() {
   offset += len;
   size -= len;
 
+  if (settings->connection == CON_SERIAL ||
+      settings->connection == CON_BLUETOOTH_SPP ||
+      settings->connection == CON_BLUETOOTH_LE) {
+    input_ring_t *rp = &input_ring[settings->connection == CON_SERIAL ?
+                                   INPUT_SRC_SERIAL : INPUT_SRC_BT];
+    snprintf_P ( offset, size,
+      PSTR("\
+  <tr><th align=left>Input buffer</th><td align=right>%u bytes, peak %u, full %u</td></tr>"),
+      rp->bytes, rp->peak, rp->full
+    );
+    len = strlen(offset);
+    offset += len;
+    size -= len;
+  }
+
   switch (settings->connection)
   {
   case CON_WIFI_UDP:
@@ -523,6 +540,20 @@ void handleRoot() {
     len = strlen(offset);
     offset += len;
     size -= len;
+    for (int i = 0; i < UDP_MAX_SOURCES; i++) {
+      udp_source_t *sp = &udp_sources[i];
+      if (sp->packets + sp->dropped == 0)
+        continue;
+      snprintf_P ( offset, size,
+        PSTR("\
+  <tr><th align=left>UDP from %s:%u</th><td align=right>%u pkts %u/s %u dropped %u truncated</td></tr>"),
+        IPAddress(sp->ip).toString().c_str(), sp->port,
+        sp->packets, UDP_Source_Rate(sp, millis()), sp->dropped, sp->truncated
+      );
+      len = strlen(offset);
+      offset += len;
+      size -= len;
+    }
   case CON_SERIAL:
   case CON_BLUETOOTH_SPP:
   case CON_BLUETOOTH_LE:
@@ -26,6 +26,7 @@
 #include "EEPROMHelper.h"
 #include "SoCHelper.h"
 #include "WiFiHelper.h"
+#include <UDPRing.h>
 #include "TrafficHelper.h"
 #include "NMEAHelper.h"
 #include "GDL90Helper.h"
@@ -68,24 +69,41 @@ static bool WiFi_STA_trying = false;
 static unsigned long WiFi_No_Clients_Time_ms = 0;
 #endif
 
-size_t WiFi_Receive_UDP(uint8_t *buf, size_t max_size)
-{
-  int noBytes = Uni_Udp.parsePacket();
-  if ( noBytes ) {
+#define UDP_INGEST_MAX  16   /* datagrams taken from the stack per pass */
 
-    if (noBytes > max_size) {
-      noBytes = max_size;
+/*
+ * Move all datagrams waiting in the network stack into the ring, so that
+ * a burst does not overflow the stack's own (small) queue while the main
+ * loop is busy elsewhere.  At most UDP_INGEST_MAX per pass, so that a
+ * flood cannot stall the loop.  If the ring is full the datagram is
+ * counted as dropped.  Whatever was not read (all of a dropped datagram,
+ * the tail of an oversized one) must be flushed, else on the ESP32 the
+ * next parsePacket() returns 0 for good.
+ */
+static void WiFi_Ingest_UDP()
+{
+  for (int n = 0; n < UDP_INGEST_MAX; n++) {
+    int noBytes = Uni_Udp.parsePacket();
+    if (noBytes <= 0)
+      break;
+    uint32_t ip   = (uint32_t) Uni_Udp.remoteIP();
+    uint16_t port = Uni_Udp.remotePort();
+    if (UDP_Ring_Free() == 0) {
+      UDP_Ring_Drop(ip, port, millis());
+    } else {
+      Uni_Udp.read(UDP_Ring_Slot(0), UDP_RING_FRAME_SIZE);
+      UDP_Ring_Commit(ip, port, noBytes, millis());
     }
-
-    // We've received a packet, read the data from it
-    Uni_Udp.read(buf,noBytes); // read the packet into the buffer
-
-    return (size_t) noBytes;
-  } else {
-    return 0;
+    Uni_Udp.flush();
   }
 }
 
+/* filled once per main loop pass, from WiFi_loop() */
+size_t WiFi_Receive_UDP(uint8_t *buf, size_t max_size)
+{
+  return UDP_Ring_Pop(buf, max_size);
+}
+
 void WiFi_Transmit_UDP(char *buf, size_t size)
 {
     SoC->WiFi_Transmit_UDP(
@@ -204,6 +222,9 @@ void WiFi_setup()
 
 void WiFi_loop()
 {
+  if (settings->connection == CON_WIFI_UDP && UDP_Data_Port)
+    WiFi_Ingest_UDP();
+
   if (settings->connection == CON_WIFI_UDP ||
       settings->connection == CON_WIFI_TCP ) {
     if (WiFi.status() == WL_CONNECTED) {
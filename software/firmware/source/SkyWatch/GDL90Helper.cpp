@@ -30,21 +30,11 @@ extern "C" {
 #include <gdl90.h>
 }
 
-#define GDL90_RINGBUF_SIZE  sizeof(gdl_message_escaped_t)
-
 static unsigned long GDL90_Data_TimeMarker = 0;
 static unsigned long GDL90_HeartBeat_TimeMarker = 0;
 static unsigned long GDL90_OwnShip_TimeMarker = 0;
-static unsigned char gdl90_ringbuf[GDL90_RINGBUF_SIZE];
-static unsigned int gdl90buf_head = 0;
-static unsigned char prev_c = 0;
-
-gdl_message_t message;
 
-gdl90_msg_heartbeat heartbeat;
-gdl90_msg_traffic_report_t gdl_traffic;
-gdl90_msg_traffic_report_t ownship;
-gdl90_msg_ownship_geo_altitude geo_altitude;
+static gdl90_stream_t gdl90_stream;
 
 const uint8_t gdl90_to_aircraft_type[] PROGMEM = {
 	AIRCRAFT_TYPE_UNKNOWN,
@@ -65,150 +55,82 @@ const uint8_t gdl90_to_aircraft_type[] PROGMEM = {
 	AIRCRAFT_TYPE_RESERVED
 };
 
-static void GDL90_Parse_Character(char c)
+static void GDL90_HeartBeat(gdl90_msg_heartbeat *heartbeat)
 {
-    unsigned int gdl90buf_tail;
-    size_t msg_size;
-
-    if (c == GDL90_CONTROL_ESCAPE) {
-      prev_c = c;
-      return;
-    } else if (prev_c == GDL90_CONTROL_ESCAPE) {
-      prev_c = c;
-      c ^= GDL90_ESCAPE_BYTE;
-    } else {
-      prev_c = c;
-    }
-
-    gdl90_ringbuf[gdl90buf_head % GDL90_RINGBUF_SIZE] = c;
-    gdl90buf_head++;
-
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_HEARTBEAT + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_HEARTBEAT) {
-
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
-
-      if (decode_gdl90_heartbeat(&message, &heartbeat)) {
-
-//      print_gdl90_heartbeat(&heartbeat);
-
-        GDL90_HeartBeat_TimeMarker = millis();
-      }
-    }
-
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_OWNSHIP_GEOMETRIC + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_OWNSHIP_GEOMETRIC) {
-
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
-
-      decode_gdl90_ownship_geo_altitude(&message, &geo_altitude);
-//    print_gdl90_ownship_geo_altitude(&geo_altitude);
-    }
-
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_TRAFFIC_REPORT + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_TRAFFIC_REPORT) {
+//  print_gdl90_heartbeat(heartbeat);
 
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
-
-      if (decode_gdl90_traffic_report(&message, &gdl_traffic)) {
-
-//      print_gdl90_traffic_report(&gdl_traffic);
-
-        fo = EmptyFO;
+  GDL90_HeartBeat_TimeMarker = millis();
+}
 
-        fo.ID          = gdl_traffic.address;
-        fo.IDType      = gdl_traffic.addressType == ADS_B_WITH_ICAO_ADDRESS ?
-                                          ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
+static void GDL90_Traffic(gdl90_msg_traffic_report_t *gdl_traffic)
+{
+//  print_gdl90_traffic_report(gdl_traffic);
 
-        fo.latitude    = gdl_traffic.latitude;
-        fo.longitude   = gdl_traffic.longitude;
-        fo.altitude    = gdl_traffic.altitude  / _GPS_FEET_PER_METER;
+  fo = EmptyFO;
 
-        fo.AlarmLevel  = gdl_traffic.trafficAlertStatus == TRAFFIC_ALERT ?
-                                            ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
-        fo.Track       = gdl_traffic.trackOrHeading;           // degrees
-        fo.ClimbRate   = gdl_traffic.verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
-        fo.TurnRate    = 0;
-        fo.GroundSpeed = gdl_traffic.horizontalVelocity * _GPS_MPS_PER_KNOT;
-        fo.AcftType    = GDL90_TO_AT(gdl_traffic.emitterCategory);
+  fo.ID          = gdl_traffic->address;
+  fo.IDType      = gdl_traffic->addressType == ADS_B_WITH_ICAO_ADDRESS ?
+                                    ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
 
-        memcpy(fo.callsign, gdl_traffic.callsign, sizeof(fo.callsign));
+  fo.latitude    = gdl_traffic->latitude;
+  fo.longitude   = gdl_traffic->longitude;
+  fo.altitude    = gdl_traffic->altitude  / _GPS_FEET_PER_METER;
 
-        fo.timestamp   = now();
+  fo.AlarmLevel  = gdl_traffic->trafficAlertStatus == TRAFFIC_ALERT ?
+                                      ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
+  fo.Track       = gdl_traffic->trackOrHeading;           // degrees
+  fo.ClimbRate   = gdl_traffic->verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
+  fo.TurnRate    = 0;
+  fo.GroundSpeed = gdl_traffic->horizontalVelocity * _GPS_MPS_PER_KNOT;
+  fo.AcftType    = GDL90_TO_AT(gdl_traffic->emitterCategory);
 
-        for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+  memcpy(fo.callsign, gdl_traffic->callsign, sizeof(fo.callsign));
 
-          if (Container[i].ID == fo.ID) {
-            Container[i] = fo;
-            Traffic_Update(i);
-            break;
-          } else {
-            if (now() - Container[i].timestamp > ENTRY_EXPIRATION_TIME) {
-              Container[i] = fo;
-              Traffic_Update(i);
-              break;
-            }
-          }
-        }
-      }
-    }
+  fo.timestamp   = now();
 
-    msg_size = 1 /* flag */ + 1 /* id */ + GDL90_MSG_LEN_OWNSHIP_REPORT + 2 /* FC */ + 1 /* flag */;
-    gdl90buf_tail = gdl90buf_head - msg_size;
-    if (c == GDL90_FLAG_BYTE && 
-        gdl90_ringbuf[ gdl90buf_tail    % GDL90_RINGBUF_SIZE] == GDL90_FLAG_BYTE &&
-        gdl90_ringbuf[(gdl90buf_tail+1) % GDL90_RINGBUF_SIZE] == MSG_ID_OWNSHIP_REPORT) {
+  int ndx = Traffic_Add(&fo);
+  if (ndx >= 0) {
+    Traffic_Update(ndx);
+  }
+}
 
-      unsigned char *buf = (unsigned char *) &message;
-      for (uint8_t i=0; i < msg_size; i++) {
-          buf[i] = gdl90_ringbuf[(gdl90buf_tail + i) % GDL90_RINGBUF_SIZE];
-      }
+static void GDL90_OwnShip(gdl90_msg_traffic_report_t *ownship)
+{
+//  print_gdl90_traffic_report(ownship);
 
-      if (decode_gdl90_traffic_report(&message, &ownship)) {
+  ThisAircraft.ID          = ownship->address;
+  ThisAircraft.IDType      = ownship->addressType == ADS_B_WITH_ICAO_ADDRESS ?
+                                    ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
 
-//      print_gdl90_traffic_report(&ownship);
+  ThisAircraft.latitude    = ownship->latitude;
+  ThisAircraft.longitude   = ownship->longitude;
+  ThisAircraft.altitude    = ownship->altitude  / _GPS_FEET_PER_METER;
 
-        ThisAircraft.ID          = ownship.address;
-        ThisAircraft.IDType      = ownship.addressType == ADS_B_WITH_ICAO_ADDRESS ?
-                                          ADDR_TYPE_ICAO : ADDR_TYPE_ANONYMOUS;
+  ThisAircraft.AlarmLevel  = ownship->trafficAlertStatus == TRAFFIC_ALERT ?
+                                      ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
+  ThisAircraft.Track       = ownship->trackOrHeading;           // degrees
+  ThisAircraft.ClimbRate   = ownship->verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
+  ThisAircraft.TurnRate    = 0;
+  ThisAircraft.GroundSpeed = ownship->horizontalVelocity * _GPS_MPS_PER_KNOT;
+  ThisAircraft.AcftType    = GDL90_TO_AT(ownship->emitterCategory);
 
-        ThisAircraft.latitude    = ownship.latitude;
-        ThisAircraft.longitude   = ownship.longitude;
-        ThisAircraft.altitude    = ownship.altitude  / _GPS_FEET_PER_METER;
+  memcpy(ThisAircraft.callsign, ownship->callsign, sizeof(ThisAircraft.callsign));
 
-        ThisAircraft.AlarmLevel  = ownship.trafficAlertStatus == TRAFFIC_ALERT ?
-                                            ALARM_LEVEL_LOW : ALARM_LEVEL_NONE;
-        ThisAircraft.Track       = ownship.trackOrHeading;           // degrees
-        ThisAircraft.ClimbRate   = ownship.verticalVelocity/ (_GPS_FEET_PER_METER * 60.0);
-        ThisAircraft.TurnRate    = 0;
-        ThisAircraft.GroundSpeed = ownship.horizontalVelocity * _GPS_MPS_PER_KNOT;
-        ThisAircraft.AcftType    = GDL90_TO_AT(ownship.emitterCategory);
+  ThisAircraft.timestamp   = now();
 
-        memcpy(ThisAircraft.callsign, ownship.callsign, sizeof(ThisAircraft.callsign));
+  GDL90_OwnShip_TimeMarker = millis();
+}
 
-        ThisAircraft.timestamp   = now();
+static const gdl90_callbacks_t GDL90_callbacks = {
+  GDL90_HeartBeat,
+  GDL90_OwnShip,
+  NULL,             /* geometric altitude is not used */
+  GDL90_Traffic
+};
 
-        GDL90_OwnShip_TimeMarker = millis();
-      }
-    }
+static inline void GDL90_Parse_Character(char c)
+{
+  gdl90_stream_parse(&gdl90_stream, (const uint8_t *) &c, 1, &GDL90_callbacks);
 }
 
 void GDL90_setup()
@@ -216,6 +138,7 @@ void GDL90_setup()
   if (settings->m.protocol == PROTOCOL_GDL90) {
 
     gdl90_crcInit();
+    gdl90_stream_init(&gdl90_stream);
 
     switch (settings->m.connection)
     {
@@ -292,10 +215,9 @@ void GDL90_loop()
   case CON_WIFI_UDP:
     size = SoC->WiFi_Receive_UDP((uint8_t *) UDPpacketBuffer, sizeof(UDPpacketBuffer));
     if (size > 0) {
-      for (size_t i=0; i < size; i++) {
-//        Serial.print(UDPpacketBuffer[i]);
-        GDL90_Parse_Character(UDPpacketBuffer[i]);
-      }
+//      Serial.write((uint8_t *) UDPpacketBuffer, size);
+      gdl90_stream_parse(&gdl90_stream, (const uint8_t *) UDPpacketBuffer,
+                         size, &GDL90_callbacks);
       GDL90_Data_TimeMarker = millis();
     }
     break;
@@ -192,18 +192,7 @@ static void NMEA_Parse_Character(char c)
 
         fo.timestamp = now();
 
-        for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-
-          if (Container[i].ID == fo.ID) {
-            Container[i] = fo;
-            break;
-          } else {
-            if (now() - Container[i].timestamp > ENTRY_EXPIRATION_TIME) {
-              Container[i] = fo;
-              break;
-            }
-          }
-        }
+        Traffic_Add(&fo);
 
       } else if (S_RX.isUpdated()) {
 
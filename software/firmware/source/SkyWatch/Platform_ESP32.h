@@ -32,7 +32,9 @@
 #include <bma.h>
 
 /* Maximum of tracked flying objects is now SoC-specific constant */
-#define MAX_TRACKING_OBJECTS            9
+#if !defined(MAX_TRACKING_OBJECTS)
+#define MAX_TRACKING_OBJECTS            20  /* up to 32 */
+#endif
 
 #define SerialInput                     Serial1
 
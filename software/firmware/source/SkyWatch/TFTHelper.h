@@ -83,5 +83,6 @@ void TFT_time_prev();
 extern TFT_eSPI *tft;
 extern TFT_eSprite *sprite;
 extern bool TFT_vmode_updated;
+extern uint32_t TFT_radar_frame_us, TFT_radar_frame_max_us;
 
 #endif /* TFTHELPER_H */
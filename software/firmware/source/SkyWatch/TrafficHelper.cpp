@@ -30,6 +30,176 @@ static unsigned long UpdateTrafficTimeMarker = 0;
 static unsigned long Traffic_Voice_TimeMarker = 0;
 static uint32_t Traffic_Voice_ID_prev = 0;
 
+/*
+ * Container[] is indexed by a small open-addressing hash table on ID,
+ * and the occupied slots are kept in order of distance,
+ * so that lookups are O(1) and the display pages need not sort.
+ */
+static uint8_t hash_slot[TRAFFIC_HASH_SIZE];     /* Container index + 1, or 0 */
+static uint8_t dist_order[MAX_TRACKING_OBJECTS]; /* Container indices, nearest first */
+static uint8_t dist_pos[MAX_TRACKING_OBJECTS];   /* position of each index in dist_order */
+static int     order_count = 0;
+
+static float Traffic_Distance(traffic_t *fop)
+{
+  return sqrtf(fop->RelativeNorth * fop->RelativeNorth +
+               fop->RelativeEast  * fop->RelativeEast);
+}
+
+static bool Traffic_Nearer(int a, int b)
+{
+  return (Traffic_Distance(&Container[a]) < Traffic_Distance(&Container[b]));
+}
+
+static inline uint32_t Traffic_Hash(uint32_t ID)
+{
+  return (ID ^ (ID >> 7) ^ (ID >> 15)) & (TRAFFIC_HASH_SIZE - 1);
+}
+
+static void Traffic_Hash_Insert(int ndx)
+{
+  uint32_t h = Traffic_Hash(Container[ndx].ID);
+  while (hash_slot[h])
+    h = (h + 1) & (TRAFFIC_HASH_SIZE - 1);
+  hash_slot[h] = ndx + 1;
+}
+
+/* after a removal the probe chains may be broken, so rebuild - it is tiny */
+static void Traffic_Hash_Rebuild()
+{
+  memset(hash_slot, 0, sizeof(hash_slot));
+  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+    if (Container[i].ID)
+      Traffic_Hash_Insert(i);
+  }
+}
+
+int Traffic_Find(uint32_t ID)
+{
+  if (ID == 0)
+    return -1;
+
+  uint32_t h = Traffic_Hash(ID);
+  while (hash_slot[h]) {
+    int ndx = hash_slot[h] - 1;
+    if (Container[ndx].ID == ID)
+      return ndx;
+    h = (h + 1) & (TRAFFIC_HASH_SIZE - 1);
+  }
+  return -1;
+}
+
+/* move one entry up or down within an ordered view until it is in place */
+static void Traffic_Sift(uint8_t *order, uint8_t *pos, int ndx,
+                         bool (*before)(int, int))
+{
+  int p = pos[ndx];
+
+  while (p > 0 && before(ndx, order[p-1])) {
+    order[p] = order[p-1];
+    pos[order[p]] = p;
+    p--;
+  }
+  while (p < order_count - 1 && before(order[p+1], ndx)) {
+    order[p] = order[p+1];
+    pos[order[p]] = p;
+    p++;
+  }
+  order[p] = ndx;
+  pos[ndx] = p;
+}
+
+static void Traffic_Unlink(uint8_t *order, uint8_t *pos, int ndx)
+{
+  for (int p = pos[ndx]; p < order_count - 1; p++) {
+    order[p] = order[p+1];
+    pos[order[p]] = p;
+  }
+}
+
+void Traffic_Reorder(int ndx)
+{
+  if (Container[ndx].ID == 0)
+    return;
+  Traffic_Sift(dist_order,  dist_pos,  ndx, Traffic_Nearer);
+}
+
+void Traffic_Store(int ndx, traffic_t *fop)
+{
+  uint32_t oldID = Container[ndx].ID;
+
+  if (fop->ID == 0) {
+    Traffic_Remove(ndx);
+    return;
+  }
+
+  Container[ndx] = *fop;
+
+  if (oldID == 0) {
+    /* new entry, append to the views then move into place */
+    dist_order[order_count]  = ndx;
+    dist_pos[ndx]            = order_count;
+    order_count++;
+    Traffic_Hash_Insert(ndx);
+  } else if (oldID != fop->ID) {
+    Traffic_Hash_Rebuild();
+  }
+
+  Traffic_Reorder(ndx);
+}
+
+void Traffic_Remove(int ndx)
+{
+  if (Container[ndx].ID == 0)
+    return;
+
+  Traffic_Unlink(dist_order,  dist_pos,  ndx);
+  order_count--;
+
+  Container[ndx] = EmptyFO;
+  Traffic_Hash_Rebuild();
+}
+
+/* fill a list of current traffic, nearest first, without sorting */
+int Traffic_by_Distance(traffic_by_dist_t *list, time_t expiration)
+{
+  int j = 0;
+  time_t timenow = now();
+
+  for (int p=0; p < order_count; p++) {
+    traffic_t *fop = &Container[dist_order[p]];
+    if ((timenow - fop->timestamp) <= expiration) {
+      list[j].fop = fop;
+      list[j].distance = Traffic_Distance(fop);
+      j++;
+    }
+  }
+
+  return j;
+}
+
+/* store a report: update the same ID, else take an empty or expired slot */
+int Traffic_Add(traffic_t *fop)
+{
+  int ndx = Traffic_Find(fop->ID);
+
+  if (ndx < 0) {
+    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+      if (Container[i].ID == 0 ||
+          now() - Container[i].timestamp > ENTRY_EXPIRATION_TIME) {
+        ndx = i;
+        break;
+      }
+    }
+  }
+
+  if (ndx >= 0) {
+    Traffic_Store(ndx, fop);
+  }
+
+  return ndx;
+}
+
 void Traffic_Update(int ndx)
 {
   float distance = nmea.distanceBetween( ThisAircraft.latitude,
@@ -52,6 +222,8 @@ void Traffic_Update(int ndx)
   Container[ndx].RelativeNorth    = (int16_t) RelativeNorth;
   Container[ndx].RelativeEast     = (int16_t) RelativeEast;
   Container[ndx].RelativeVertical = (int16_t) RelativeVertical;
+
+  Traffic_Reorder(ndx);
 }
 
 static void Traffic_Voice()
@@ -60,15 +232,8 @@ static void Traffic_Voice()
   int bearing;
   char message[80];
 
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-    if (Container[i].ID && (now() - Container[i].timestamp) <= VOICE_EXPIRATION_TIME) {
-
-      traffic[j].fop = &Container[i];
-      traffic[j].distance = sqrtf(Container[i].RelativeNorth * Container[i].RelativeNorth +
-                                  Container[i].RelativeEast  * Container[i].RelativeEast);
-      j++;
-    }
-  }
+  /* already in order of distance */
+  j = Traffic_by_Distance(traffic, VOICE_EXPIRATION_TIME);
 
   if (j > 0 && traffic[0].fop->ID != Traffic_Voice_ID_prev) {
 
@@ -79,8 +244,6 @@ static void Traffic_Voice()
     char how_far[32];
     char elev[32];
 
-    qsort(traffic, j, sizeof(traffic_by_dist_t), traffic_cmp_by_distance);
-
     bearing = (int) (atan2f(traffic[0].fop->RelativeNorth,
                             traffic[0].fop->RelativeEast) * 180.0 / PI);  /* -180 ... 180 */
 
@@ -213,7 +376,7 @@ void Traffic_loop()
           if ((ThisAircraft.timestamp - Container[i].timestamp) >= TRAFFIC_VECTOR_UPDATE_INTERVAL)
             Traffic_Update(i);
         } else {
-          Container[i] = EmptyFO;
+          Traffic_Remove(i);
         }
       }
 
@@ -234,30 +397,12 @@ void Traffic_ClearExpired()
 {
   for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
     if (Container[i].ID && (now() - Container[i].timestamp) > ENTRY_EXPIRATION_TIME) {
-      Container[i] = EmptyFO;
+      Traffic_Remove(i);
     }
   }
 }
 
 int Traffic_Count()
 {
-  int count = 0;
-
-  for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-    if (Container[i].ID) {
-      count++;
-    }
-  }
-
-  return count;
-}
-
-int traffic_cmp_by_distance(const void *a, const void *b)
-{
-  traffic_by_dist_t *ta = (traffic_by_dist_t *)a;
-  traffic_by_dist_t *tb = (traffic_by_dist_t *)b;
-
-  if (ta->distance >  tb->distance) return  1;
-  if (ta->distance == tb->distance) return  0;
-  if (ta->distance <  tb->distance) return -1;
+  return order_count;
 }
@@ -59,6 +59,13 @@ typedef struct traffic_by_dist_struct {
   float     distance;
 } traffic_by_dist_t;
 
+/* ID hash index size, a power of 2 and at least 2 x MAX_TRACKING_OBJECTS */
+#define TRAFFIC_HASH_SIZE       64
+
+#if MAX_TRACKING_OBJECTS > 32
+#error "MAX_TRACKING_OBJECTS must not exceed 32"
+#endif
+
 #define ENTRY_EXPIRATION_TIME   5 /* seconds */
 #define TRAFFIC_VECTOR_UPDATE_INTERVAL 2 /* seconds */
 #define TRAFFIC_UPDATE_INTERVAL_MS (TRAFFIC_VECTOR_UPDATE_INTERVAL * 1000)
@@ -73,7 +80,13 @@ void Traffic_setup        (void);
 void Traffic_loop         (void);
 void Traffic_ClearExpired (void);
 int  Traffic_Count        (void);
-int traffic_cmp_by_distance(const void *, const void *);
+
+int  Traffic_Find         (uint32_t);
+void Traffic_Store        (int, traffic_t *);
+void Traffic_Remove       (int);
+void Traffic_Reorder      (int);
+int  Traffic_Add          (traffic_t *);
+int  Traffic_by_Distance  (traffic_by_dist_t *, time_t);
 
 extern traffic_t ThisAircraft, Container[MAX_TRACKING_OBJECTS], fo, EmptyFO;
 extern traffic_by_dist_t traffic[MAX_TRACKING_OBJECTS];
@@ -42,35 +42,47 @@ enum {
 static int view_state_curr = STATE_RVIEW_NONE;
 static int view_state_prev = STATE_RVIEW_NONE;
 
-static void TFT_Draw_Radar()
-{
-  int16_t  tbx, tby;
-  uint16_t tbw, tbh;
-  uint16_t x;
-  uint16_t y;
-  char cog_text[6];
+/* screen is updated in square tiles of this size (pixels) */
+#define RADAR_TILE_SIZE       16
+#define RADAR_TILE_ROWS_MAX   32
+/* half-size of the box that a target marker may cover */
+#define RADAR_MARK_HALF       6
 
-  /* divider is a half of full scale */
-  int32_t divider = 2000; 
+enum {
+   MARK_LEVEL,
+   MARK_ABOVE,
+   MARK_BELOW
+};
 
-  sprite->createSprite(tft->width(), tft->height());
+typedef struct radar_mark_struct {
+  int16_t  x;
+  int16_t  y;
+  uint8_t  shape;
+  uint16_t color;
+} radar_mark_t;
 
-  sprite->fillSprite(TFT_BLACK);
-  sprite->setTextColor(TFT_WHITE);
+/* static background (rings, labels, own aircraft) is kept between frames */
+static TFT_eSprite *radar_bg   = NULL;
+static TFT_eSprite *radar_tile = NULL;
+static bool radar_bg_valid     = false;
+static int  bg_zoom            = -1;
+static int  bg_orientation     = -1;
+static int  bg_units           = -1;
+static int  bg_track           = -1;
 
-  sprite->setTextFont(4);
-  sprite->setTextSize(1);
+static radar_mark_t marks_prev[MAX_TRACKING_OBJECTS];
+static radar_mark_t marks_curr[MAX_TRACKING_OBJECTS];
+static int nmarks_prev = 0;
 
-  tbw = sprite->textWidth("N");
-  tbh = sprite->fontHeight();
+static uint32_t radar_dirty[RADAR_TILE_ROWS_MAX];  /* bitmap of restored tiles */
 
-  uint16_t radar_x = 0;
-  uint16_t radar_y = 0;
-  uint16_t radar_w = sprite->width();
+uint32_t TFT_radar_frame_us     = 0;  /* duration of the last refresh */
+uint32_t TFT_radar_frame_max_us = 0;
 
-  uint16_t radar_center_x = radar_w / 2;
-  uint16_t radar_center_y = radar_y + radar_w / 2;
-  uint16_t radius = radar_w / 2 - 1;
+static int32_t TFT_Radar_Divider()
+{
+  /* divider is a half of full scale */
+  int32_t divider = 2000;
 
   if (settings->m.units == UNITS_METRIC || settings->m.units == UNITS_MIXED) {
     switch(TFT_zoom)
@@ -108,105 +120,266 @@ static void TFT_Draw_Radar()
     }
   }
 
-  sprite->drawCircle(  radar_center_x, radar_center_y,
-                        radius, TFT_WHITE);
-  sprite->drawCircle(  radar_center_x, radar_center_y,
-                        radius / 2, TFT_WHITE);
-
-#if 0
-  /* arrow tip */
-  sprite->fillTriangle(radar_center_x - 7, radar_center_y + 5,
-                        radar_center_x    , radar_center_y - 5,
-                        radar_center_x + 7, radar_center_y + 5,
-                        TFT_WHITE);
-  sprite->fillTriangle(radar_center_x - 7, radar_center_y + 5,
-                        radar_center_x    , radar_center_y + 2,
-                        radar_center_x + 7, radar_center_y + 5,
-                        TFT_NAVY);
-#else
+  return divider;
+}
+
+static void TFT_Draw_Radar_Background()
+{
+  uint16_t tbw, tbh;
+  uint16_t x;
+  uint16_t y;
+  char cog_text[6];
+
+  if (radar_bg == NULL) {
+    radar_bg = new TFT_eSprite(tft);
+    radar_bg->setColorDepth(1);
+    radar_bg->createSprite(tft->width(), tft->height());
+  }
+
+  radar_bg->fillSprite(TFT_BLACK);
+  radar_bg->setTextColor(TFT_WHITE);
+
+  radar_bg->setTextFont(4);
+  radar_bg->setTextSize(1);
+
+  tbw = radar_bg->textWidth("N");
+  tbh = radar_bg->fontHeight();
+
+  uint16_t radar_x = 0;
+  uint16_t radar_y = 0;
+  uint16_t radar_w = radar_bg->width();
+
+  uint16_t radar_center_x = radar_w / 2;
+  uint16_t radar_center_y = radar_y + radar_w / 2;
+  uint16_t radius = radar_w / 2 - 1;
+
+  radar_bg->drawCircle(  radar_center_x, radar_center_y,
+                         radius, TFT_WHITE);
+  radar_bg->drawCircle(  radar_center_x, radar_center_y,
+                         radius / 2, TFT_WHITE);
+
   /* little airplane */
-  sprite->drawFastVLine(radar_center_x,      radar_center_y - 4, 14, TFT_WHITE);
-  sprite->drawFastVLine(radar_center_x + 1,  radar_center_y - 4, 14, TFT_WHITE);
+  radar_bg->drawFastVLine(radar_center_x,      radar_center_y - 4, 14, TFT_WHITE);
+  radar_bg->drawFastVLine(radar_center_x + 1,  radar_center_y - 4, 14, TFT_WHITE);
 
-  sprite->drawFastHLine(radar_center_x - 8,  radar_center_y,     18, TFT_WHITE);
-  sprite->drawFastHLine(radar_center_x - 10, radar_center_y + 1, 22, TFT_WHITE);
+  radar_bg->drawFastHLine(radar_center_x - 8,  radar_center_y,     18, TFT_WHITE);
+  radar_bg->drawFastHLine(radar_center_x - 10, radar_center_y + 1, 22, TFT_WHITE);
 
-  sprite->drawFastHLine(radar_center_x - 3,  radar_center_y + 8,  8, TFT_WHITE);
-  sprite->drawFastHLine(radar_center_x - 2,  radar_center_y + 9,  6, TFT_WHITE);
-#endif
+  radar_bg->drawFastHLine(radar_center_x - 3,  radar_center_y + 8,  8, TFT_WHITE);
+  radar_bg->drawFastHLine(radar_center_x - 2,  radar_center_y + 9,  6, TFT_WHITE);
 
   switch (settings->m.orientation)
   {
   case DIRECTION_NORTH_UP:
     x = radar_x + radar_w / 2 - radius + tbw/2;
     y = radar_y + (radar_w - tbh) / 2;
-    sprite->setCursor(x , y);
-    sprite->print("W");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("W");
     x = radar_x + radar_w / 2 + radius - (3 * tbw)/2;
     y = radar_y + (radar_w - tbh) / 2;
-    sprite->setCursor(x , y);
-    sprite->print("E");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("E");
     x = radar_x + (radar_w - tbw) / 2;
     y = radar_y + radar_w/2 - radius + tbh/2;
-    sprite->setCursor(x , y);
-    sprite->print("N");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("N");
     x = radar_x + (radar_w - tbw) / 2;
     y = radar_y + radar_w/2 + radius - tbh;
-    sprite->setCursor(x , y);
-    sprite->print("S");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("S");
     break;
   case DIRECTION_TRACK_UP:
     x = radar_x + radar_w / 2 - radius + tbw/2;
     y = radar_y + (radar_w - tbh) / 2;
-    sprite->setCursor(x , y);
-    sprite->print("L");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("L");
     x = radar_x + radar_w / 2 + radius - (3 * tbw)/2;
     y = radar_y + (radar_w - tbh) / 2;
-    sprite->setCursor(x , y);
-    sprite->print("R");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("R");
     x = radar_x + (radar_w - tbw) / 2;
     y = radar_y + radar_w/2 + radius - tbh;
-    sprite->setCursor(x , y);
-    sprite->print("B");
+    radar_bg->setCursor(x , y);
+    radar_bg->print("B");
 
     snprintf(cog_text, sizeof(cog_text), "%03d", ThisAircraft.Track);
-    tbw = sprite->textWidth(cog_text);
-    tbh = sprite->fontHeight();
+    tbw = radar_bg->textWidth(cog_text);
+    tbh = radar_bg->fontHeight();
     x = radar_x + (radar_w - tbw) / 2;
     y = radar_y + radar_w/2 - radius + tbh/2;
-    sprite->setCursor(x , y);
-    sprite->print(cog_text);
-#if 0
-    sprite->drawRoundRect( x - 2, y - tbh - 2,
-                            tbw + 8, tbh + 6,
-                            4, TFT_WHITE);
-#endif
+    radar_bg->setCursor(x , y);
+    radar_bg->print(cog_text);
     break;
   default:
     /* TBD */
     break;
   }
 
-  sprite->setTextColor(TFT_WHITE, TFT_BLACK);
+  radar_bg->setTextColor(TFT_WHITE, TFT_BLACK);
   x = radar_x;
   y = radar_y + radar_w - tbh;
-  sprite->setCursor(x, y);
+  radar_bg->setCursor(x, y);
 
   if (settings->m.units == UNITS_METRIC || settings->m.units == UNITS_MIXED) {
-    sprite->print(TFT_zoom == ZOOM_LOWEST ? "20 KM" :
-                  TFT_zoom == ZOOM_LOW    ? "10 KM" :
-                  TFT_zoom == ZOOM_MEDIUM ? " 4 KM" :
-                  TFT_zoom == ZOOM_HIGH   ? " 2 KM" : "");
+    radar_bg->print(TFT_zoom == ZOOM_LOWEST ? "20 KM" :
+                    TFT_zoom == ZOOM_LOW    ? "10 KM" :
+                    TFT_zoom == ZOOM_MEDIUM ? " 4 KM" :
+                    TFT_zoom == ZOOM_HIGH   ? " 2 KM" : "");
   } else {
-    sprite->print(TFT_zoom == ZOOM_LOWEST ? "10 NM" :
-                  TFT_zoom == ZOOM_LOW    ? " 5 NM" :
-                  TFT_zoom == ZOOM_MEDIUM ? " 2 NM" :
-                  TFT_zoom == ZOOM_HIGH   ? " 1 NM" : "");
+    radar_bg->print(TFT_zoom == ZOOM_LOWEST ? "10 NM" :
+                    TFT_zoom == ZOOM_LOW    ? " 5 NM" :
+                    TFT_zoom == ZOOM_MEDIUM ? " 2 NM" :
+                    TFT_zoom == ZOOM_HIGH   ? " 1 NM" : "");
   }
 
+  bg_zoom        = TFT_zoom;
+  bg_orientation = settings->m.orientation;
+  bg_units       = settings->m.units;
+  bg_track       = ThisAircraft.Track;
+  radar_bg_valid = true;
+}
+
+static bool TFT_Radar_Background_Stale()
+{
+  return (! radar_bg_valid                              ||
+          bg_zoom        != TFT_zoom                    ||
+          bg_orientation != settings->m.orientation     ||
+          bg_units       != settings->m.units           ||
+          (settings->m.orientation == DIRECTION_TRACK_UP &&
+           bg_track      != ThisAircraft.Track));
+}
+
+/* copy one tile of the cached background onto the screen */
+static void TFT_Radar_Restore_Tile(int tx, int ty)
+{
+  int16_t x0 = tx * RADAR_TILE_SIZE;
+  int16_t y0 = ty * RADAR_TILE_SIZE;
+
+  if (radar_tile == NULL) {
+    radar_tile = new TFT_eSprite(tft);
+    radar_tile->setColorDepth(1);
+    radar_tile->createSprite(RADAR_TILE_SIZE, RADAR_TILE_SIZE);
+  }
+
+  for (int yy = 0; yy < RADAR_TILE_SIZE; yy++) {
+    for (int xx = 0; xx < RADAR_TILE_SIZE; xx++) {
+      radar_tile->drawPixel(xx, yy, radar_bg->readPixel(x0 + xx, y0 + yy));
+    }
+  }
+
+  radar_tile->pushSprite(x0, y0);
+}
+
+/* mark (and restore) all tiles under the box of a marker */
+static void TFT_Radar_Restore_Mark(const radar_mark_t *mp)
+{
+  int tiles_x = (tft->width()  + RADAR_TILE_SIZE - 1) / RADAR_TILE_SIZE;
+  int tiles_y = (tft->height() + RADAR_TILE_SIZE - 1) / RADAR_TILE_SIZE;
+
+  int tx0 = (mp->x - RADAR_MARK_HALF) / RADAR_TILE_SIZE;
+  int tx1 = (mp->x + RADAR_MARK_HALF) / RADAR_TILE_SIZE;
+  int ty0 = (mp->y - RADAR_MARK_HALF) / RADAR_TILE_SIZE;
+  int ty1 = (mp->y + RADAR_MARK_HALF) / RADAR_TILE_SIZE;
+
+  if (mp->x + RADAR_MARK_HALF < 0 || mp->y + RADAR_MARK_HALF < 0 ||
+      tx0 >= tiles_x || ty0 >= tiles_y) {
+    return;    /* entirely off screen */
+  }
+
+  if (tx0 < 0) tx0 = 0;
+  if (ty0 < 0) ty0 = 0;
+  if (tx1 >= tiles_x) tx1 = tiles_x - 1;
+  if (ty1 >= tiles_y) ty1 = tiles_y - 1;
+  if (ty1 >= RADAR_TILE_ROWS_MAX) ty1 = RADAR_TILE_ROWS_MAX - 1;
+  if (tx1 >= 32) tx1 = 31;
+
+  for (int ty = ty0; ty <= ty1; ty++) {
+    for (int tx = tx0; tx <= tx1; tx++) {
+      if ((radar_dirty[ty] & (1UL << tx)) == 0) {
+        TFT_Radar_Restore_Tile(tx, ty);
+        radar_dirty[ty] |= (1UL << tx);
+      }
+    }
+  }
+}
+
+static bool TFT_Radar_Mark_Touches_Dirty(const radar_mark_t *mp)
+{
+  for (int y = mp->y - RADAR_MARK_HALF; y <= mp->y + RADAR_MARK_HALF; y += RADAR_MARK_HALF) {
+    for (int x = mp->x - RADAR_MARK_HALF; x <= mp->x + RADAR_MARK_HALF; x += RADAR_MARK_HALF) {
+      if (x < 0 || y < 0)
+        continue;
+      int tx = x / RADAR_TILE_SIZE;
+      int ty = y / RADAR_TILE_SIZE;
+      if (tx < 32 && ty < RADAR_TILE_ROWS_MAX && (radar_dirty[ty] & (1UL << tx)))
+        return true;
+    }
+  }
+  return false;
+}
+
+static bool TFT_Radar_Mark_Listed(const radar_mark_t *mp,
+                                  const radar_mark_t *list, int n)
+{
+  for (int i=0; i < n; i++) {
+    if (list[i].x     == mp->x     && list[i].y     == mp->y &&
+        list[i].shape == mp->shape && list[i].color == mp->color) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void TFT_Radar_Draw_Mark(const radar_mark_t *mp)
+{
+  switch (mp->shape)
+  {
+  case MARK_ABOVE:
+    tft->fillTriangle(mp->x - 4, mp->y + 3,
+                      mp->x    , mp->y - 5,
+                      mp->x + 4, mp->y + 3,
+                      mp->color);
+    break;
+  case MARK_BELOW:
+    tft->fillTriangle(mp->x - 4, mp->y - 3,
+                      mp->x    , mp->y + 5,
+                      mp->x + 4, mp->y - 3,
+                      mp->color);
+    break;
+  case MARK_LEVEL:
+  default:
+    tft->fillCircle(mp->x, mp->y, 5, mp->color);
+    break;
+  }
+}
+
+/*
+ * The static background is only rendered (and pushed as a whole) when
+ * zoom, units, orientation or - in track-up mode - the track changes.
+ * Otherwise only the tiles under targets that moved or vanished are
+ * restored from the cached background, and the targets then redrawn.
+ */
+static void TFT_Draw_Radar()
+{
+  uint32_t start_us = micros();
+
+  int32_t divider = TFT_Radar_Divider();
+
+  uint16_t radar_w = tft->width();
+  uint16_t radar_center_x = radar_w / 2;
+  uint16_t radar_center_y = radar_w / 2;
+  uint16_t radius = radar_w / 2 - 1;
+
+  bool full = TFT_Radar_Background_Stale();
+
   tft->setBitmapColor(TFT_WHITE, TFT_NAVY);
-  sprite->pushSprite(0, 0);
-  sprite->deleteSprite();
+
+  if (full) {
+    TFT_Draw_Radar_Background();
+    radar_bg->pushSprite(0, 0);
+  }
+
+  int nmarks = 0;
 
   for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
     if (Container[i].ID && (now() - Container[i].timestamp) <= TFT_EXPIRATION_TIME) {
@@ -242,33 +415,56 @@ static void TFT_Draw_Radar()
         break;
       default:
         /* TBD */
-        break;
+        continue;
       }
 
       int16_t x = ((int32_t) rel_x * (int32_t) radius) / divider;
       int16_t y = ((int32_t) rel_y * (int32_t) radius) / divider;
 
-      uint32_t color = Container[i].AlarmLevel == ALARM_LEVEL_URGENT ? TFT_RED :
-                      (Container[i].AlarmLevel == ALARM_LEVEL_IMPORTANT ?
-                       TFT_YELLOW : TFT_GREEN);
+      radar_mark_t *mp = &marks_curr[nmarks++];
+
+      mp->x = radar_center_x + x;
+      mp->y = radar_center_y - y;
+      mp->color = Container[i].AlarmLevel == ALARM_LEVEL_URGENT ? TFT_RED :
+                 (Container[i].AlarmLevel == ALARM_LEVEL_IMPORTANT ?
+                  TFT_YELLOW : TFT_GREEN);
 
       if        (Container[i].RelativeVertical >   TFT_RADAR_V_THRESHOLD) {
-        tft->fillTriangle(radar_center_x + x - 4, radar_center_y - y + 3,
-                          radar_center_x + x    , radar_center_y - y - 5,
-                          radar_center_x + x + 4, radar_center_y - y + 3,
-                          color);
+        mp->shape = MARK_ABOVE;
       } else if (Container[i].RelativeVertical < - TFT_RADAR_V_THRESHOLD) {
-        tft->fillTriangle(radar_center_x + x - 4, radar_center_y - y - 3,
-                          radar_center_x + x    , radar_center_y - y + 5,
-                          radar_center_x + x + 4, radar_center_y - y - 3,
-                          color);
+        mp->shape = MARK_BELOW;
       } else {
-        tft->fillCircle(radar_center_x + x,
-                        radar_center_y - y,
-                        5, color);
+        mp->shape = MARK_LEVEL;
+      }
+    }
+  }
+
+  memset(radar_dirty, 0, sizeof(radar_dirty));
+
+  if (! full) {
+    /* erase targets that moved, changed or vanished */
+    for (int i=0; i < nmarks_prev; i++) {
+      if (! TFT_Radar_Mark_Listed(&marks_prev[i], marks_curr, nmarks)) {
+        TFT_Radar_Restore_Mark(&marks_prev[i]);
       }
     }
   }
+
+  for (int i=0; i < nmarks; i++) {
+    if (full ||
+        ! TFT_Radar_Mark_Listed(&marks_curr[i], marks_prev, nmarks_prev) ||
+        TFT_Radar_Mark_Touches_Dirty(&marks_curr[i])) {
+      TFT_Radar_Draw_Mark(&marks_curr[i]);
+    }
+  }
+
+  memcpy(marks_prev, marks_curr, nmarks * sizeof(radar_mark_t));
+  nmarks_prev = nmarks;
+
+  TFT_radar_frame_us = micros() - start_us;
+  if (TFT_radar_frame_us > TFT_radar_frame_max_us) {
+    TFT_radar_frame_max_us = TFT_radar_frame_us;
+  }
 }
 
 void TFT_radar_setup()
@@ -324,6 +520,7 @@ void TFT_radar_loop()
     if (view_state_curr != view_state_prev) {
        TFT_Clear_Screen();
        view_state_prev = view_state_curr;
+       radar_bg_valid = false;   /* screen no longer holds the background */
     }
     TFT_Draw_Radar();
   }
@@ -123,6 +123,36 @@
 #define ENABLE_AHRS
 #endif /* PREMIUM_PACKAGE */
 
+/* recent reports from another aircraft, for smoothed turn and climb rates */
+#define HISTORY_SIZE        8
+#define HISTORY_SPAN_MS  8000    /* fit only the reports from the last 8 seconds */
+#define HISTORY_MIN_MS    400    /* a closer report (e.g. relayed) replaces the latest */
+
+enum
+{
+	HISTORY_QUALITY_NONE = 0,   /* too few reports, use the two-point estimates */
+	HISTORY_QUALITY_LOW,        /* fitted, but over a short span or noisy - not trusted */
+	HISTORY_QUALITY_GOOD
+};
+
+typedef struct HISTORY {
+    uint32_t  t_ms[HISTORY_SIZE];   /* gnsstime_ms of each report */
+    uint16_t  crs[HISTORY_SIZE];    /* course, centidegrees */
+    uint16_t  spd[HISTORY_SIZE];    /* ground speed, tenths of knots */
+    int16_t   alt[HISTORY_SIZE];    /* altitude, meters */
+    uint8_t   head;                 /* next slot to write */
+    uint8_t   count;                /* reports in the ring */
+    uint8_t   used;                 /* reports used in the last fit */
+    uint8_t   quality;              /* HISTORY_QUALITY_... */
+    /* least-squares fit, as of the latest report */
+    float     speed;                /* knots */
+    float     course;               /* degrees */
+    float     turnrate;             /* degrees per second, ground reference */
+    float     vs;                   /* feet per minute */
+    float     course_rms;           /* degrees, residual of the course fit */
+    float     alt_rms;              /* meters, residual of the altitude fit */
+} history_t;
+
 typedef struct CONTAINER {
 
     uint8_t   protocol;
@@ -153,6 +183,7 @@ typedef struct CONTAINER {
     float     prevheading;    /* previous heading */
 /*  float     prevspeed;  */  /* previous speed */
     float     prevaltitude;   /* previous altitude */
+    history_t history;        /* other aircraft only, see track_that() */
     float     distance;       // meters
     float     mindist;
     float     bearing;
@@ -187,6 +218,7 @@ typedef struct CONTAINER {
     uint16_t  hdop; /* cm */
     uint32_t  last_crc;
     int8_t    rssi;
+    int8_t    snr;
     int8_t    mindistrssi;
     int8_t    maxrssi;
 
@@ -78,6 +78,7 @@
 #include "src/system/SoC.h"
 #include "src/system/OTA.h"
 #include "src/system/Time.h"
+#include "src/system/Profiler.h"
 #include "src/driver/LED.h"
 #include "src/driver/GNSS.h"
 #include "src/driver/RF.h"
@@ -481,15 +482,19 @@ void normal()
   bool rx_success = false;
   bool tx_success = false;
 
+  PROF_START(prof_baro);
   Baro_loop();
+  PROF_END(PROF_BARO, prof_baro);
 
 #if defined(ENABLE_AHRS)
   AHRS_loop();
 #endif /* ENABLE_AHRS */
 
+  PROF_START(prof_gnss);
   GNSS_loop();
 
   Time_loop();   /* this is where GNSS time data is processed for Legacy protocol */
+  PROF_END(PROF_GNSS, prof_gnss);
 
   static uint32_t initial_time = 0;
 
@@ -604,38 +609,59 @@ Serial.println("Tentative GNSS fix");
 
       // the new fix data
       ThisAircraft.gnsstime_ms = ref_time_ms;          /* last PPS, real or assumed */
-      ThisAircraft.latitude = gnss.location.lat();
-      ThisAircraft.longitude = gnss.location.lng();
-      ThisAircraft.altitude = gnss.altitude.meters();
-      ThisAircraft.geoid_separation = gnss.separation.meters();
+#if defined(USE_UBX_PVT)
+      if (ubx_pvt_active && millis() - ubx_pvt.timestamp < 1500
+                         && (ubx_pvt.flags & 0x01)) {           /* gnssFixOK */
+        /* straight from NAV-PVT, without the rounding of the TinyGPS++ fields */
+        ThisAircraft.gnsstime_ms += ubx_pvt.iTOW % 1000;  /* fix epoch within the second */
+        ThisAircraft.latitude  = 1e-7 * ubx_pvt.lat;
+        ThisAircraft.longitude = 1e-7 * ubx_pvt.lon;
+        ThisAircraft.altitude  = 0.001 * ubx_pvt.height; /* above ellipsoid, as stored */
+        ThisAircraft.geoid_separation = 0.001 * (ubx_pvt.height - ubx_pvt.hMSL);
+        ThisAircraft.course = 0.00001 * ubx_pvt.headMot;
+        ThisAircraft.speed  = 0.001 * ubx_pvt.gSpeed / _GPS_MPS_PER_KNOT;
+      } else
+#endif
+      {
+        ThisAircraft.latitude = gnss.location.lat();
+        ThisAircraft.longitude = gnss.location.lng();
+        ThisAircraft.altitude = gnss.altitude.meters();
+        ThisAircraft.geoid_separation = gnss.separation.meters();
 // excluding the EGM96 lookup means the altitude reported to external devices in GGA sentences
 // will be ellipsoid rather than MSL - but only in the rare cases of "fake" GPS units
 // and this has no effect on the internal SoftRF calculations nor what it transmits.
-      /*
-       * When geoidal separation is zero or not available - use approx. EGM96 value
-       */
-      if (ThisAircraft.geoid_separation == 0.0) {
-        ThisAircraft.geoid_separation = EGM96GeoidSeparation();
-        /* we can assume the GPS unit is giving ellipsoid height */
-        /* we now store ellipsoid altitude - so leave it alone */
-        //ThisAircraft.altitude -= ThisAircraft.geoid_separation;
-      } else {
-        ThisAircraft.altitude += ThisAircraft.geoid_separation;
-             // - converts MSL altitude in GGA to altitude above ellipsoid
+        /*
+         * When geoidal separation is zero or not available - use approx. EGM96 value
+         */
+        if (ThisAircraft.geoid_separation == 0.0) {
+          ThisAircraft.geoid_separation = EGM96GeoidSeparation();
+          /* we can assume the GPS unit is giving ellipsoid height */
+          /* we now store ellipsoid altitude - so leave it alone */
+          //ThisAircraft.altitude -= ThisAircraft.geoid_separation;
+        } else {
+          ThisAircraft.altitude += ThisAircraft.geoid_separation;
+               // - converts MSL altitude in GGA to altitude above ellipsoid
+        }
+        ThisAircraft.course = gnss.course.deg();
+        ThisAircraft.speed = gnss.speed.knots();
       }
+      if (ThisAircraft.course < 0.0)   ThisAircraft.course += 360.0;
+      ThisAircraft.hdop = (uint16_t) gnss.hdop.value();
       if (ThisAircraft.aircraft_type == AIRCRAFT_TYPE_WINCH) {
         /* for "winch" aircraft type, elevate above ground */
         ThisAircraft.altitude += (float) (((ThisAircraft.timestamp & 0x03) * 100) + 100);
       }
-      ThisAircraft.course = gnss.course.deg();
-      if (ThisAircraft.course < 0.0)   ThisAircraft.course += 360.0;
-      ThisAircraft.speed = gnss.speed.knots();
-      ThisAircraft.hdop = (uint16_t) gnss.hdop.value();
 
       /* if no baro sensor, fill in ThisAircraft.vs based on GPS data */
       if (baro_chip == NULL) {
         /* only do this once every 4 seconds */
         static uint32_t time_to_estimate_climb = 0;
+#if defined(USE_UBX_PVT)
+        if (ubx_pvt_active && millis() - ubx_pvt.timestamp < 1500) {
+          /* NAV-PVT carries the Doppler vertical velocity, mm/s down */
+          ThisAircraft.vs = (float) ubx_pvt.velD * (-0.06f * _GPS_FEET_PER_METER);
+        } else
+#endif
         if (ThisAircraft.gnsstime_ms > time_to_estimate_climb) {
           time_to_estimate_climb = ThisAircraft.gnsstime_ms + 3900;
           ThisAircraft.vs = Estimate_Climbrate();
@@ -659,7 +685,9 @@ Serial.println("Tentative GNSS fix");
       }
 #endif
 
+      PROF_START(prof_wind);
       Estimate_Wind();      // estimate wind from present and past GNSS data
+      PROF_END(PROF_WIND, prof_wind);
 
       /* generate a random aircraft ID if necessary */
       /* doing it here (after some delay) allows use of millis() as seed for random ID */
@@ -673,14 +701,17 @@ Serial.println("Tentative GNSS fix");
       // check for newly received data, usually returns false
       // >>> do this here (too?) to ensure no incoming packets are missed
       rx_tried = true;
+      PROF_START(prof_rx);
       rx_success = RF_Receive();
+      PROF_END(PROF_RX, prof_rx);
 if (rx_success) which_rx_try = 1;
       // if received a packet, postpone transmission until next time around the loop().
 
       if (!rx_success && RF_Transmit_Ready(true)
-          && (relay_waiting == NULL || RF_current_slot == 0)
+          && (RF_current_slot == 0 || ! Relay_Pending())
           && settings->relay < RELAY_ONLY) {
           // Don't bother with the encode() if can't transmit right now
+          PROF_START(prof_tx);
           size_t s = RF_Encode(&ThisAircraft, true);  // returns 0 if implausible data
           if (s != 0) {
               RF_Transmit(s, true);
@@ -688,6 +719,7 @@ if (rx_success) which_rx_try = 1;
               if (RF_Transmit_Happened())
                 tx_success = true;
           }
+          PROF_END(PROF_TX, prof_tx);
       }
       /* - this only actually transmits when some preset random time is reached */
 
@@ -730,7 +762,20 @@ if (rx_success) which_rx_try = 2;
 
     /* process received data - only if we know where we are */
     if (rx_success && validfix) {
-        ParseData();
+#if defined(ENABLE_PROFILER)
+        Profiler_rx_mark();
+#endif
+        PROF_START(prof_parse);
+        /* several packets may have queued up in the same time slot */
+        int rx_batch = 0;
+        do {
+#if defined(USE_CORE1_DECODE)
+          ParseData_Post();    /* AddTraffic() is done in ParseData_Collect() */
+#else
+          ParseData();
+#endif
+        } while (++rx_batch < RF_RX_BATCH && RF_Receive());
+        PROF_END(PROF_PARSE, prof_parse);
     }
 
   }
@@ -741,7 +786,9 @@ if (rx_success) which_rx_try = 2;
 
   if (validfix) {
     /* handle the known traffic - only if we know where we are */
+    PROF_START(prof_traffic);
     Traffic_loop();
+    PROF_END(PROF_TRAFFIC, prof_traffic);
   }
 
   if (validfix && settings->logflight != FLIGHT_LOG_NONE) {
@@ -755,10 +802,12 @@ if (rx_success) which_rx_try = 2;
     uint32_t ms_since_pps = (msnow - ref_time_ms);
     if (msnow > IGCTimeMarker && ms_since_pps > 270
             && ms_since_pps < ((settings->debug_flags & DEBUG_SIMULATE)? 800 : 370)) {
+      PROF_START(prof_log);
       logFlightPosition();
       if (settings->logflight == FLIGHT_LOG_TRAFFIC)
           logCloseTraffic();
       IGCTimeMarker = ref_time_ms + (1000 * (uint32_t) settings->loginterval) + 320;
+      PROF_END(PROF_LOG, prof_log);
     }
 #else
     // on T-Echo don't worry about SPI bus
@@ -780,6 +829,7 @@ if (rx_success) which_rx_try = 2;
     LEDTimeMarker = millis();
   }
 
+  PROF_START(prof_sound);
   Buzzer_loop();   /* may sound collision alarms */
 
   Strobe_loop();
@@ -788,9 +838,14 @@ if (rx_success) which_rx_try = 2;
 #if defined(ESP32)
   Voice_loop();   /* may sound collision alarms */
 #endif
+#endif
+  PROF_END(PROF_SOUND, prof_sound);
+#if defined(ENABLE_PROFILER)
+  Profiler_alarm_done();
 #endif
 
   if (isTimeToExport()) {
+    PROF_START(prof_export);
     NMEA_Export();
     GDL90_Export();
 
@@ -798,10 +853,19 @@ if (rx_success) which_rx_try = 2;
       D1090_Export();
     }
     ExportTimeMarker = millis();
+    PROF_END(PROF_EXPORT, prof_export);
   }
 
+#if defined(USE_CORE1_DECODE)
+  /* add the traffic decoded on core1 meanwhile, before the GDL90 and */
+  /* simulated traffic from NMEA_loop(), to keep things in order      */
+  ParseData_Collect();
+#endif
+
   // Handle Air Connect
+  PROF_START(prof_nmea);
   NMEA_loop();
+  PROF_END(PROF_NMEA_IN, prof_nmea);
 
   //ClearExpired();    // now done in Traffic_loop() instead
 }
@@ -874,6 +938,8 @@ void bridge()
     Raw_Transmit_UDP();
   }
 
+  Raw_Loop_UDP();        /* send the batch if the oldest packet has waited long enough */
+
   if (isTimeToDisplay()) {
     LED_Clear();
     LEDTimeMarker = millis();
@@ -1090,6 +1156,10 @@ void gpsbridge()
 
 void loop()
 {
+#if defined(ENABLE_PROFILER)
+  Profiler_loop_start();
+#endif
+
   // Do common RF stuff first
   if (settings->mode != SOFTRF_MODE_GPSBRIDGE)
     RF_loop();
@@ -1128,11 +1198,14 @@ void loop()
   }
 
   // Show status info on tiny OLED display
+  PROF_START(prof_display);
   SoC->Display_loop();
+  PROF_END(PROF_DISPLAY, prof_display);
 
   // battery status LED
   LED_loop();
 
+  PROF_START(prof_wifi);
   // Handle DNS
   WiFi_loop();
 
@@ -1141,6 +1214,7 @@ void loop()
 
   // Handle OTA update.
   OTA_loop();
+  PROF_END(PROF_WIFI, prof_wifi);
 
 #if LOGGER_IS_ENABLED
   Logger_loop();
@@ -1148,6 +1222,7 @@ void loop()
 
   SoC->loop();
 
+  PROF_START(prof_serial);
   if (SoC->Bluetooth_ops) {
     SoC->Bluetooth_ops->loop();
   }
@@ -1159,6 +1234,7 @@ void loop()
   if (SoC->UART_ops) {
      SoC->UART_ops->loop();
   }
+  PROF_END(PROF_SERIAL, prof_serial);
 
   Battery_loop();
 
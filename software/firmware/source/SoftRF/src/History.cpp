@@ -0,0 +1,152 @@
+/*
+ * History.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The recent-report history of other aircraft, used by project_that() and
+ * the alarm code in place of the two-point turn and climb rates.  Kept
+ * apart from Wind.cpp so that it builds on a host, see tests/test_track.cpp.
+ */
+
+#include <math.h>
+#include <TinyGPS++.h>      /* _GPS_FEET_PER_METER */
+
+#include "../SoftRF.h"
+#include "Wind.h"
+
+/*
+ * Add the latest report from another aircraft to its history, and fit
+ * straight lines through the course, speed and altitude reports of the
+ * last few seconds, by least squares against time.  The slopes give the
+ * turn rate and climb rate, and the fitted values at the latest report
+ * are a smoothed course and speed.  Unlike the estimates from the two
+ * latest reports, this is not thrown off by a missed or late packet, and
+ * a duplicate (e.g. relayed) report only replaces the one it copies.
+ */
+void track_that(container_t *fop)
+{
+    history_t *hp = &fop->history;
+    uint32_t t_ms = fop->gnsstime_ms;
+    int i, k, n;
+
+    k = (hp->head + (HISTORY_SIZE - 1)) % HISTORY_SIZE;   /* latest report */
+    if (hp->count > 0) {
+        int32_t dt = (int32_t) (t_ms - hp->t_ms[k]);
+        if (dt < 0)
+            return;                /* older than what we have, ignore */
+        if (dt > HISTORY_SPAN_MS)
+            hp->count = 0;         /* all too old, start over */
+        else if (dt < HISTORY_MIN_MS) {
+            hp->head = k;          /* overwrite the latest */
+            --hp->count;
+        }
+    }
+
+    k = hp->head;
+    hp->t_ms[k] = t_ms;
+    float course = fop->course;
+    if (course < 0)       course += 360.0;
+    if (course >= 360.0)  course -= 360.0;
+    hp->crs[k] = (uint16_t) (100.0f * course);
+    hp->spd[k] = (uint16_t) (10.0f * fop->speed);
+    hp->alt[k] = (int16_t) fop->altitude;
+    hp->head = (k + 1) % HISTORY_SIZE;
+    if (hp->count < HISTORY_SIZE)
+        ++hp->count;
+
+    /* collect the recent reports, newest first, time in seconds before the latest,
+       course unwrapped relative to the newer neighbour */
+    float x[HISTORY_SIZE], c[HISTORY_SIZE], a[HISTORY_SIZE];
+    float sx = 0, sxx = 0, sc = 0, sxc = 0, ss = 0, sxs = 0, sa = 0, sxa = 0;
+    float prev = 0;
+    for (n=0; n < hp->count; n++) {
+        i = (k + HISTORY_SIZE - n) % HISTORY_SIZE;
+        uint32_t age = t_ms - hp->t_ms[i];
+        if (age > HISTORY_SPAN_MS)
+            break;
+        x[n] = -0.001f * (float) age;
+        float cn = 0.01f * (float) hp->crs[i];
+        if (n == 0) {
+            c[0] = cn;
+        } else {
+            float d = cn - prev;
+            if (d >  180.0)  d -= 360.0;
+            if (d < -180.0)  d += 360.0;
+            c[n] = c[n-1] + d;
+        }
+        prev = cn;
+        float sn = 0.1f * (float) hp->spd[i];
+        a[n] = (float) hp->alt[i];
+        sx  += x[n];
+        sxx += x[n] * x[n];
+        sc  += c[n];
+        sxc += x[n] * c[n];
+        ss  += sn;
+        sxs += x[n] * sn;
+        sa  += a[n];
+        sxa += x[n] * a[n];
+    }
+    hp->used = n;
+
+    float det = n * sxx - sx * sx;           /* n^2 times the variance of x */
+    if (n < 3 || det < 0.25f * n * n) {      /* spread less than half a second */
+        hp->quality = HISTORY_QUALITY_NONE;
+        return;
+    }
+    float inv = 1.0f / det;
+
+    float tr = (n * sxc - sx * sc) * inv;
+    float c0 = (sc - tr * sx) / n;
+    float sr = (n * sxs - sx * ss) * inv;
+    float s0 = (ss - sr * sx) / n;
+    float vr = (n * sxa - sx * sa) * inv;
+    float a0 = (sa - vr * sx) / n;
+
+    float cres = 0, ares = 0;
+    for (i=0; i < n; i++) {
+        float d = c[i] - (c0 + tr * x[i]);
+        cres += d * d;
+        d = a[i] - (a0 + vr * x[i]);
+        ares += d * d;
+    }
+    hp->course_rms = sqrtf(cres / n);
+    hp->alt_rms = sqrtf(ares / n);
+
+    if (n >= 4 && det >= (float) (n * n)        /* spread at least a second */
+        && hp->course_rms < 10.0 && hp->alt_rms < 15.0)
+        hp->quality = HISTORY_QUALITY_GOOD;
+    else
+        hp->quality = HISTORY_QUALITY_LOW;
+
+    hp->turnrate = tr;
+    while (c0 <    0.0)  c0 += 360.0;
+    while (c0 >= 360.0)  c0 -= 360.0;
+    hp->course = c0;
+    hp->speed = (s0 > 0 ? s0 : 0);
+    hp->vs = vr * (_GPS_FEET_PER_METER * 60.0f);
+}
+
+/*
+ * Vertical speed of another aircraft for the alarm code: smoothed over
+ * the recent reports if the fit is good, otherwise as last reported.
+ */
+float that_vs(container_t *fop)
+{
+    if (fop->history.quality == HISTORY_QUALITY_GOOD)
+        return fop->history.vs;
+    return fop->vs;
+}
@@ -36,6 +36,7 @@
 #include "protocol/data/IGC.h"
 #include "Wind.h"
 
+
 #if !defined(EXCLUDE_VOICE)
 #if defined(ESP32)
 #include "driver/Voice.h"
@@ -141,8 +142,42 @@ static int8_t (*Alarm_Level)(container_t *, container_t *);
 
 static uint32_t Alarm_timer = 0;
 
-container_t *relay_waiting = NULL;
+/*
+ * The alarm being annunciated now.  All the outputs (buzzer, strobe,
+ * voice) are started together from Annunciate(), and while that pattern
+ * plays a new alarm only gets through if it is at a higher level, in which
+ * case it cuts the current beeps short.  Voice messages cannot be cut
+ * short once sent to the I2S output, so a higher alarm gets its voice
+ * message only if the previous one has finished.
+ */
+#define ANNUNCIATE_MIN_MS  1000     /* if no buzzer pattern to time it */
+static int8_t   annunciate_level = ALARM_LEVEL_NONE;
+static uint32_t annunciate_end   = 0;
+
+static bool Annunciate(int8_t level, bool multi_alarm, container_t *fop)
+{
+    uint32_t now = millis();
+    if (annunciate_level != ALARM_LEVEL_NONE
+          && (int32_t)(now - annunciate_end) < 0
+          && level <= annunciate_level)
+        return false;
+    uint32_t duration = Buzzer_Notify(level, multi_alarm);
+    bool notified = (duration > 0);
+    Strobe_Notify(level);
+#if !defined(EXCLUDE_VOICE)
+#if defined(ESP32)
+    notified |= Voice_Notify(fop, multi_alarm);
+#endif
+#endif
+    if (duration < ANNUNCIATE_MIN_MS)
+        duration = ANNUNCIATE_MIN_MS;
+    annunciate_level = level;
+    annunciate_end = now + duration;
+    return notified;
+}
+
 uint32_t priority_relay = 0;   // ID of landed-out or close ADS-B
+relay_stats_t relay_stats;
 
 // Compute registration-number from ICAO ID - USA and Canada only
 
@@ -262,7 +297,7 @@ static int8_t Alarm_None(container_t *this_aircraft, container_t *fop)
 float Adj_alt_diff(container_t *this_aircraft, container_t *fop)
 {
   float alt_diff = fop->alt_diff;           /* positive means fop is higher than this_aircraft */
-  float vsr = fop->vs - this_aircraft->vs;  /* positive means fop is rising relative to this_aircraft */
+  float vsr = that_vs(fop) - this_aircraft->vs;  /* positive means fop is rising relative to this_aircraft */
   if (vsr >  2000)  vsr =  2000;            /* ignore implausible data (units are fpm) */
   if (vsr < -2000)  vsr = -2000;
   float alt_change = vsr * 0.05;  /* expected change in 10 seconds, converted to meters */
@@ -333,7 +368,8 @@ static int8_t Alarm_Vector(container_t *this_aircraft, container_t *fop)
 
   int8_t rval = ALARM_LEVEL_NONE;
 
-  if (fop->gnsstime_ms - fop->prevtime_ms > 3000)   /* also catches prevtime_ms == 0 */
+  if (fop->gnsstime_ms - fop->prevtime_ms > 3000   /* also catches prevtime_ms == 0 */
+      && fop->history.quality != HISTORY_QUALITY_GOOD)    /* as in project_that() */
     return Alarm_Distance(this_aircraft, fop);
 
   float distance = fop->distance;
@@ -546,7 +582,7 @@ static int8_t Alarm_Latest(container_t *this_aircraft, container_t *fop)
 
   /* also take altitude difference and zoom-up into account */
   dz = (int) fop->alt_diff;          // meters   - not adj_alt_diff since we re-compute zoom-up here
-  float vsr = fop->vs - this_aircraft->vs;  // fpm, >0 if fop is rising relative to this_aircraft
+  float vsr = that_vs(fop) - this_aircraft->vs;  // fpm, >0 if fop is rising relative to this_aircraft
   int absdz = abs(dz);
   int adjdz = absdz;
   // assume lower aircraft may be zooming up
@@ -1021,6 +1057,12 @@ static uint32_t oldrssi_n;
 static uint32_t newrssi_n;
 static float oldrssi_ssd;
 static float newrssi_ssd;
+/* time of reception within the second, and LoRa SNR, for this flight only */
+static uint32_t rxphase_n[2];
+static float rxphase_sum[2];
+static float rxphase_ssd[2];
+static uint32_t snr_n;
+static float snr_sum;
 
 static void zero_range_stats()
 {
@@ -1035,6 +1077,11 @@ static void zero_range_stats()
     newrssi_n = 0;
     oldrssi_ssd = 0.0;
     newrssi_ssd = 0.0;
+    memset(rxphase_n, 0, sizeof(rxphase_n));
+    memset(rxphase_sum, 0, sizeof(rxphase_sum));
+    memset(rxphase_ssd, 0, sizeof(rxphase_ssd));
+    snr_n = 0;
+    snr_sum = 0.0;
 }
 
 #define RANGESTATSVERSION 1
@@ -1107,12 +1154,157 @@ static bool load_range_stats()
     return true;
 }
 
+/*
+ * Long-term coverage database, kept over many flights in /coverage.bin:
+ * for each protocol group, relative altitude band and 30-degree sector
+ * (relative to our heading), a sample count, the mean log2 of the range
+ * and the mean RSSI.  The means are exponentially decaying, with an
+ * effective window of COV_WINDOW samples, so that a change of antenna
+ * shows up after a flight or two.  During the flight each sample is
+ * appended to /coverage.log as a 4-byte record, and that journal is
+ * folded into coverage.bin after landing (or at the next boot, if the
+ * power went off first).
+ */
+cov_cell_t coverage[COV_PROTOCOLS][COV_BANDS][COV_SECTORS];
+
+#define COV_MAGIC     0x56435253    /* "SRCV" */
+#define COV_VERSION   1
+#define COV_WINDOW    64
+#define COV_CHECK     0xA5          /* last byte of each journal record */
+
+static const char *cov_filename = "/coverage.bin";
+static const char *cov_journal  = "/coverage.log";
+static int cov_new = 0;             /* samples not yet in coverage.bin */
+
+static int coverage_protocol(uint8_t protocol)
+{
+    switch (protocol)
+    {
+    case RF_PROTOCOL_LATEST:
+    case RF_PROTOCOL_LEGACY:     return COV_FLARM;
+    case RF_PROTOCOL_ADSL:       return COV_ADSL;
+    case RF_PROTOCOL_OGNTP:      return COV_OGNTP;
+    case RF_PROTOCOL_FANET:
+    case RF_PROTOCOL_P3I:        return COV_FANET;
+    default:                     return COV_ADSB;  /* 1090ES, UAT, GDL90 */
+    }
+}
+
+static void coverage_update(uint8_t ndx, uint8_t range, int8_t rssi)
+{
+    if (ndx >= COV_CELLS)
+        return;
+    cov_cell_t *cp = &coverage[0][0][0] + ndx;
+    int w = (cp->n < COV_WINDOW ? cp->n : COV_WINDOW) + 1;
+    // the means are kept scaled by 64, so that small deviations still count
+    int d = ((int) range << 6) - (int) cp->range;
+    cp->range += (d + (d < 0 ? -w/2 : w/2)) / w;
+    d = ((int) rssi << 6) - (int) cp->rssi;
+    cp->rssi  += (d + (d < 0 ? -w/2 : w/2)) / w;
+    if (cp->n < 0xFFFF)
+        ++cp->n;
+}
+
+static void coverage_sample(container_t *fop)
+{
+    int sector = fop->RelativeHeading + 15;
+    if (sector < 0)     sector += 360;
+    if (sector >= 360)  sector -= 360;
+    sector /= 30;
+    int band = (fop->alt_diff < -300.0f ? 0 :
+               (fop->alt_diff <    0.0f ? 1 :
+               (fop->alt_diff <  300.0f ? 2 : 3)));
+    float lr = 32.0f * log2(0.001f * fop->distance);      // 1 km = 0, 256 km = 255
+    uint8_t range = (lr < 0 ? 0 : (lr > 255 ? 255 : (uint8_t) lr));
+    uint8_t ndx = (coverage_protocol(fop->protocol) * COV_BANDS + band) * COV_SECTORS + sector;
+    coverage_update(ndx, range, fop->rssi);
+    ++cov_new;
+
+#if defined(FILESYS)
+    if (! FS_is_mounted)
+        return;
+    uint8_t rec[4] = { ndx, range, (uint8_t) fop->rssi, COV_CHECK };
+#if defined(ESP32)
+    File journal = FILESYS.open(cov_journal, FILE_APPEND);
+#else
+    File journal = FILESYS.open(cov_journal, (O_WRITE | O_CREAT | O_APPEND));
+#endif
+    if (journal) {
+        journal.write(rec, sizeof(rec));
+        journal.close();
+    }
+#endif   // FILESYS
+}
+
+/* write out the table and discard the journal */
+void Coverage_save()
+{
+#if defined(FILESYS)
+    if (cov_new == 0 || ! FS_is_mounted)
+        return;
+    FILESYS.remove(cov_filename);
+    File covfile = FILESYS.open(cov_filename, FILE_WRITE);
+    if (! covfile)
+        return;
+    uint32_t header[2] = { COV_MAGIC, (COV_VERSION << 24) | (COV_PROTOCOLS << 16)
+                                        | (COV_BANDS << 8) | COV_SECTORS };
+    covfile.write((const uint8_t *) header, sizeof(header));
+    covfile.write((const uint8_t *) coverage, sizeof(coverage));
+    covfile.close();
+    FILESYS.remove(cov_journal);
+    cov_new = 0;
+#endif   // FILESYS
+}
+
+static void load_coverage()
+{
+    memset(coverage, 0, sizeof(coverage));
+#if defined(FILESYS)
+    if (! FS_is_mounted)
+        return;
+    File covfile = FILESYS.open(cov_filename, FILE_READ);
+    if (covfile) {
+        uint32_t header[2];
+        if (covfile.read((uint8_t *) header, sizeof(header)) != sizeof(header)
+         || header[0] != COV_MAGIC
+         || header[1] != ((COV_VERSION << 24) | (COV_PROTOCOLS << 16)
+                                | (COV_BANDS << 8) | COV_SECTORS)
+         || covfile.read((uint8_t *) coverage, sizeof(coverage)) != sizeof(coverage)) {
+            Serial.println("coverage.bin not valid, starting over");
+            memset(coverage, 0, sizeof(coverage));
+        }
+        covfile.close();
+    }
+    if (! FILESYS.exists(cov_journal))
+        return;
+    File journal = FILESYS.open(cov_journal, FILE_READ);
+    if (! journal)
+        return;
+    uint8_t rec[4];
+    int n = 0;
+    while (journal.read(rec, sizeof(rec)) == sizeof(rec)) {
+        if (rec[3] == COV_CHECK) {
+            coverage_update(rec[0], rec[1], (int8_t) rec[2]);
+            ++n;
+        }
+    }
+    journal.close();
+    Serial.print(n);
+    Serial.println(" coverage samples recovered from journal");
+    cov_new = n;
+    if (n == 0)
+        FILESYS.remove(cov_journal);
+    Coverage_save();
+#endif   // FILESYS
+}
+
 void sample_range(container_t *fop)
 {
     if (! ThisAircraft.airborne)       return;
     if (! fop->airborne)               return;
-    if (fop->tx_type < TX_TYPE_FLARM)  return;
     if (fop->distance < 1000.0)        return;
+    coverage_sample(fop);              // all protocols, all altitudes
+    if (fop->tx_type < TX_TYPE_FLARM)  return;
     if (4.0 * fabs(fop->alt_diff) > fop->distance)    return;
     int oclock = fop->RelativeHeading + 15;
     if (oclock < 0)     oclock += 360;
@@ -1126,11 +1318,25 @@ void sample_range(container_t *fop)
     newrssi_dev += rssi_dev;
     newrssi_ssd += rssi_dev * rssi_dev;
     ++newrssi_n;
+    if (fop->snr != 0) {
+        snr_sum += (float) fop->snr;
+        ++snr_n;
+    }
+    // gnsstime_ms is when the packet was received, see where in the second:
+    // slot 0 is 400-800 ms after the PPS, slot 1 is 800-1200 ms
+    int32_t phase = (int32_t) (fop->gnsstime_ms - ref_time_ms) % 1000;
+    if (phase < 300)
+        phase += 1000;
+    int slot = (phase < 800 ? 0 : 1);
+    rxphase_sum[slot] += (float) phase;
+    rxphase_ssd[slot] += (float) phase * (float) phase;
+    ++rxphase_n[slot];
 }
 
 // this is called after landing
 void save_range_stats()
 {
+    Coverage_save();     // may have ADS-B samples even if no FLARM ones
     if (newrssi_n == 0)  // no new data
         return;
     FILESYS.remove("/oldrange.txt");
@@ -1174,23 +1380,159 @@ void save_range_stats()
     statsfile.println(buf+3);   // skip the "AN,"
     FlightLogComment(buf);      // - it will prepend LPLT, resulting in, e.g., LPLTAN,...
     statsfile.close();
+    // reception timing and SNR are logged but not kept in range.txt
+    for (int slot=0; slot<2; slot++) {
+        if (rxphase_n[slot] == 0)
+            continue;
+        float mean = rxphase_sum[slot] / (float) rxphase_n[slot];
+        float var  = rxphase_ssd[slot] / (float) rxphase_n[slot] - mean * mean;
+        snprintf(buf, 64, "AT,%d,%d,%.0f,%.0f",
+            slot, rxphase_n[slot], mean, (var > 0 ? sqrtf(var) : 0.0));
+        Serial.println(buf);
+        FlightLogComment(buf);      // LPLTAT,slot,n,mean_ms_after_PPS,sd_ms
+    }
+    if (snr_n) {
+        snprintf(buf, 64, "AS,%d,%.1f", snr_n, snr_sum / (float) snr_n);
+        Serial.println(buf);
+        FlightLogComment(buf);      // LPLTAS,n,mean_snr
+    }
     load_range_stats();         // in case of another flight
 }
 
+/*
+ * Relays that could not be sent when the packet came in wait in a small
+ * queue (by ID, since the Container[] slot may be reused meanwhile), and
+ * the most deserving one is sent in the next slot 1, instead of our own
+ * position.  Landed-out aircraft come first, then traffic that is causing
+ * alarms, fresher data and closer aircraft, while aircraft that were
+ * recently relayed (by us or by others) go to the back of the line.
+ * All relays also draw on an airtime budget, refilled at a rate that
+ * depends on the band: in the single-channel bands the duty cycle is
+ * shared with our own transmissions.  Except in RELAY_ONLY mode, which
+ * sends no own-ship position, so the slot it relays in is one it would
+ * otherwise have used itself - there it stays at one relay per slot.
+ */
+#define RELAY_QUEUE_SIZE    4
+#define RELAY_AIR_TIME      6     /* ms, worst case of Legacy, OGNTP, ADS-L */
+#define RELAY_BUDGET_1CH    8     /* ms of relay airtime per second, EU etc */
+#define RELAY_BUDGET_HOP   20     /* ms of relay airtime per second, US & AU */
+#define RELAY_BUDGET_BURST  3     /* relays that may be sent back-to-back */
+
+static uint32_t relay_queue[RELAY_QUEUE_SIZE];   // aircraft IDs, 0 = empty
+static uint32_t relay_budget_us = RELAY_BUDGET_BURST * RELAY_AIR_TIME * 1000;
+static bool relay_delayed = false;               // servicing the queue
+
+static container_t *relay_find(uint32_t addr)
+{
+    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+        if (Container[i].addr == addr)
+            return &Container[i];
+    }
+    return NULL;
+}
+
+static int relay_score(container_t *cip)
+{
+    int score = 0;
+    if (cip->aircraft_type == AIRCRAFT_TYPE_UNKNOWN && cip->airborne == 0)
+        score += 1000;                                 // landed out
+    score += 100 * cip->alarm_level;
+    score -= 20 * (int) (OurTime - cip->timestamp);    // seconds old
+    if (cip->timerelayed > 1 && cip->timerelayed + ENTRY_RELAY_TIME > OurTime)
+        score -= 200;                                  // relayed recently
+    score -= (int) (cip->distance * 0.01f);            // 1 per 100 m
+    return score;
+}
+
+static void relay_enqueue(container_t *cip)
+{
+    int worst = 0;
+    int worst_score = 0x7FFFFFFF;
+    for (int i=0; i < RELAY_QUEUE_SIZE; i++) {
+        if (relay_queue[i] == cip->addr)
+            return;                                    // already waiting
+        if (relay_queue[i] == 0) {
+            worst = i;
+            worst_score = -0x7FFFFFFF;                 // use a free entry
+            continue;
+        }
+        container_t *qip = relay_find(relay_queue[i]);
+        int score = (qip ? relay_score(qip) : -0x7FFFFFFF);
+        if (score < worst_score) {
+            worst = i;
+            worst_score = score;
+        }
+    }
+    if (relay_queue[worst] != 0) {
+        if (worst_score >= relay_score(cip))
+            return;                                    // queue full of better ones
+        ++relay_stats.dropped;
+    }
+    relay_queue[worst] = cip->addr;
+}
+
+/* remove and return the best candidate still worth relaying */
+static container_t *relay_dequeue()
+{
+    container_t *best = NULL;
+    int best_ndx = 0;
+    int best_score = 0;
+    for (int i=0; i < RELAY_QUEUE_SIZE; i++) {
+        if (relay_queue[i] == 0)
+            continue;
+        container_t *qip = relay_find(relay_queue[i]);
+        if (qip == NULL || OurTime > qip->timestamp + 2) {
+            relay_queue[i] = 0;                        // expired or stale
+            ++relay_stats.dropped;
+            continue;
+        }
+        int score = relay_score(qip);
+        if (best == NULL || score > best_score) {
+            best = qip;
+            best_ndx = i;
+            best_score = score;
+        }
+    }
+    if (best)
+        relay_queue[best_ndx] = 0;
+    return best;
+}
+
+bool Relay_Pending()
+{
+    for (int i=0; i < RELAY_QUEUE_SIZE; i++) {
+        if (relay_queue[i] != 0)
+            return true;
+    }
+    return false;
+}
+
+static bool relay_budget_ok()
+{
+    static uint32_t last_ms = 0;
+    uint32_t now_ms = millis();
+    uint32_t rate = ((settings->band == RF_BAND_US || settings->band == RF_BAND_AU) ?
+                        RELAY_BUDGET_HOP : RELAY_BUDGET_1CH);
+    uint32_t elapsed = now_ms - last_ms;
+    if (elapsed > 10000)
+        elapsed = 10000;
+    relay_budget_us += elapsed * rate;                 // ms * ms/s = us
+    if (relay_budget_us > RELAY_BUDGET_BURST * RELAY_AIR_TIME * 1000)
+        relay_budget_us = RELAY_BUDGET_BURST * RELAY_AIR_TIME * 1000;
+    last_ms = now_ms;
+    return (relay_budget_us >= RELAY_AIR_TIME * 1000);
+}
+
 /* relay landed-out or ADS-B traffic if we are airborne */
 void air_relay(container_t *cip)
 {
     static uint32_t lastrelay = 0;
 
-    bool was_next = (cip == relay_waiting);
-    if (was_next) {
-        relay_waiting = NULL;
-        if (cip->addr == 0)   // expired
-            return;
-if ((settings->debug_flags & DEBUG_DEEPER2)
+    bool was_next = relay_delayed;
+if (was_next
+&& (settings->debug_flags & DEBUG_DEEPER2)
 && (settings->nmea_d || settings->nmea2_d))
-Serial.println("...relay_waiting");
-    }
+Serial.println("...relay from queue");
 
     bool relayed = false;
     bool landed_out = (cip->aircraft_type == AIRCRAFT_TYPE_UNKNOWN
@@ -1307,7 +1649,12 @@ Serial.println("...relay_waiting");
     //if (settings->debug_flags)
     //    Serial.println("Attempting to relay...");
 
-    if (RF_Transmit_Happened() == false         // no transmission yet in this time slot 
+    bool budget_ok = (settings->relay >= RELAY_ONLY || relay_budget_ok());
+    if (! budget_ok)
+        ++relay_stats.suppressed;
+
+    if (budget_ok
+            && RF_Transmit_Happened() == false  // no transmission yet in this time slot 
             && (millis()+20 < TxEndMarker)) {   // enough time left in current time slot
         delay(10);  // give receivers in other aircraft time to process the original packet
         // re-encode packets for relaying (might be in LEGACY, LATEST, ADS-L or OGNTP protocol)
@@ -1333,6 +1680,9 @@ Serial.println("...relay_waiting");
     }
 
     if (relayed) {
+        ++relay_stats.relayed;
+        if (settings->relay < RELAY_ONLY)
+            relay_budget_us -= RELAY_AIR_TIME * 1000;
         if (normal_protocol) {
             cip->timerelayed = cip->timestamp;
             lastrelay = millis();
@@ -1385,16 +1735,10 @@ Serial.println("...relay_waiting");
         // only if it arrives within the next Slot 0, at the moment it arrives.  Both
         // prevent own-ship transmission in the designated time slot.
         if (! was_next && dual_protocol <= RF_FLR_ADSL) {
-            if (relay_waiting) {
-                if (cip->timerelayed <= relay_waiting->timerelayed)
-                    relay_waiting = cip;    // overwrite existing relay_waiting
-            } else {
-                relay_waiting = cip;
-            }
-if (relay_waiting
-&& (settings->debug_flags & DEBUG_DEEPER2)
+            relay_enqueue(cip);
+if ((settings->debug_flags & DEBUG_DEEPER2)
 && (settings->nmea_d || settings->nmea2_d))
-Serial.println("relay_waiting...");
+Serial.println("relay queued...");
         }
         // but if this was the attempt at a delayed relay, don't try again
     }
@@ -1428,6 +1772,7 @@ void CopyTraffic(container_t *cip, ufo_t *fop, const char *callsign)
     cip->relayed = fop->relayed;
 
     cip->rssi = RF_last_rssi;
+    cip->snr  = RF_last_snr;
 
     // if callsign was passed, copy it into Container[]
     if (callsign) {
@@ -1558,6 +1903,7 @@ void AddTraffic(ufo_t *fop, const char *callsign)
         }
 
         CopyTraffic(cip, fop, callsign);
+        track_that(cip);
         Calc_Traffic_Distances(cip);
         // Now can update alarm_level
         Traffic_Update(cip);
@@ -1578,6 +1924,7 @@ void AddTraffic(ufo_t *fop, const char *callsign)
         //*cip = EmptyContainer;
         EmptyContainer(cip);
         CopyTraffic(cip, fop, callsign);
+        track_that(cip);
         Calc_Traffic_Distances(cip);
         Traffic_Update(cip);
         sample_range(cip);
@@ -1594,6 +1941,7 @@ void AddTraffic(ufo_t *fop, const char *callsign)
         //*cip = EmptyContainer;
         EmptyContainer(cip);
         CopyTraffic(cip, fop, callsign);
+        track_that(cip);
         Calc_Traffic_Distances(cip);
         Traffic_Update(cip);
         //sample_range(cip);
@@ -1640,6 +1988,7 @@ void AddTraffic(ufo_t *fop, const char *callsign)
       //*cip = EmptyContainer;
       EmptyContainer(cip);
       CopyTraffic(cip, fop, callsign);
+      track_that(cip);
       Copy_Traffic_Distances(cip);     // computed above by Stash_Traffic_Distances(fop)
       Traffic_Update(cip);
       //sample_range(cip);   - do not sample, aircraft may be closer than max range
@@ -1650,7 +1999,8 @@ void AddTraffic(ufo_t *fop, const char *callsign)
     /* otherwise ignore the new object */
 }
 
-void ParseData(void)
+// copy the received packet into fo_raw, returns false if it is not to be decoded
+static bool ParseData_Prep(void)
 {
     uint8_t rf_protocol = RF_last_protocol;
        // may differ from settings->rf_protocol in dual-protocol mode
@@ -1664,7 +2014,7 @@ Serial.println(which_rx_try);
         StdOut.println(F("$PSRFE,RF loopback is detected"));
       }
       //rx_packets_counter--;
-      return;
+      return false;
     }
 
     memcpy(fo_raw, RxBuffer, rx_size);
@@ -1679,22 +2029,176 @@ Serial.println(which_rx_try);
 
     if (protocol_decode == NULL) {
 //Serial.println("protocol_decode is null");
-        return;
+        return false;
     }
 
+    return true;
+}
+
+// add the decoded object (fo, or core1's copy of it) to the traffic table
+static void ParseData_Finish(ufo_t *fop)
+{
+    if (fop->tx_type == TX_TYPE_NONE)   // not ADS-B or other external sources
+        fop->tx_type = TX_TYPE_FLARM;   // may actually be OGNTP or P3I or FANET...
+
+    if (fop->protocol == RF_PROTOCOL_ADSB_UAT)
+//  ||  fop->protocol == RF_PROTOCOL_ADSB_1090)
+        AddTraffic(fop, fo_callsign);
+    else
+        AddTraffic(fop, (char *) NULL);
+}
+
+void ParseData(void)
+{
+    if (! ParseData_Prep())
+        return;
+
     if (((*protocol_decode)((void *) fo_raw, &ThisAircraft, &fo)) == false)
         return;
 
-    if (fo.tx_type == TX_TYPE_NONE)   // not ADS-B or other external sources
-        fo.tx_type = TX_TYPE_FLARM;   // may actually be OGNTP or P3I or FANET...
+    ParseData_Finish(&fo);
+}
 
-    if (fo.protocol == RF_PROTOCOL_ADSB_UAT)
-//  ||  fo.protocol == RF_PROTOCOL_ADSB_1090)
-        AddTraffic(&fo, fo_callsign);
-    else
-        AddTraffic(&fo, (char *) NULL);
+/*
+ * A packet received by a bridge elsewhere and forwarded over WiFi (see
+ * Bridge_Receive_UDP()): decode it with the decoder for its own protocol,
+ * which may not be the one in use here, as if received now minus age_ms.
+ * The decoders and ParseData_Finish() take the packet metadata from the
+ * RF_last_* globals, so those are set for this packet and then put back,
+ * leaving the local radio's statistics alone.  There is no CRC to go by,
+ * so RF_last_crc is zero, which skips the duplicate check.
+ */
+void ParseData_Bridged(uint8_t protocol, int8_t rssi, uint16_t age_ms,
+                       const uint8_t *payload, size_t size)
+{
+    bool (*decode)(void *, container_t *, ufo_t *);
+
+    switch (protocol)
+    {
+    case RF_PROTOCOL_LEGACY:
+    case RF_PROTOCOL_LATEST:  decode = &legacy_decode;  break;
+    case RF_PROTOCOL_ADSL:    decode = &adsl_decode;    break;
+    case RF_PROTOCOL_OGNTP:   decode = &ogntp_decode;   break;
+    case RF_PROTOCOL_P3I:     decode = &p3i_decode;     break;
+    case RF_PROTOCOL_FANET:   decode = &fanet_decode;   break;
+    default:                  return;
+    }
+
+#if defined(USE_CORE1_DECODE)
+    ParseData_Collect();     // keep the traffic updates in order of reception
+#endif
+
+    uint8_t  saved_protocol = RF_last_protocol;
+    int8_t   saved_rssi     = RF_last_rssi;
+    int8_t   saved_snr      = RF_last_snr;
+    uint32_t saved_rx_ms    = RF_last_rx_ms;
+    uint32_t saved_crc      = RF_last_crc;
+
+    memset(fo_raw, 0, sizeof(fo_raw));
+    memcpy(fo_raw, payload, (size > sizeof(fo_raw) ? sizeof(fo_raw) : size));
+    EmptyFO(&fo);
+    RF_last_protocol = protocol;
+    RF_last_rssi     = rssi;
+    RF_last_snr      = 0;
+    RF_last_rx_ms    = millis() - age_ms;
+    RF_last_crc      = 0;
+
+    if (((*decode)((void *) fo_raw, &ThisAircraft, &fo)) == true)
+        ParseData_Finish(&fo);
+
+    RF_last_protocol = saved_protocol;
+    RF_last_rssi     = saved_rssi;
+    RF_last_snr      = saved_snr;
+    RF_last_rx_ms    = saved_rx_ms;
+    RF_last_crc      = saved_crc;
+}
+
+#if defined(USE_CORE1_DECODE)
+/*
+ * On the RP2040 the decryption and decoding of Latest protocol packets
+ * (the bulk of the received traffic) is done on the second core.
+ * ParseData_Post() decodes the plain-text header on core0, since that
+ * depends on Container[] and on the RF_last_* metadata of the packet,
+ * then hands a copy of the packet over to core1 with everything the rest
+ * of the decoding needs:  the header fields, the position of this
+ * aircraft, and the RSSI and SNR for AddTraffic().  Core1 runs
+ * latest_decode() on that copy only, via ParseData_Worker(), and
+ * ParseData_Collect() waits for it and does the AddTraffic() on core0.
+ * So core1 never sees fo, fo_raw, Container[] or ThisAircraft, and core0
+ * can go on with Traffic_loop(), the NMEA input and so on meanwhile.
+ * Other packets (including old-style V6 packets, whose decoder reports
+ * via NMEA and the flight log) are decoded on core0 as before.
+ */
+#include <hardware/sync.h>
+#define MAILBOX_WAKE()  __sev()     // wake core1 up from __wfe()
+#include "system/Mailbox.h"
+
+static struct {
+    mailbox_t   box;
+    uint8_t     raw[sizeof(fo_raw)];
+    ufo_t       fo;             // header from core0, the rest from core1
+    container_t ownship;        // just the fields latest_decode() reads
+    int8_t      rssi;
+    int8_t      snr;
+    bool        decoded;
+} core1;
+
+void ParseData_Post(void)
+{
+    ParseData_Collect();     // there should be none pending, but just in case
+
+    if (! ParseData_Prep())
+        return;
+
+    legacy_packet_t *pkt = (legacy_packet_t *) fo_raw;
+    if (protocol_decode != &legacy_decode || pkt->msg_type != 2) {
+        if ((*protocol_decode)((void *) fo_raw, &ThisAircraft, &fo))
+            ParseData_Finish(&fo);
+        return;
+    }
+
+    if (! legacy_decode_header((void *) fo_raw, &fo))
+        return;
+
+    memcpy(core1.raw, fo_raw, sizeof(core1.raw));
+    core1.fo                = fo;
+    core1.ownship.latitude  = ThisAircraft.latitude;
+    core1.ownship.longitude = ThisAircraft.longitude;
+    core1.ownship.altitude  = ThisAircraft.altitude;    // these for debug output
+    core1.ownship.speed     = ThisAircraft.speed;
+    core1.ownship.course    = ThisAircraft.course;
+    core1.ownship.turnrate  = ThisAircraft.turnrate;
+    core1.ownship.vs        = ThisAircraft.vs;
+    core1.rssi              = RF_last_rssi;
+    core1.snr               = RF_last_snr;
+    Mailbox_Post(&core1.box);
+}
+
+void ParseData_Collect(void)
+{
+    if (! Mailbox_Collect(&core1.box))
+        return;
+    if (! core1.decoded)
+        return;
+    int8_t rssi = RF_last_rssi;
+    int8_t snr  = RF_last_snr;
+    RF_last_rssi = core1.rssi;          // CopyTraffic() takes them from there
+    RF_last_snr  = core1.snr;
+    ParseData_Finish(&core1.fo);
+    RF_last_rssi = rssi;
+    RF_last_snr  = snr;
 }
 
+/* called from loop1() on core1 */
+void ParseData_Worker(void)
+{
+    if (! Mailbox_Take(&core1.box))
+        return;
+    core1.decoded = latest_decode((void *) core1.raw, &core1.ownship, &core1.fo);
+    Mailbox_Done(&core1.box);
+}
+#endif /* USE_CORE1_DECODE */
+
 void Traffic_setup()
 {
   switch (settings->alarm)
@@ -1715,6 +2219,7 @@ void Traffic_setup()
   }
 
   load_range_stats();
+  load_coverage();
 
 #if defined(USE_SD_CARD)
     if (settings->rx1090
@@ -1728,9 +2233,15 @@ void Traffic_loop()
 {
     // if could not relay ADS-B when it was received, because
     // was between slot 1 & slot 0, or transmission already happened,
-    // then it was marked for relay at next slot 1
-    if (relay_waiting != NULL && RF_current_slot == 1 && RF_Transmit_Ready(true))
-        air_relay(relay_waiting);
+    // then it was queued for relay at next slot 1
+    if (RF_current_slot == 1 && RF_Transmit_Ready(true)) {
+        container_t *cip = relay_dequeue();
+        if (cip) {
+            relay_delayed = true;
+            air_relay(cip);
+            relay_delayed = false;
+        }
+    }
 
     if (! isTimeToUpdateTraffic())
         return;
@@ -1823,13 +2334,7 @@ if (fop->protocol == RF_PROTOCOL_ADSB_1090 && (settings->debug_flags & DEBUG_DEE
 
     if (sound_alarm_level > ALARM_LEVEL_CLOSE) {   // implies mfop != NULL
       // use alarmcount to modify the sounds
-      bool notified = Buzzer_Notify(sound_alarm_level, (alarmcount > 1));
-#if !defined(EXCLUDE_VOICE)
-#if defined(ESP32)
-      //if (mfop != NULL)
-        notified |= Voice_Notify(mfop, (alarmcount > 1));
-#endif
-#endif
+      bool notified = Annunciate(sound_alarm_level, (alarmcount > 1), mfop);
 
       /* Doing this here means that alarms via $PSRAA follow the same
        * hysteresis algorithm as the sound alarms.
@@ -82,6 +82,12 @@ enum
 void air_relay(container_t *fop);
 void AddTraffic(ufo_t *fop, const char *callsign);
 void ParseData(void);
+void ParseData_Bridged(uint8_t, int8_t, uint16_t, const uint8_t *, size_t);
+#if defined(USE_CORE1_DECODE)
+void ParseData_Post(void);
+void ParseData_Collect(void);
+void ParseData_Worker(void);
+#endif
 void Traffic_setup(void);
 void Traffic_loop(void);
 void ClearExpired(void);
@@ -93,6 +99,21 @@ int  traffic_cmp_by_distance(const void *, const void *);
 float Adj_alt_diff(container_t *, container_t *);
 void generate_random_id(void);
 void save_range_stats(void);
+void Coverage_save(void);
+
+/* long-term coverage database, see sample_range() */
+enum { COV_FLARM, COV_ADSL, COV_OGNTP, COV_FANET, COV_ADSB, COV_PROTOCOLS };
+#define COV_BANDS     4     /* relative altitude < -300, < 0, < 300, above */
+#define COV_SECTORS  12     /* 30-degree sectors, relative to our heading */
+#define COV_CELLS    (COV_PROTOCOLS * COV_BANDS * COV_SECTORS)
+
+typedef struct cov_cell_struct {
+    uint16_t  n;            /* samples, saturating */
+    uint16_t  range;        /* 64 * 32 * log2(km) */
+    int16_t   rssi;         /* 64 * dBm */
+} cov_cell_t;
+
+extern cov_cell_t coverage[COV_PROTOCOLS][COV_BANDS][COV_SECTORS];
 
 void EmptyContainer(container_t *p);
 void EmptyFO(ufo_t *p);
@@ -112,7 +133,15 @@ extern int max_alarm_level;
 extern bool alarm_ahead;
 extern bool relay_next;
 extern bool alt_relay_next;
-extern container_t *relay_waiting;
+
+typedef struct relay_stats_struct {
+    uint32_t relayed;
+    uint32_t suppressed;    /* over the airtime budget */
+    uint32_t dropped;       /* pushed out of the queue, or went stale in it */
+} relay_stats_t;
+
+extern relay_stats_t relay_stats;
+bool Relay_Pending(void);
 extern float average_baro_alt_diff;
 extern uint8_t adsb_acfts;
 extern int8_t maxrssi;
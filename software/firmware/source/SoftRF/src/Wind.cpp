@@ -1189,8 +1189,12 @@ To compute the correct air-reference circling path:
     /* rely on history to compute turn rate */
 
     /* if no usable history, assume a straight path */
+    /* - a LOW quality fit may be from 3 reports within a second, or noisy, */
+    /*   so only a GOOD one replaces the two-point turn rate, as in that_vs() */
 
-    if (fop->gnsstime_ms - fop->prevtime_ms > 3000) {
+    bool fitted = (fop->history.quality == HISTORY_QUALITY_GOOD);
+
+    if (fop->gnsstime_ms - fop->prevtime_ms > 3000 && ! fitted) {
 
       fop->turnrate = 0.0;
       fop->heading = fop->course;   // not exact, but only used in $PSALL reporting
@@ -1228,17 +1232,23 @@ To compute the correct air-reference circling path:
     }
 
     /* have history - compute turn rate - degrees per second */
-    /* uses current and previous course and time_ms */
+    /* uses the fit over the recent reports, see track_that(), */
+    /* or else the current and previous course and time_ms     */
 
-    gspeed = fop->speed * (4.0 * _GPS_MPS_PER_KNOT);   // ground speed - quarter-meters per sec
-    course = fop->course;
+    if (fitted) {
+        gspeed = fop->history.speed * (4.0 * _GPS_MPS_PER_KNOT);
+        course = fop->history.course;
+    } else {
+        gspeed = fop->speed * (4.0 * _GPS_MPS_PER_KNOT);   // ground speed - quarter-meters per sec
+        course = fop->course;
+    }
 
     /* previous heading from past course and speed and wind */
     float prevheading = fop->prevheading;
 
     /* same for current time point */
-    float nsf = gspeed * cos(D2R * fop->course);
-    float ewf = gspeed * sin(D2R * fop->course);
+    float nsf = gspeed * cos(D2R * course);
+    float ewf = gspeed * sin(D2R * course);
     as_ns = nsf - (4.0 * wind_best_ns);
     as_ew = ewf - (4.0 * wind_best_ew);
     heading = R2D * atan2(as_ew, as_ns);
@@ -1250,22 +1260,40 @@ To compute the correct air-reference circling path:
     aspeed = hypot(as_ns, as_ew);      // air speed - quarter-mps
 
     /* turn rate in the air reference frame (drifting with the wind) */
-    float heading_change = heading - prevheading;
-
-    if (fabs(heading_change) > 270.0) {
-      /* roll-over through 360 */
-      if (heading > 270.0)  heading_change -= 360.0;
-      else heading_change += 360.0;
-    }
+    float heading_change = 0;
     uint32_t interval = 0;
-    if (fop->gnsstime_ms > fop->prevtime_ms) {
-        interval = fop->gnsstime_ms - fop->prevtime_ms;
-        fop->projtime_ms = fop->gnsstime_ms - (interval >> 1);  /* midway between the 2 time points */
+
+    if (fitted) {
+
+      /* fitted ground-ref turn rate, converted as for Legacy packets above */
+      /* - the heading is already as of the latest report */
+      aturnrate = fop->history.turnrate;
+      windangle = course - wind_direction;
+      if (windangle > 0)  windangle -= 180.0;         /* angle from DOWNwind */
+      else                windangle += 180.0;
+      if (wind_speed > 1.0 && aspeed > 4.0)
+          aturnrate *= (1.0 + cos(D2R * windangle) * 4.0 * wind_speed / aspeed);
+
+    } else {
+
+      heading_change = heading - prevheading;
+      if (fabs(heading_change) > 270.0) {
+        /* roll-over through 360 */
+        if (heading > 270.0)  heading_change -= 360.0;
+        else heading_change += 360.0;
+      }
+      if (fop->gnsstime_ms > fop->prevtime_ms) {
+          interval = fop->gnsstime_ms - fop->prevtime_ms;
+          fop->projtime_ms = fop->gnsstime_ms - (interval >> 1);  /* midway between the 2 time points */
+      }
+      aturnrate = heading_change / (0.001f * (float) interval);
     }
-    aturnrate = heading_change / (0.001f * (float) interval);
+
     if (fabs(aturnrate) > 50.0)  aturnrate = 0.0;        /* ignore implausible data */
     if (fabs(aturnrate) <  2.0)  aturnrate = 0.0;        /* ignore inaccurate data */
-    if (interval < 1400 && fop->turnrate != 0) {
+    if (fitted) {
+       fop->turnrate = aturnrate;   // already smoothed
+    } else if (interval < 1400 && fop->turnrate != 0) {
        /* short interval between packets, average with previously known turn rate */
        fop->turnrate = 0.5f * (aturnrate + fop->turnrate);
     } else {
@@ -1294,7 +1322,7 @@ To compute the correct air-reference circling path:
         fop->fla_ew[i] = ew;
       }
 
-      if (report) report_that_projection(fop, 3);
+      if (report) report_that_projection(fop, fitted ? 5 : 3);
 
       return;
     }
@@ -1340,7 +1368,7 @@ To compute the correct air-reference circling path:
         }
     }
 
-    if (report) report_that_projection(fop, 4);
+    if (report) report_that_projection(fop, fitted ? 6 : 4);
 }
 
 
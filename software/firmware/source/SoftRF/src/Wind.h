@@ -27,6 +27,8 @@ extern float wind_direction;
 void this_airborne(bool validfix);
 void project_this(container_t *);
 void project_that(container_t *);
+void track_that(container_t *);
+float that_vs(container_t *);
 void Estimate_Wind(void);
 float Estimate_Climbrate(void);
 
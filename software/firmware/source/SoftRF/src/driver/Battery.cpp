@@ -23,12 +23,33 @@
 #include "../system/SoC.h"
 #include "Settings.h"
 #include "Battery.h"
+#include "../protocol/radio/Legacy.h"
+
+/* from TrafficHelper - its header does not build on every platform */
+extern int max_alarm_level;
+int Traffic_Count(void);
 
 unsigned long Battery_TimeMarker        = 0;
 
 static float Battery_voltage_cache      = 0;
 static int Battery_cutoff_count         = 0;
 
+/*
+ * The settings for each profile.  GNSS is left at its 1 Hz rate in all of
+ * them, since the PPS and fix rate set the radio time slots.  The currents
+ * are nominal figures for a T-Beam class device, not measurements.
+ */
+static const power_profile_t power_profiles[POWER_PROFILE_COUNT] = {
+  /* GROUND */  { 2000, 64,  false, 100 },
+  /* SPARSE */  {  500, 160, true,  118 },
+  /* DENSE  */  {  500, 255, true,  120 },
+  /* LOWBAT */  { 2000, 32,  false,  95 },
+};
+
+uint8_t  power_profile = POWER_PROFILE_SPARSE;
+uint32_t power_profile_secs[POWER_PROFILE_COUNT];
+static float Power_mAh_used = 0;
+
 void Battery_setup()
 {
   SoC->Battery_setup();
@@ -94,6 +115,70 @@ static bool follow_ext_power_shutoff(float voltage)
     return true;
 }
 
+static bool Power_governed()
+{
+  return ((settings->power_save & POWER_SAVE_GOVERNOR) != 0);
+}
+
+uint16_t Power_OLED_interval()
+{
+  return (Power_governed() ? power_profiles[power_profile].oled_ms : 500);
+}
+
+uint8_t Power_LED_level()
+{
+  return (Power_governed() ? power_profiles[power_profile].led_level : 255);
+}
+
+bool Power_alt_rx()
+{
+  return (Power_governed() ? power_profiles[power_profile].alt_rx : true);
+}
+
+float Power_mAh()
+{
+  return Power_mAh_used;
+}
+
+/*
+ * Pick the profile from battery state, flight state and traffic density.
+ * Low battery overrides the rest, and both it and the dense profile have
+ * some hysteresis so that the display and LEDs do not flicker between them.
+ * Called every 5 seconds from Battery_loop(), which also charges the
+ * elapsed time to the energy estimate.
+ */
+static void Power_evaluate(float voltage, uint32_t elapsed_ms)
+{
+  uint8_t profile = power_profile;
+
+  if (voltage > BATTERY_THRESHOLD_INVALID
+      && (voltage < Battery_threshold()
+          || (profile == POWER_PROFILE_LOWBAT
+              && voltage < Battery_threshold() + POWER_LOWBAT_HYST))) {
+      profile = POWER_PROFILE_LOWBAT;
+  } else if (! ThisAircraft.airborne) {
+      profile = POWER_PROFILE_GROUND;
+  } else {
+      int nacft = Traffic_Count();
+      if (max_alarm_level > ALARM_LEVEL_NONE || nacft >= POWER_DENSE_ENTER)
+          profile = POWER_PROFILE_DENSE;
+      else if (profile != POWER_PROFILE_DENSE || nacft < POWER_DENSE_LEAVE)
+          profile = POWER_PROFILE_SPARSE;
+  }
+
+  uint16_t ma = (Power_governed() ? power_profiles[power_profile].est_ma : POWER_FULL_MA);
+  Power_mAh_used += (float) ma * (float) elapsed_ms / 3600000.0;
+  power_profile_secs[power_profile] += elapsed_ms / 1000;
+
+  if (profile != power_profile) {
+      Serial.print(F("Power profile "));
+      Serial.print(power_profile);
+      Serial.print(F(" -> "));
+      Serial.println(profile);
+      power_profile = profile;
+  }
+}
+
 void Battery_loop()
 {
   if (isTimeToBattery()) {
@@ -115,6 +200,7 @@ void Battery_loop()
     }
 
     Battery_voltage_cache = voltage;
+    Power_evaluate(voltage, millis() - Battery_TimeMarker);
     Battery_TimeMarker = millis();
   }
 }
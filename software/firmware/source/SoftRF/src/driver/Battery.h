@@ -43,9 +43,32 @@ enum
 	POWER_SAVE_NONE      = 0,
 	POWER_SAVE_WIFI      = 1,
 	POWER_SAVE_GNSS      = 2,
-	POWER_SAVE_NORECEIVE = 4
+	POWER_SAVE_NORECEIVE = 4,
+	POWER_SAVE_GOVERNOR  = 8
 };
 
+/* operating profiles chosen by the power governor, see Power_evaluate() */
+enum
+{
+	POWER_PROFILE_GROUND,
+	POWER_PROFILE_SPARSE,
+	POWER_PROFILE_DENSE,
+	POWER_PROFILE_LOWBAT,
+	POWER_PROFILE_COUNT
+};
+
+typedef struct power_profile_struct {
+    uint16_t oled_ms;     /* OLED refresh interval */
+    uint8_t  led_level;   /* LED ring brightness, 255 = full */
+    bool     alt_rx;      /* receive in time slots of the alt protocol */
+    uint16_t est_ma;      /* nominal current draw, for the energy estimate */
+} power_profile_t;
+
+#define POWER_DENSE_ENTER      4     /* aircraft tracked to enter DENSE */
+#define POWER_DENSE_LEAVE      2     /* ... and fewer than this to leave it */
+#define POWER_LOWBAT_HYST      0.1   /* volts above threshold to leave LOWBAT */
+#define POWER_FULL_MA          120   /* nominal draw when not governed */
+
 enum
 {
 	BATTERY_PARAM_VOLTAGE,
@@ -69,6 +92,13 @@ float   Battery_threshold(void);
 float   Battery_cutoff(void);
 uint8_t Battery_charge(void);
 
+uint16_t Power_OLED_interval(void);
+uint8_t  Power_LED_level(void);
+bool     Power_alt_rx(void);
+float    Power_mAh(void);
+
 extern unsigned long Battery_TimeMarker;
+extern uint8_t power_profile;
+extern uint32_t power_profile_secs[POWER_PROFILE_COUNT];
 
 #endif /* BATTERYHELPER_H */
@@ -54,6 +54,7 @@ bool BTactive = false;
 
 #include "WiFi.h"   // HOSTNAME
 #include "Battery.h"
+#include "../protocol/data/NMEA.h"
 
 #include <core_version.h>
 
@@ -75,7 +76,21 @@ bool oldDeviceConnected = false;
 BLECharacteristic* pMIDICharacteristic = NULL;
 #endif /* USE_BLE_MIDI */
 
-cbuf *BLE_FIFO_RX, *BLE_FIFO_TX;
+cbuf *BLE_FIFO_RX;
+
+/* whole-sentence output queues, one per priority class */
+static cbuf *BLEQ[BLEQ_CLASSES];
+static const size_t BLEQ_size[BLEQ_CLASSES] =
+  { BLEQ_ALARM_SIZE, BLEQ_TRAFFIC_SIZE, BLEQ_GNSS_SIZE, BLEQ_OTHER_SIZE };
+static const size_t BLEQ_limit[BLEQ_CLASSES] =
+  { BLEQ_ALARM_SIZE, BLEQ_TRAFFIC_LIMIT, BLEQ_GNSS_LIMIT, BLEQ_OTHER_LIMIT };
+
+static char   BLEQ_line[NMEA_BUFFER_SIZE];   /* sentence being assembled */
+static size_t BLEQ_line_len = 0;
+static int    BLEQ_cur = BLEQ_OTHER;         /* class of sentence being sent */
+static size_t BLEQ_remain = 0;               /* bytes left of that sentence */
+
+bleq_stats_t BLE_queue_stats;
 
 #if !defined(CONFIG_IDF_TARGET_ESP32S3)
 BluetoothSerial SerialBT;
@@ -113,6 +128,104 @@ class UARTCallbacks: public BLECharacteristicCallbacks {
     }
 };
 
+/*
+ * Decide the priority class of a complete output sentence
+ */
+static int BLEQ_class(const char *line, size_t len)
+{
+  if (len < 6 || line[0] != '$')
+      return BLEQ_OTHER;
+  if (strncmp(line, "$PFLAU", 6) == 0 || strncmp(line, "$PSRAA", 6) == 0)
+      return BLEQ_ALARM;
+  if (strncmp(line, "$PFLAA", 6) == 0) {
+      /* $PFLAA,<AlarmLevel>,... */
+      if (len > 7 && line[7] > '0' && line[7] <= '3')
+          return BLEQ_ALARM;
+      return BLEQ_TRAFFIC;
+  }
+  if (line[1] == 'G' || strncmp(line, "$PGRMZ", 6) == 0
+                     || strncmp(line, "$LK8EX", 6) == 0)
+      return BLEQ_GNSS;
+  return BLEQ_OTHER;
+}
+
+static size_t BLEQ_backlog()
+{
+  size_t total = BLEQ_remain;
+  for (int c=0; c < BLEQ_CLASSES; c++)
+      total += BLEQ[c]->available();
+  return total;
+}
+
+/*
+ * Queue one complete sentence, or drop it whole if the link is congested.
+ * An alarm that does not fit first discards queued low-priority sentences.
+ */
+static void BLEQ_enqueue(const char *line, size_t len)
+{
+  int c = BLEQ_class(line, len);
+
+  if (c == BLEQ_ALARM && BLEQ_backlog() + len + 1 > BLEQ_TRAFFIC_LIMIT) {
+      for (int d = BLEQ_OTHER; d > BLEQ_ALARM; d--) {
+          if (d == BLEQ_cur && BLEQ_remain > 0)
+              continue;    /* do not cut the sentence now on the air */
+          while (BLEQ[d]->available() > 0) {
+              size_t n = (uint8_t) BLEQ[d]->read();
+              while (n-- > 0)  BLEQ[d]->read();
+              ++BLE_queue_stats.dropped[d];
+          }
+          if (BLEQ_backlog() + len + 1 <= BLEQ_TRAFFIC_LIMIT)
+              break;
+      }
+  }
+
+  if (BLEQ[c]->room() < len + 1 ||
+      (c != BLEQ_ALARM && BLEQ_backlog() + len + 1 > BLEQ_limit[c])) {
+      ++BLE_queue_stats.dropped[c];
+      return;
+  }
+
+  BLEQ[c]->write((char) len);
+  BLEQ[c]->write(line, len);
+  ++BLE_queue_stats.queued[c];
+}
+
+/*
+ * Fill one BLE notification from the queues, highest priority first.
+ * A sentence, once started, is always completed before switching class.
+ */
+static size_t BLEQ_fill_chunk(uint8_t *chunk)
+{
+  size_t size = 0;
+
+  while (size < BLE_MAX_WRITE_CHUNK_SIZE) {
+      if (BLEQ_remain == 0) {
+          int c;
+          for (c=0; c < BLEQ_CLASSES; c++) {
+              if (BLEQ[c]->available() > 0)
+                  break;
+          }
+          if (c == BLEQ_CLASSES)
+              break;
+          BLEQ_cur = c;
+          BLEQ_remain = (uint8_t) BLEQ[c]->read();
+          ++BLE_queue_stats.sent[c];
+      }
+      size_t n = BLE_MAX_WRITE_CHUNK_SIZE - size;
+      if (n > BLEQ_remain)
+          n = BLEQ_remain;
+      n = BLEQ[BLEQ_cur]->read((char *) chunk + size, n);
+      if (n == 0) {      /* should not happen */
+          BLEQ_remain = 0;
+          break;
+      }
+      size += n;
+      BLEQ_remain -= n;
+  }
+
+  return size;
+}
+
 static void ESP32_Bluetooth_setup()
 {
   if (settings->myssid[0] != '\0') {
@@ -139,7 +252,8 @@ static void ESP32_Bluetooth_setup()
   case BLUETOOTH_LE_HM10_SERIAL:
     {
       BLE_FIFO_RX = new cbuf(BLE_FIFO_RX_SIZE);
-      BLE_FIFO_TX = new cbuf(BLE_FIFO_TX_SIZE);
+      for (int c=0; c < BLEQ_CLASSES; c++)
+          BLEQ[c] = new cbuf(BLEQ_size[c]);
 
 #if !defined(CONFIG_IDF_TARGET_ESP32S3)
       esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
@@ -313,11 +427,9 @@ static void ESP32_Bluetooth_loop()
       if (deviceConnected && (millis() - BLE_Notify_TimeMarker > 10)) { /* < 18000 baud */
 
           static uint8_t chunk[BLE_MAX_WRITE_CHUNK_SIZE];   // >>> MB added "static"
-          size_t size = BLE_FIFO_TX->available();
-          size = size < BLE_MAX_WRITE_CHUNK_SIZE ? size : BLE_MAX_WRITE_CHUNK_SIZE;
+          size_t size = BLEQ_fill_chunk(chunk);
 
           if (size > 0) {
-            BLE_FIFO_TX->read((char *) chunk, size);
 
             pUARTCharacteristic->setValue(chunk, size);
             pUARTCharacteristic->notify();
@@ -432,8 +544,20 @@ static size_t ESP32_Bluetooth_write(const uint8_t *buffer, size_t size)
     break;
 #endif /* CONFIG_IDF_TARGET_ESP32S3 */
   case BLUETOOTH_LE_HM10_SERIAL:
-    rval = BLE_FIFO_TX->write((char *) buffer,
-                        (BLE_FIFO_TX->room() > size ? size : BLE_FIFO_TX->room()));
+    /* NMEA_Out() may send a sentence and its CR-LF in separate calls */
+    for (size_t i=0; i < size; i++) {
+      char c = (char) buffer[i];
+      if (BLEQ_line_len < sizeof(BLEQ_line)) {
+        BLEQ_line[BLEQ_line_len++] = c;
+        if (c == '\n') {
+          BLEQ_enqueue(BLEQ_line, BLEQ_line_len);
+          BLEQ_line_len = 0;
+        }
+      } else if (c == '\n') {
+        ++BLE_queue_stats.dropped[BLEQ_OTHER];   /* overlong line */
+        BLEQ_line_len = 0;
+      }
+    }
     break;
   case BLUETOOTH_OFF:
   case BLUETOOTH_A2DP_SOURCE:
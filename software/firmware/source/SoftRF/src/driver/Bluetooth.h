@@ -60,12 +60,43 @@ extern bool BTactive;
 #define GPS2_CHARACTERISTIC_UUID        "aba27100-143b-4b81-a444-edcd0000f024"
 #define SYSTEM_CHARACTERISTIC_UUID      "aba27100-143b-4b81-a444-edcd0000f025"
 
-/* (FLAA x MAX_TRACKING_OBJECTS + GNGGA + GNRMC + FLAU) x 80 symbols */
-#define BLE_FIFO_TX_SIZE          1024
 #define BLE_FIFO_RX_SIZE          256
 
 #define BLE_MAX_WRITE_CHUNK_SIZE  20
 
+/*
+ * BLE output is queued as whole sentences, by priority class.
+ * When the link is congested lower-priority sentences are dropped
+ * whole, instead of being truncated mid-line.
+ */
+enum
+{
+	BLEQ_ALARM,     /* $PFLAU, $PSRAA, $PFLAA with alarm level > 0 */
+	BLEQ_TRAFFIC,   /* other $PFLAA */
+	BLEQ_GNSS,      /* $GPxxx, $GNxxx, $PGRMZ, $LK8EX1 */
+	BLEQ_OTHER,     /* debug and everything else */
+	BLEQ_CLASSES
+};
+
+/* FIFO sizes per class, each sentence is stored after a length byte */
+#define BLEQ_ALARM_SIZE           256
+#define BLEQ_TRAFFIC_SIZE         768
+#define BLEQ_GNSS_SIZE            384
+#define BLEQ_OTHER_SIZE           256
+
+/* total backlog (bytes) above which a class is no longer queued */
+#define BLEQ_TRAFFIC_LIMIT        1024
+#define BLEQ_GNSS_LIMIT           512
+#define BLEQ_OTHER_LIMIT          256
+
+typedef struct bleq_stats_struct {
+  uint32_t queued[BLEQ_CLASSES];
+  uint32_t sent[BLEQ_CLASSES];
+  uint32_t dropped[BLEQ_CLASSES];
+} bleq_stats_t;
+
+extern bleq_stats_t BLE_queue_stats;
+
 extern IODev_ops_t ESP32_Bluetooth_ops;
 
 #if defined(ENABLE_BT_VOICE)
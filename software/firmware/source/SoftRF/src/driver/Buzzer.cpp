@@ -20,14 +20,14 @@
 
 #if defined(EXCLUDE_BUZZER)
 void  Buzzer_setup()       {}
-bool  Buzzer_Notify(int8_t level, bool multi_alarm) {return false;}
+uint32_t Buzzer_Notify(int8_t level, bool multi_alarm) {return 0;}
 void  Buzzer_loop()        {}
 void  Buzzer_fini()        {}
 #else
 
 #if !defined(ESP32)
 void  Buzzer_setup()       {}
-bool  Buzzer_Notify(int8_t level, bool multi_alarm) {return false;}
+uint32_t Buzzer_Notify(int8_t level, bool multi_alarm) {return 0;}
 void  Buzzer_loop()        {}
 void  Buzzer_fini()        {}
 #else
@@ -43,13 +43,19 @@ void  Buzzer_fini()        {}
 
 #include "../protocol/data/NMEA.h"
 
-static uint32_t BuzzerTimeMarker = 0;
-static uint8_t BuzzerBeeps = 0;     /* how many beeps to go */
-static uint8_t BuzzerBeep  = 0;     /* how many beeps done */
-static uint8_t BuzzerState = 0;     /* 1 = buzzing */
-static bool double_beep = false;
+/*
+ * A beep pattern is a list of alternating on and off times, starting with
+ * "on".  Buzzer_loop() steps through it, each step timed from the end of
+ * the previous one so that the pattern does not stretch if the main loop
+ * is slow.
+ */
+#define BUZZER_MAX_STEPS  16
+static uint16_t BuzzerSteps[BUZZER_MAX_STEPS];
+static uint8_t BuzzerNumSteps = 0;
+static uint8_t BuzzerStep  = 0;     /* even = buzzing */
+static uint32_t BuzzerTimeMarker = 0;   /* end of current step, 0 if idle */
+static uint32_t BuzzerDemoMarker = 0;
 static uint16_t BuzzerToneHz = 0;    /* variable tone */
-static uint16_t BuzzerBeepMS = 0;    /* how long each beep */
 
 #include <toneAC.h>
 
@@ -71,6 +77,34 @@ Serial.println(millis());
 
 static int volume = 10;
 
+static void buzzer_on()
+{
+  if (settings->volume == BUZZER_EXT) {
+    ext_buzzer(true);
+  } else {
+    int duration = 0;           // forever, until turned off
+    bool background = true;    // return to main thread while sounding tone
+    toneAC(BuzzerToneHz, volume, duration, background);
+  }
+}
+
+static void buzzer_off()
+{
+  if (settings->volume == BUZZER_EXT)
+    ext_buzzer(false);
+  else
+    noToneAC();
+}
+
+static void buzzer_start()
+{
+  BuzzerStep = 0;
+  buzzer_on();
+  BuzzerTimeMarker = millis() + BuzzerSteps[0];
+  if (BuzzerTimeMarker == 0)
+      BuzzerTimeMarker = 1;
+}
+
 void Buzzer_setup(void)
 {
   if (settings->volume == BUZZER_OFF)
@@ -99,19 +133,17 @@ void Buzzer_setup(void)
       }
   }
 
+  BuzzerTimeMarker = 0;
+  BuzzerDemoMarker = 0;
+
   if (settings->volume == BUZZER_EXT) {
       pinMode(buzzer1pin, OUTPUT);
-      ext_buzzer(true);   // sound buzzer briefly for self-test
-      delay(80);
-      ext_buzzer(false);
-      delay(40);
-      ext_buzzer(true);
-      delay(80);
-      ext_buzzer(false);
-//      delay(100);
-//      ext_buzzer(true);
-//      delay(200);
-//      ext_buzzer(false);
+      // sound buzzer briefly for self-test, Buzzer_loop() completes it
+      BuzzerSteps[0] = 80;
+      BuzzerSteps[1] = 40;
+      BuzzerSteps[2] = 80;
+      BuzzerNumSteps = 3;
+      buzzer_start();
   } else {
       if (ESP32_pin_reserved(buzzer2pin, false, "Buzzer")) {
           settings->volume = BUZZER_OFF;
@@ -120,72 +152,77 @@ void Buzzer_setup(void)
       toneAC_setup(buzzer2pin, buzzer1pin);
       volume = (settings->volume == BUZZER_VOLUME_LOW ? 8 : 10);
   }
-  BuzzerToneHz = 0;
-  BuzzerBeepMS = 0;
-  BuzzerBeeps = 0;
-  BuzzerState = 0;
-  BuzzerTimeMarker = 0;
-  double_beep = false;
 }
 
-bool Buzzer_Notify(int8_t alarm_level, bool multi_alarm)
+/*
+ * Starts the beep pattern for the given alarm level, replacing any pattern
+ * in progress - it is up to the caller (Annunciate() in TrafficHelper.cpp)
+ * to decide whether the new alarm should pre-empt the current one.
+ * Returns the duration of the pattern in ms, 0 if nothing is sounded.
+ */
+uint32_t Buzzer_Notify(int8_t alarm_level, bool multi_alarm)
 {
   if (settings->volume == BUZZER_OFF)
-      return false;
-
-  if (BuzzerTimeMarker != 0)   // beeping in progress
-      return false;
+      return 0;
 
   /* if more than one alarm aircraft, emit double-beeps */
 
-  double_beep = false;
+  uint16_t beep_ms;
+  int beeps;
+  bool double_beep = false;
   if (alarm_level == ALARM_LEVEL_LOW) {
     BuzzerToneHz = ALARM_TONE_HZ_LOW;
     if (multi_alarm) {
-        BuzzerBeepMS = ALARM_TONE_MS_LOW / 2;
-        BuzzerBeeps  = ALARM_BEEPS_LOW * 2;
+        beep_ms = ALARM_TONE_MS_LOW / 2;
+        beeps  = ALARM_BEEPS_LOW * 2;
         double_beep = true;
     } else {
-        BuzzerBeepMS = ALARM_TONE_MS_LOW;
-        BuzzerBeeps  = ALARM_BEEPS_LOW;
+        beep_ms = ALARM_TONE_MS_LOW;
+        beeps  = ALARM_BEEPS_LOW;
     }
   } else if (alarm_level == ALARM_LEVEL_IMPORTANT) {
     BuzzerToneHz = ALARM_TONE_HZ_IMPORTANT;
     if (multi_alarm) {
-        BuzzerBeepMS = ALARM_TONE_MS_IMPORTANT / 2;
-        BuzzerBeeps  = ALARM_BEEPS_IMPORTANT * 2;
+        beep_ms = ALARM_TONE_MS_IMPORTANT / 2;
+        beeps  = ALARM_BEEPS_IMPORTANT * 2;
         double_beep = true;
     } else {
-        BuzzerBeepMS = ALARM_TONE_MS_IMPORTANT;
-        BuzzerBeeps  = ALARM_BEEPS_IMPORTANT;
+        beep_ms = ALARM_TONE_MS_IMPORTANT;
+        beeps  = ALARM_BEEPS_IMPORTANT;
     }
   } else if (alarm_level == ALARM_LEVEL_URGENT) {
     BuzzerToneHz = ALARM_TONE_HZ_URGENT;
-    BuzzerBeepMS = ALARM_TONE_MS_URGENT;
+    beep_ms = ALARM_TONE_MS_URGENT;
     if (multi_alarm)
-        BuzzerBeeps  = ALARM_BEEPS_URGENT + 2;
+        beeps  = ALARM_BEEPS_URGENT + 2;
     else
-        BuzzerBeeps  = ALARM_BEEPS_URGENT;
+        beeps  = ALARM_BEEPS_URGENT;
   } else {    /* whether NONE or CLOSE */
-    return false;
+    return 0;
   }
 
-  BuzzerBeep = 1;  // starting the first beep
-
-  if (settings->volume == BUZZER_EXT) {
-    ext_buzzer(true);
-  } else {
-    int duration = 0;           // forever, until turned off
-    bool background = true;    // return to main thread while sounding tone
-    toneAC(BuzzerToneHz, volume, duration, background);
+  uint32_t total = 0;
+  BuzzerNumSteps = 0;
+  for (int beep=1; beep <= beeps && BuzzerNumSteps < BUZZER_MAX_STEPS; beep++) {
+    if (beep > 1) {
+      uint16_t gap;
+      if (double_beep && (beep & 1) == 0)
+          gap = ALARM_MULTI_GAP_MS;   /* short break making it a double-beep */
+      else
+          gap = beep_ms;              /* gap is same length as the beep */
+      BuzzerSteps[BuzzerNumSteps++] = gap;
+      total += gap;
+    }
+    BuzzerSteps[BuzzerNumSteps++] = beep_ms;
+    total += beep_ms;
   }
-  BuzzerState = 1;
-  BuzzerTimeMarker = millis() + BuzzerBeepMS;
+
+  buzzer_start();
 //if (settings->debug_flags & 0x80) {
 //snprintf_P(NMEABuffer, sizeof(NMEABuffer),"alarm level %d buzzer turned on at %d ms\r\n", alarm_level, millis());
 //NMEAOutD();
 //}
-  return true;
+  return total;
 }
 
 void Buzzer_loop(void)
@@ -193,60 +230,36 @@ void Buzzer_loop(void)
   if (settings->volume == BUZZER_OFF)
       return;
 
-  if (BuzzerTimeMarker != 0 && millis() > BuzzerTimeMarker) {
-
-    if (BuzzerBeeps > 1) {
-
-      if (BuzzerState == 1) {   /* a beep is ending */
-        if (settings->volume == BUZZER_EXT)
-          ext_buzzer(false);
-        else
-          noToneAC();
-        BuzzerState = 0;
-        uint32_t gap;
-        if (double_beep && (BuzzerBeep & 1))
-            gap = ALARM_MULTI_GAP_MS;   /* short break making it a double-beep */
-        else
-            gap = BuzzerBeepMS;         /* gap is same length as the beep */
-        BuzzerTimeMarker = millis() + gap;           /* time of next beep */
-//if (settings->debug_flags & 0x80) {
-//snprintf_P(NMEABuffer, sizeof(NMEABuffer),"... buzzer turned off at %d ms\r\n", millis());
-//NMEAOutD();
-//}
-      } else {  /* sound is off, start another beep */
-        if (settings->volume == BUZZER_EXT)
-          ext_buzzer(true);
-        else
-          toneAC(BuzzerToneHz, volume, 0, true);
-        BuzzerState = 1;
-        --BuzzerBeeps;
-        ++BuzzerBeep;
-        BuzzerTimeMarker = millis() + BuzzerBeepMS;  /* timer of next gap */
-//if (settings->debug_flags & 0x80) {
-//snprintf_P(NMEABuffer, sizeof(NMEABuffer),"... buzzer turned on  at %d ms\r\n", millis());
-//NMEAOutD();
-//}
-      }
+  if (BuzzerTimeMarker != 0) {
 
-    } else {   /* done beeping, turn it all off */
+    if ((int32_t)(millis() - BuzzerTimeMarker) < 0)
+      return;
 
-      if (settings->volume == BUZZER_EXT)
-        ext_buzzer(false);
+    if (++BuzzerStep < BuzzerNumSteps) {
+      if (BuzzerStep & 1)
+        buzzer_off();
       else
-        noToneAC();
+        buzzer_on();
+      BuzzerTimeMarker += BuzzerSteps[BuzzerStep];
+      if (BuzzerTimeMarker == 0)
+          BuzzerTimeMarker = 1;
+    } else {   /* done beeping, turn it all off */
+      buzzer_off();
       BuzzerTimeMarker = 0;
-//if (settings->debug_flags & 0x80) {
-//snprintf_P(NMEABuffer, sizeof(NMEABuffer),"... buzzer final off at  %d ms\r\n", millis());
-//NMEAOutD();
-//}
     }
 
     return;
   }
 
   /* strobe does a self test, do something similar with buzzer */
-  if (do_alarm_demo && BuzzerTimeMarker == 0) {
-      delay(1000);
+  if (do_alarm_demo) {
+      if (BuzzerDemoMarker == 0) {       // wait a second between demo alarms
+          BuzzerDemoMarker = millis() + 1000;
+          return;
+      }
+      if ((int32_t)(millis() - BuzzerDemoMarker) < 0)
+          return;
+      BuzzerDemoMarker = 0;
       uint32_t t = millis() - SetupTimeMarker;
       if (t < (1000*(STROBE_INITIAL_RUN+3))) {
           // STROBE_INITIAL_RUN = 9
@@ -269,10 +282,7 @@ void Buzzer_fini(void)
 {
   if (settings->volume == BUZZER_OFF)
       return;
-  if (settings->volume == BUZZER_EXT)
-    ext_buzzer(false);
-  else
-    noToneAC();
+  buzzer_off();
   BuzzerTimeMarker = 0;
 }
 
@@ -43,7 +43,7 @@ enum
 };
 
 void Buzzer_setup(void);
-bool Buzzer_Notify(int8_t, bool);
+uint32_t Buzzer_Notify(int8_t, bool);
 void Buzzer_loop(void);
 void Buzzer_fini(void);
 
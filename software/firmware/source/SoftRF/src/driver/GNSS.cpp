@@ -36,11 +36,7 @@
 #include "../protocol/data/D1090.h"
 
 #if defined(USE_EGM96)
-//#include <egm96s.h>
-#if defined(FILESYS)
-//#include "SPIFFS.h"
-#endif
-static float geo_sep_from_file = 0.0;
+#include "../system/Geoid.h"
 #endif
 
 //#define DO_GNSS_DEBUG
@@ -65,6 +61,11 @@ uint32_t latest_Commit_Time = 0;   // millis() at first Time-commit after last P
 
 bool gnss_needs_reset = false;
 
+#if defined(USE_UBX_PVT)
+bool ubx_pvt_active = false;   // receiver sends NAV-PVT instead of GGA & RMC
+ubx_pvt_t ubx_pvt;
+#endif
+
 static bool is_prime_mk2 = false;
 gnss_id_t gnss_id = GNSS_MODULE_NONE;
 
@@ -261,6 +262,13 @@ const uint8_t enaGSV[] PROGMEM = {0xF0, 0x03, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01
 const uint8_t disGSV[] PROGMEM = {0xF0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}; // disable GSV
 const uint8_t disVTG[] PROGMEM = {0xF0, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}; // disable VTG
 const uint8_t disGLL[] PROGMEM = {0xF0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}; // disable GLL
+#if defined(USE_UBX_PVT)
+// binary fix, u-blox 7 and later: NAV-PVT & NAV-DOP in place of GGA & RMC
+const uint8_t enaPVT[] PROGMEM = {0x01, 0x07, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01}; // enable NAV-PVT
+const uint8_t enaDOP[] PROGMEM = {0x01, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01}; // enable NAV-DOP
+const uint8_t disRMC[] PROGMEM = {0xF0, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}; // disable RMC
+const uint8_t disGGA[] PROGMEM = {0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}; // disable GGA
+#endif
 
 /* Stratux Setup: enable GPS & Galileo & Glonass for u-blox 8 */
 /* error on u-blox 6 can be ignored */
@@ -530,9 +538,38 @@ static void setup_UBX()
     Serial.println(F("WARNING: Unable to set airborne <2g navigation mode."));
   }
 
+#if defined(USE_UBX_PVT)
+  ubx_pvt_active = false;
+
+  if (gnss_id >= GNSS_MODULE_U7 && gnss_id <= GNSS_MODULE_U10) {
+
+    GNSS_DEBUG_PRINTLN(F("Switching on UBX NAV-PVT: "));
+
+    msglen = makeUBXCFG(0x06, 0x01, sizeof(enaPVT), enaPVT);
+    sendUBX(GNSSbuf, msglen);
+    ubx_pvt_active = getUBX_ACK(0x06, 0x01);
+    if (!ubx_pvt_active) {
+      Serial.println(F("WARNING: Unable to enable UBX NAV-PVT, using NMEA"));
+    } else {
+      msglen = makeUBXCFG(0x06, 0x01, sizeof(enaDOP), enaDOP);
+      sendUBX(GNSSbuf, msglen);
+      gnss_set_sucess = getUBX_ACK(0x06, 0x01);
+      if (!gnss_set_sucess) {
+        // PDOP from NAV-PVT will be reported as HDOP
+        Serial.println(F("WARNING: Unable to enable UBX NAV-DOP."));
+      }
+    }
+  }
+
+  // with NAV-PVT active, GGA & RMC are only generated for output - see UBX_PVT_Out()
+  GNSS_DEBUG_PRINTLN(ubx_pvt_active ? F("Switching off NMEA GGA: ") : F("Switching on NMEA GGA: "));
+
+  msglen = makeUBXCFG(0x06, 0x01, sizeof(enaGGA), (ubx_pvt_active ? disGGA : enaGGA));
+#else
   GNSS_DEBUG_PRINTLN(F("Switching on NMEA GGA: "));
 
   msglen = makeUBXCFG(0x06, 0x01, sizeof(enaGGA), enaGGA);
+#endif
   sendUBX(GNSSbuf, msglen);
   gnss_set_sucess = getUBX_ACK(0x06, 0x01);
   if (!gnss_set_sucess) {
@@ -540,9 +577,15 @@ static void setup_UBX()
     Serial.println(F("WARNING: Unable to enable NMEA GGA."));
   }
 
+#if defined(USE_UBX_PVT)
+  GNSS_DEBUG_PRINTLN(ubx_pvt_active ? F("Switching off NMEA RMC: ") : F("Switching on NMEA RMC: "));
+
+  msglen = makeUBXCFG(0x06, 0x01, sizeof(enaRMC), (ubx_pvt_active ? disRMC : enaRMC));
+#else
   GNSS_DEBUG_PRINTLN(F("Switching on NMEA RMC: "));
 
   msglen = makeUBXCFG(0x06, 0x01, sizeof(enaRMC), enaRMC);
+#endif
   sendUBX(GNSSbuf, msglen);
   gnss_set_sucess = getUBX_ACK(0x06, 0x01);
   if (!gnss_set_sucess) {
@@ -2105,6 +2148,250 @@ uint8_t Try_GNSS_sentence() {
     return 1;
 }
 
+#if defined(USE_UBX_PVT)
+
+/*
+ * Binary fix from u-blox 7 and later receivers.
+ * A NAV-PVT message carries everything that GGA + RMC do, in one frame,
+ * with full resolution and without text parsing.  It is framed here,
+ * ahead of the printable-character filter in PickGNSSFix(), and each
+ * fix is committed to TinyGPS++ directly (see UBX_PVT_Commit()), so that
+ * the gnss.* consumers see no change.  The position and velocity for
+ * ThisAircraft are taken from ubx_pvt itself, at full resolution.
+ */
+
+#define UBX_NAV_PVT_LEN  92
+#define UBX_NAV_DOP_LEN  18
+#define UBX_MAX_SKIP    512   /* longer "frames" are taken to be noise */
+
+static uint8_t  ubx_payload[UBX_NAV_PVT_LEN];
+static uint8_t  ubx_state = 0;     /* 0 = not within a UBX frame */
+static uint8_t  ubx_class, ubx_id, ubx_cka, ubx_ckb;
+static uint16_t ubx_len, ubx_cnt;
+static uint16_t ubx_hdop = 0;      /* 0.01 units, from NAV-DOP */
+static bool     ubx_pvt_ready = false;
+
+static inline uint16_t ubx_u16(const uint8_t *p)
+{
+  return (uint16_t) p[0] | ((uint16_t) p[1] << 8);
+}
+
+static inline int32_t ubx_i32(const uint8_t *p)
+{
+  return (int32_t) ((uint32_t) p[0]         | ((uint32_t) p[1] <<  8) |
+                   ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+}
+
+static void UBX_Decode_Frame()
+{
+  const uint8_t *p = ubx_payload;
+
+  if (ubx_class != 0x01)
+    return;
+
+  if (ubx_id == 0x04 && ubx_len == UBX_NAV_DOP_LEN) {     /* NAV-DOP */
+    ubx_hdop = ubx_u16(p + 12);
+    return;
+  }
+
+  if (ubx_id != 0x07 || ubx_len != UBX_NAV_PVT_LEN)       /* NAV-PVT */
+    return;
+
+  ubx_pvt.timestamp = millis();
+  ubx_pvt.iTOW    = (uint32_t) ubx_i32(p);
+  ubx_pvt.year    = ubx_u16(p + 4);
+  ubx_pvt.month   = p[6];
+  ubx_pvt.day     = p[7];
+  ubx_pvt.hour    = p[8];
+  ubx_pvt.minute  = p[9];
+  ubx_pvt.second  = p[10];
+  ubx_pvt.valid   = p[11];
+  ubx_pvt.nano    = ubx_i32(p + 16);
+  ubx_pvt.fixType = p[20];
+  ubx_pvt.flags   = p[21];
+  ubx_pvt.numSV   = p[23];
+  ubx_pvt.lon     = ubx_i32(p + 24);
+  ubx_pvt.lat     = ubx_i32(p + 28);
+  ubx_pvt.height  = ubx_i32(p + 32);
+  ubx_pvt.hMSL    = ubx_i32(p + 36);
+  ubx_pvt.hAcc    = (uint32_t) ubx_i32(p + 40);
+  ubx_pvt.vAcc    = (uint32_t) ubx_i32(p + 44);
+  ubx_pvt.velN    = ubx_i32(p + 48);
+  ubx_pvt.velE    = ubx_i32(p + 52);
+  ubx_pvt.velD    = ubx_i32(p + 56);
+  ubx_pvt.gSpeed  = ubx_i32(p + 60);
+  ubx_pvt.headMot = ubx_i32(p + 64);
+  ubx_pvt.pDOP    = ubx_u16(p + 76);
+  ubx_pvt_ready = true;
+}
+
+// returns true if the byte belongs to a UBX frame (and so is not NMEA)
+static bool UBX_Parse_Byte(uint8_t c)
+{
+  switch (ubx_state) {
+  case 0:
+    if (c != 0xB5)
+      return false;
+    ubx_state = 1;
+    return true;
+  case 1:
+    if (c == 0x62) {
+      ubx_state = 2;
+      ubx_cka = ubx_ckb = 0;
+      return true;
+    }
+    ubx_state = (c == 0xB5 ? 1 : 0);
+    return (ubx_state == 1);
+  case 8:                                        /* CK_B */
+    ubx_state = 0;
+    if (c == ubx_ckb && ubx_len <= sizeof(ubx_payload))
+      UBX_Decode_Frame();
+    return true;
+  case 7:                                        /* CK_A */
+    ubx_state = (c == ubx_cka ? 8 : 0);
+    return true;
+  default:
+    break;
+  }
+
+  ubx_cka += c;
+  ubx_ckb += ubx_cka;
+
+  switch (ubx_state) {
+  case 2:  ubx_class = c;  ubx_state = 3;  break;
+  case 3:  ubx_id    = c;  ubx_state = 4;  break;
+  case 4:  ubx_len   = c;  ubx_state = 5;  break;
+  case 5:
+    ubx_len |= (uint16_t) c << 8;
+    ubx_cnt = 0;
+    ubx_state = (ubx_len == 0 ? 7 : (ubx_len > UBX_MAX_SKIP ? 0 : 6));
+    break;
+  case 6:
+    if (ubx_cnt < sizeof(ubx_payload))
+      ubx_payload[ubx_cnt] = c;
+    if (++ubx_cnt == ubx_len)
+      ubx_state = 7;
+    break;
+  }
+  return true;
+}
+
+/*
+ * GGA & RMC text, only for those who want it: the IGC and alarm logs read
+ * GPGGA_Copy, and NMEA output to external devices may include GGA & RMC.
+ * Nothing parses this back.
+ */
+static void UBX_PVT_Out(bool fix, int quality, float hdop)
+{
+  char s[NMEA_BUFFER_SIZE];
+  char hms[16]  = "";
+  char dmy[8]   = "";
+  char lat[16]  = ",";
+  char lon[16]  = ",";
+  char gn = (settings->gn_to_gp ? 'P' : 'N');
+
+  if (ubx_pvt.valid & 0x02) {                    /* validTime */
+    snprintf(hms, sizeof(hms), "%02d%02d%02d.%02d", ubx_pvt.hour,
+             ubx_pvt.minute, ubx_pvt.second, (int) (ubx_pvt.iTOW % 1000) / 10);
+  }
+  if (ubx_pvt.valid & 0x01)                      /* validDate */
+    snprintf(dmy, sizeof(dmy), "%02d%02d%02d",
+             ubx_pvt.day, ubx_pvt.month, ubx_pvt.year % 100);
+
+  if (fix) {
+    /* integer arithmetic keeps the full 1e-7 degree resolution */
+    int32_t a = (ubx_pvt.lat < 0 ? -ubx_pvt.lat : ubx_pvt.lat);
+    int32_t m = (a % 10000000) * 60 / 100;      /* 1e-5 minutes */
+    snprintf(lat, sizeof(lat), "%02d%02d.%05d,%c", (int) (a / 10000000),
+             (int) (m / 100000), (int) (m % 100000), (ubx_pvt.lat < 0 ? 'S' : 'N'));
+    a = (ubx_pvt.lon < 0 ? -ubx_pvt.lon : ubx_pvt.lon);
+    m = (a % 10000000) * 60 / 100;
+    snprintf(lon, sizeof(lon), "%03d%02d.%05d,%c", (int) (a / 10000000),
+             (int) (m / 100000), (int) (m % 100000), (ubx_pvt.lon < 0 ? 'W' : 'E'));
+
+    snprintf_P(s, sizeof(s), PSTR("$G%cGGA,%s,%s,%s,%d,%02d,%.2f,%.1f,M,%.1f,M,,*"),
+               gn, hms, lat, lon, quality, ubx_pvt.numSV, hdop,
+               0.001f * ubx_pvt.hMSL, 0.001f * (ubx_pvt.height - ubx_pvt.hMSL));
+  } else {
+    snprintf_P(s, sizeof(s), PSTR("$G%cGGA,%s,,,,,0,%02d,%.2f,,,,,,*"),
+               gn, hms, ubx_pvt.numSV, hdop);
+  }
+  unsigned int len = NMEA_add_checksum(s);      /* including the \r\n */
+  memcpy(GPGGA_Copy, s, len - 2);               // for traffic alarm logging
+  GPGGA_Copy[len - 2] = '\0';
+
+  if (settings->nmea_g == 0 && settings->nmea2_g == 0)
+    return;
+  NMEA_Outs(NMEA_G, s, len, false);
+
+  if (fix) {
+    float course = 0.00001f * ubx_pvt.headMot;
+    if (course < 0.0f)  course += 360.0f;
+    snprintf_P(s, sizeof(s), PSTR("$G%cRMC,%s,A,%s,%s,%.3f,%.2f,%s,,,%c*"),
+               gn, hms, lat, lon, 0.001f * ubx_pvt.gSpeed / _GPS_MPS_PER_KNOT,
+               course, dmy, (quality == 2 ? 'D' : 'A'));
+  } else {
+    snprintf_P(s, sizeof(s), PSTR("$G%cRMC,%s,V,,,,,,,%s,,,N*"), gn, hms, dmy);
+  }
+  len = NMEA_add_checksum(s);
+  NMEA_Outs(NMEA_G, s, len, false);
+}
+
+/*
+ * Commit a NAV-PVT solution straight into the TinyGPS++ state, as a GGA
+ * and RMC pair would be, and flag it as a new fix.  The time of the fix
+ * within the second comes from iTOW rather than from a rounded text field.
+ */
+static void UBX_PVT_Commit()
+{
+  static uint32_t prev_fix_ms = 0;
+  ymd_t  d;
+  hmsc_t t;
+
+  ubx_pvt_ready = false;
+
+  bool fix = (ubx_pvt.fixType >= 2 && ubx_pvt.fixType <= 4 && (ubx_pvt.flags & 0x01));
+  int  quality = (fix ? ((ubx_pvt.flags & 0x02) ? 2 : 1) : 0);
+  uint32_t epoch_ms = ubx_pvt.iTOW % 1000;       /* UTC and GPS differ by whole seconds */
+
+  d.Year     = (uint8_t) (ubx_pvt.year - 2000);
+  d.Month    = ubx_pvt.month;
+  d.Day      = ubx_pvt.day;
+  t.Hour     = ubx_pvt.hour;
+  t.Minute   = ubx_pvt.minute;
+  t.Second   = ubx_pvt.second;
+  t.CentiSec = (uint8_t) (epoch_ms / 10);
+
+  float hdop = 0.01f * (ubx_hdop != 0 ? ubx_hdop : ubx_pvt.pDOP);
+  if (hdop > 99.99f)  hdop = 99.99f;
+
+  float course = 0.00001f * ubx_pvt.headMot;
+  if (course < 0.0f)  course += 360.0f;
+
+  gnss.commitFix((ubx_pvt.valid & 0x01) ? &d : NULL,
+                 (ubx_pvt.valid & 0x02) ? &t : NULL,
+                 (FixQuality) quality,
+                 1e-7f * ubx_pvt.lat, 1e-7f * ubx_pvt.lon,
+                 0.001f * ubx_pvt.hMSL, 0.001f * (ubx_pvt.height - ubx_pvt.hMSL),
+                 0.001f * ubx_pvt.gSpeed / _GPS_MPS_PER_KNOT, course,
+                 ubx_pvt.numSV, hdop);
+  badGGA = !fix;
+
+  UBX_PVT_Out(fix, quality, hdop);
+
+  /* as in Try_GNSS_sentence(), at most one new fix per second */
+  if (ubx_pvt.timestamp - prev_fix_ms > 600) {
+    prev_fix_ms = ubx_pvt.timestamp;
+    /* for Time_loop(): when the message came, relative to the fix epoch */
+    latest_Commit_Time = ubx_pvt.timestamp - epoch_ms;
+    gnss_time_from_rmc = false;
+    gnss_new_fix  = true;
+    gnss_new_time = true;
+  }
+}
+
+#endif /* USE_UBX_PVT */
+
 void PickGNSSFix()
 {
   uint8_t c = 0;
@@ -2222,6 +2509,13 @@ void PickGNSSFix()
         /* retry */
         continue;
       }
+#if defined(USE_UBX_PVT)
+      if (ubx_pvt_active && UBX_Parse_Byte(c)) {
+        if (ubx_pvt_ready)
+          UBX_PVT_Commit();
+        continue;
+      }
+#endif
       if (isPrintable(c) || c == '\r' || c == '\n') {
         GNSSbuf[GNSS_cnt] = c;
       } else {
@@ -2325,6 +2619,14 @@ void PickGNSSFix()
       continue;
     }
 
+#if defined(USE_UBX_PVT)
+    if (ubx_pvt_active && NMEA_Source == DEST_NONE && UBX_Parse_Byte(c)) {
+      if (ubx_pvt_ready)
+        UBX_PVT_Commit();
+      continue;
+    }
+#endif
+
     if (isPrintable(c) || c == '\r' || c == '\n') {
       GNSSbuf[GNSS_cnt] = c;
     } else {
@@ -2400,81 +2702,15 @@ void PickGNSSFix()
 }
 
 #if defined(USE_EGM96)
-/*
- *  Algorithm of EGM96 geoid offset approximation was taken from XCSoar
- */
-static float AsBearing(float angle)
-{
-  float retval = angle;
-
-  while (retval < 0)
-    retval += 360.0;
-
-  while (retval >= 360.0)
-    retval -= 360.0;
-
-  return retval;
-}
-
-void LookupSeparation(float lat, float lon)
-{
-#if defined(FILESYS)
-  if (! FS_is_mounted) {
-      Serial.println(F("File system is not mounted"));
-      return;
-  }
-
-  int ilat, ilon;
-
-  ilat = round((90.0 - lat) / 2.0);
-  ilon = round(AsBearing(lon) / 2.0);
-
-  int offset = ilat * 180 + ilon;
-
-  if (offset >= 90*180)
-    return;
-
-  if (offset < 0)
-    return;
-
-  int retval = -1;
-  File egm96file = FILESYS.open("/egm96s.dem", "r");
-  if (!egm96file) {
-      Serial.println(F("File egm96s.dem not found"));
-      return;
-  } else {
-      if (! egm96file.seek(offset, SeekSet))
-          Serial.println(F("Failed to seek to offset in egm96s.dem"));
-      else
-          retval = (int) egm96file.read();
-      egm96file.close();
-  }
-  if (retval < 0)   // not read from file
-      return;
-  retval -= 127;
-  if (retval < -120 || retval > 120) {
-      Serial.print(F("LookupSeparation(): invalid value"));
-      return;
-  }
-  geo_sep_from_file = (retval? (float) retval : 0.1);    // exactly zero means n.a.
-  Serial.print(F("LookupSeparation() retrieved: "));
-  Serial.print(retval);
-  Serial.print(F(" from offset: "));
-  Serial.println(offset);
-#endif
-}
-
 float EGM96GeoidSeparation()
 {
     if (settings->geoid != 0)                  // zero means n.a.
         return (float) settings->geoid;
-    static uint32_t when_loaded = 0;
-    if ((when_loaded == 0 || millis() > when_loaded + 1200000)    // every 20 minutes
-             && ThisAircraft.latitude != 0.0 && isValidGNSSFix()) {
-        LookupSeparation (ThisAircraft.latitude, ThisAircraft.longitude);
-        when_loaded = millis();
-    }
-    return geo_sep_from_file;
+    if (ThisAircraft.latitude == 0.0 || !isValidGNSSFix())
+        return 0.0;
+    // interpolated from the built-in grid - cheap enough to do on every fix
+    float sep = Geoid_Separation(ThisAircraft.latitude, ThisAircraft.longitude);
+    return (sep != 0.0 ? sep : 0.1);           // exactly zero means n.a.
 }
 
 #else
@@ -61,6 +61,44 @@ typedef struct gnss_stat_struct {
 
 #define NMEA_EXP_TIME  3500 /* 3.5 seconds */
 
+#if defined(EXCLUDE_GNSS_UBLOX)
+#undef USE_UBX_PVT
+#endif
+
+#if defined(USE_UBX_PVT)
+/* latest UBX NAV-PVT solution, units as sent by the receiver */
+typedef struct ubx_pvt_struct {
+  uint32_t timestamp;   /* millis() at arrival */
+  uint32_t iTOW;        /* ms */
+  uint16_t year;
+  uint8_t  month;
+  uint8_t  day;
+  uint8_t  hour;
+  uint8_t  minute;
+  uint8_t  second;
+  uint8_t  valid;       /* bit 0: date, bit 1: time */
+  int32_t  nano;        /* ns, may be negative */
+  uint8_t  fixType;     /* 2 = 2D, 3 = 3D */
+  uint8_t  flags;       /* bit 0: gnssFixOK, bit 1: diffSoln */
+  uint8_t  numSV;
+  int32_t  lon;         /* 1e-7 deg */
+  int32_t  lat;
+  int32_t  height;      /* mm above ellipsoid */
+  int32_t  hMSL;        /* mm above MSL */
+  uint32_t hAcc;        /* mm */
+  uint32_t vAcc;
+  int32_t  velN;        /* mm/s */
+  int32_t  velE;
+  int32_t  velD;
+  int32_t  gSpeed;
+  int32_t  headMot;     /* 1e-5 deg */
+  uint16_t pDOP;        /* 0.01 */
+} ubx_pvt_t;
+
+extern bool ubx_pvt_active;
+extern ubx_pvt_t ubx_pvt;
+#endif /* USE_UBX_PVT */
+
 bool isValidGNSSFix  (void);
 byte GNSS_setup      (void);
 void GNSS_loop       (void);
@@ -68,7 +106,6 @@ void GNSS_fini       (void);
 void GNSSTimeSync    (void);
 void PickGNSSFix     (void);
 #if !defined(EXCLUDE_EGM96)
-void LookupSeparation (float, float);
 float EGM96GeoidSeparation();
 #endif
 uint8_t leap_seconds_valid(void);
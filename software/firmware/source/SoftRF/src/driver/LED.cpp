@@ -64,89 +64,195 @@ void LED_setup() {
 }
 
 #if !defined(EXCLUDE_LED_RING)
-// Fill the dots one after the other with a color
-static void colorWipe(color_t c, uint8_t wait) {
-  for (uint16_t i = 0; i < uni_numPixels(); i++) {
-    uni_setPixelColor(i, c);
-    uni_show();
-    delay(wait);
-  }
+/*
+ * The ring is drawn in frames: LED_DisplayTraffic() and LED_Clear() only
+ * set the target colour and pattern of each LED, and LED_loop() renders
+ * a frame from those every LED_FRAME_MS, with blinking and pulsing worked
+ * out from millis().  The strip is only written (with the GNSS serial
+ * input paused) if some LED actually changed.
+ */
+#define LED_FRAME_MS   20
+#define LED_TEST_STEP  50
+
+enum
+{
+	LED_STEADY,
+	LED_PULSE,       /* brightness ramps up and down once per second */
+	LED_BLINK,       /* 1 Hz */
+	LED_BLINK_FAST   /* 4 Hz */
+};
+
+#define RGB_BLACK       0, 0, 0
+#define RGB_BACKLIT     1, 1, 1
+#define RGB_RED         255, 0, 0
+#define RGB_YELLOW      255, 200, 0
+#define RGB_BLUE        0, 0, 255
+#define RGB_MI_RED      7, 0, 0
+#define RGB_MI_GREEN    0, 5, 0
+
+typedef struct led_target_struct {
+    uint8_t r, g, b;
+    uint8_t pattern;
+} led_target_t;
+
+static led_target_t led_target[PIX_NUM];
+static color_t led_shown[PIX_NUM];
+static bool led_shown_valid = false;
+static uint32_t led_frame_ms = 0;
+static uint32_t led_test_ms = 0;      /* start of the test animation, 0 if not running */
+
+static void LED_set(uint16_t i, uint8_t r, uint8_t g, uint8_t b, uint8_t pattern=LED_STEADY)
+{
+    led_target_t *tp = &led_target[i];
+    tp->r = r;
+    tp->g = g;
+    tp->b = b;
+    tp->pattern = pattern;
 }
 
-//Theatre-style crawling lights.
-static void theaterChase(color_t c, uint8_t wait) {
-  for (int j = 0; j < 10; j++) { //do 10 cycles of chasing
-    for (int q = 0; q < 3; q++) {
-      for (int i = 0; i < uni_numPixels(); i = i + 3) {
-        uni_setPixelColor(i + q, c);  //turn every third pixel on
+static color_t LED_render(led_target_t *tp, uint32_t now)
+{
+    uint16_t level = 256;
+    switch (tp->pattern)
+    {
+    case LED_PULSE:
+      {
+        uint32_t phase = now % 1000;
+        if (phase >= 500)
+            phase = 1000 - phase;
+        level = 32 + (phase * 224) / 500;
       }
-      uni_show();
+      break;
+    case LED_BLINK:
+      if (now % 1000 >= 500)
+          level = 0;
+      break;
+    case LED_BLINK_FAST:
+      if (now % 250 >= 125)
+          level = 0;
+      break;
+    default:
+      break;
+    }
+    level = (level * (Power_LED_level() + 1)) >> 8;
+    if (level == 256)
+        return uni_Color(tp->r, tp->g, tp->b);
+    return uni_Color((tp->r * level) >> 8, (tp->g * level) >> 8, (tp->b * level) >> 8);
+}
 
-      delay(wait);
+/*
+ * The power-up test: colour wipes in red, green and blue, theatre-style
+ * chases in white, red and blue, then a wipe to black, one step per
+ * LED_TEST_STEP ms.  Returns false when done.
+ */
+static bool LED_test_frame(uint32_t elapsed)
+{
+    static const uint8_t wipe[4][3]  = { {RGB_RED}, {0, 255, 0}, {RGB_BLUE}, {RGB_BLACK} };
+    static const uint8_t chase[3][3] = { {127, 127, 127}, {127, 0, 0}, {0, 0, 127} };
+    uint32_t step = elapsed / LED_TEST_STEP;
+    uint32_t n = PIX_NUM;
+
+    if (step < 3 * n) {
+        uint32_t w = step / n;
+        for (uint16_t i = 0; i < PIX_NUM; i++) {
+            const uint8_t *c = (i <= step % n ? wipe[w] : (w > 0 ? wipe[w-1] : wipe[3]));
+            LED_set(i, c[0], c[1], c[2]);
+        }
+        return true;
+    }
+    step -= 3 * n;
+    if (step < 3 * 30) {
+        const uint8_t *c = chase[step / 30];
+        uint16_t q = step % 3;
+        for (uint16_t i = 0; i < PIX_NUM; i++) {
+            if (i % 3 == q)
+                LED_set(i, c[0], c[1], c[2]);
+            else
+                LED_set(i, RGB_BLACK);
+        }
+        return true;
+    }
+    step -= 3 * 30;
+    for (uint16_t i = 0; i < PIX_NUM; i++)
+        LED_set(i, RGB_BLACK);
+    return (step < n);
+}
 
-      for (int i = 0; i < uni_numPixels(); i = i + 3) {
-        uni_setPixelColor(i + q, LED_COLOR_BLACK);      //turn every third pixel off
+static void LED_flush()
+{
+    uint32_t now = millis();
+    bool changed = false;
+
+    for (uint16_t i = 0; i < PIX_NUM; i++) {
+      color_t c = LED_render(&led_target[i], now);
+      if (! led_shown_valid || c != led_shown[i]) {
+        led_shown[i] = c;
+        uni_setPixelColor(i, c);
+        changed = true;
       }
     }
-  }
+    if (changed) {
+      SoC->swSer_enableRx(false);
+      uni_show();
+      SoC->swSer_enableRx(true);
+      led_shown_valid = true;
+    }
 }
 #endif /* EXCLUDE_LED_RING */
 
+/* starts the test animation, which then runs from LED_loop() */
 void LED_test() {
 #if !defined(EXCLUDE_LED_RING)
   if (SOC_GPIO_PIN_LED != SOC_UNUSED_PIN && settings->pointer != LED_OFF) {
-    // Some example procedures showing how to display to the pixels:
-    colorWipe(uni_Color(255, 0, 0), 50); // Red
-    colorWipe(uni_Color(0, 255, 0), 50); // Green
-    colorWipe(uni_Color(0, 0, 255), 50); // Blue
-    // Send a theater pixel chase in...
-    theaterChase(uni_Color(127, 127, 127), 50); // White
-    theaterChase(uni_Color(127, 0, 0), 50); // Red
-    theaterChase(uni_Color(0, 0, 127), 50); // Blue
-
-    //  rainbow(20);
-    //  rainbowCycle(20);
-    //  theaterChaseRainbow(50);
-    colorWipe(uni_Color(0, 0, 0), 50); // clear
+    led_test_ms = millis();
+    if (led_test_ms == 0)
+        led_test_ms = 1;
   }
 #endif /* EXCLUDE_LED_RING */
 }
 
 #if !defined(EXCLUDE_LED_RING)
 static void LED_Clear_noflush() {
+    if (led_test_ms)     // test animation owns the ring for now
+        return;
+
     for (uint16_t i = 0; i < RING_LED_NUM; i++) {
-      uni_setPixelColor(i, LED_COLOR_BACKLIT);
+      LED_set(i, RGB_BACKLIT);
     }
 
     if (rx_packets_counter > prev_rx_packets_counter) {
-      uni_setPixelColor(LED_STATUS_RX, LED_COLOR_MI_GREEN);
+      LED_set(LED_STATUS_RX, RGB_MI_GREEN);
       prev_rx_packets_counter = rx_packets_counter;
 
       if (settings->mode == SOFTRF_MODE_WATCHOUT) {
         for (uint16_t i = 0; i < RING_LED_NUM; i++) {
-          uni_setPixelColor(i, LED_COLOR_RED);
+          LED_set(i, RGB_RED);
         }
       } else if (settings->mode == SOFTRF_MODE_BRIDGE) {
         for (uint16_t i = 0; i < RING_LED_NUM; i++) {
-          uni_setPixelColor(i, LED_COLOR_MI_RED);
+          LED_set(i, RGB_MI_RED);
         }
       }
 
     }  else {
-      uni_setPixelColor(LED_STATUS_RX, LED_COLOR_BLACK);
+      LED_set(LED_STATUS_RX, RGB_BLACK);
     }
 
     if (tx_packets_counter > prev_tx_packets_counter) {
-      uni_setPixelColor(LED_STATUS_TX, LED_COLOR_MI_GREEN);
+      LED_set(LED_STATUS_TX, RGB_MI_GREEN);
       prev_tx_packets_counter = tx_packets_counter;
     } else {
-      uni_setPixelColor(LED_STATUS_TX, LED_COLOR_BLACK);
+      LED_set(LED_STATUS_TX, RGB_BLACK);
     }
 
-    uni_setPixelColor(LED_STATUS_POWER,
-      Battery_voltage() > Battery_threshold() ? LED_COLOR_MI_GREEN : LED_COLOR_MI_RED);
-    uni_setPixelColor(LED_STATUS_SAT,
-      isValidFix() ? LED_COLOR_MI_GREEN : LED_COLOR_MI_RED);
+    if (Battery_voltage() > Battery_threshold())
+      LED_set(LED_STATUS_POWER, RGB_MI_GREEN);
+    else
+      LED_set(LED_STATUS_POWER, RGB_MI_RED);
+    if (isValidFix())
+      LED_set(LED_STATUS_SAT, RGB_MI_GREEN);
+    else
+      LED_set(LED_STATUS_SAT, RGB_MI_RED);
 }
 #endif /* EXCLUDE_LED_RING */
 
@@ -154,10 +260,6 @@ void LED_Clear() {
 #if !defined(EXCLUDE_LED_RING)
   if (SOC_GPIO_PIN_LED != SOC_UNUSED_PIN && settings->pointer != LED_OFF) {
     LED_Clear_noflush();
-
-    SoC->swSer_enableRx(false);
-    uni_show();
-    SoC->swSer_enableRx(true);
   }
 #endif /* EXCLUDE_LED_RING */
 }
@@ -166,10 +268,15 @@ void LED_DisplayTraffic() {
 #if !defined(EXCLUDE_LED_RING)
   int bearing, distance;
   int led_num;
-  color_t color;
+  int8_t rank[RING_LED_NUM];
 
   if (SOC_GPIO_PIN_LED != SOC_UNUSED_PIN && settings->pointer != LED_OFF) {
     LED_Clear_noflush();
+    if (led_test_ms)
+      return;
+
+    for (int i=0; i < RING_LED_NUM; i++)
+      rank[i] = -1;
 
     for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
 
@@ -183,33 +290,52 @@ void LED_DisplayTraffic() {
         }
 
         led_num = ((bearing + LED_ROTATE_ANGLE + SECTOR_PER_LED/2) % 360) / SECTOR_PER_LED;
-//      Serial.print(bearing);
-//      Serial.print(" , ");
-//      Serial.println(led_num);
-//      Serial.println(distance);
-        if (distance < LED_DISTANCE_FAR) {
-          if (distance >= 0 && distance <= LED_DISTANCE_CLOSE) {
-            color =  LED_COLOR_RED;
-          } else if (distance > LED_DISTANCE_CLOSE && distance <= LED_DISTANCE_NEAR) {
-            color =  LED_COLOR_YELLOW;
-          } else if (distance > LED_DISTANCE_NEAR && distance <= LED_DISTANCE_FAR) {
-            color =  LED_COLOR_BLUE;
-          }
-          uni_setPixelColor(led_num, color);
+
+        /* the most threatening aircraft in each direction is shown */
+        int8_t alarm_level = Container[i].alarm_level;
+        int8_t r;
+        if (alarm_level >= ALARM_LEVEL_LOW) {
+          r = 4 + alarm_level;
+        } else if (distance < 0 || distance >= LED_DISTANCE_FAR) {
+          continue;
+        } else if (distance <= LED_DISTANCE_CLOSE) {
+          r = 3;
+        } else if (distance <= LED_DISTANCE_NEAR) {
+          r = 2;
+        } else {
+          r = 1;
+        }
+        if (r <= rank[led_num])
+          continue;
+        rank[led_num] = r;
+
+        switch (r)
+        {
+        case 4 + ALARM_LEVEL_URGENT:     LED_set(led_num, RGB_RED, LED_BLINK_FAST);  break;
+        case 4 + ALARM_LEVEL_IMPORTANT:  LED_set(led_num, RGB_RED, LED_BLINK);       break;
+        case 4 + ALARM_LEVEL_LOW:        LED_set(led_num, RGB_RED, LED_PULSE);       break;
+        case 3:                          LED_set(led_num, RGB_RED);                  break;
+        case 2:                          LED_set(led_num, RGB_YELLOW);               break;
+        default:                         LED_set(led_num, RGB_BLUE);                 break;
         }
       }
     }
-
-    SoC->swSer_enableRx(false);
-    uni_show();
-    SoC->swSer_enableRx(true);
-
   }
 #endif /* EXCLUDE_LED_RING */
 }
 
 void LED_loop() {
 
+#if !defined(EXCLUDE_LED_RING)
+  if (SOC_GPIO_PIN_LED != SOC_UNUSED_PIN && settings->pointer != LED_OFF
+      && millis() - led_frame_ms >= LED_FRAME_MS) {
+    led_frame_ms = millis();
+    if (led_test_ms && ! LED_test_frame(led_frame_ms - led_test_ms))
+      led_test_ms = 0;
+    LED_flush();
+  }
+#endif /* EXCLUDE_LED_RING */
+
   if (hw_info.model == SOFTRF_MODEL_PRIME_MK2) {
     if (hw_info.revision >= 8)
       return;
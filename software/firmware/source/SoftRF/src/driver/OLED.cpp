@@ -78,26 +78,13 @@ U8X8 *u8x8 = NULL;
 static bool OLED_display_titles = false;
 static uint32_t prev_tx_packets_counter = (uint32_t) -1;
 static uint32_t prev_rx_packets_counter = (uint32_t) -1;
-static uint32_t prev_adsb_packets_counter = (uint32_t) -1;
-static bool prev_rx1090found = false;
 // extern uint32_t tx_packets_counter, rx_packets_counter, adsb_packets_counter;
 
 static uint32_t prev_acrfts_counter = (uint32_t) -1;
 static uint32_t prev_sats_counter   = (uint32_t) -1;
 static uint32_t prev_uptime_minutes = (uint32_t) -1;
 static int32_t  prev_voltage        = (uint32_t) -1;
-static char     prev_fix            = ' ';
-static int8_t   prev_band           = -1;
-static int8_t   prev_type           = -1;
 static int8_t   prev_min            = -1;
-static int8_t   prev_maxrssi        = 0;
-
-#if !defined(EXCLUDE_OLED_BARO_PAGE)
-static int32_t  prev_altitude       = (int32_t)   -10000;
-static int32_t  prev_temperature    = (int32_t)   -100;
-static uint32_t prev_pressure       = (uint32_t)  -1;
-static int32_t  prev_cdr            = (int32_t)   -10000; /* climb/descent rate */
-#endif /* EXCLUDE_OLED_BARO_PAGE */
 
 unsigned long OLEDTimeMarker = 0;
 
@@ -163,10 +150,111 @@ static bool showing_message = false;
 //byte OLED_setup()
 // done in ESP32.cpp ESP32_Display_setup() instead
 
+/*
+ * The values on the 128x64 pages are drawn as "fields": a position, a
+ * font size (1 for 8x8, 2 for the 16x16 2x2 font) and a function that
+ * formats the current value.  A page binds its table of fields after
+ * drawing its titles, and from then on OLED_draw_fields() only sends the
+ * characters that differ from what is already on the screen - each is a
+ * single tile, or 2x2 tiles, over I2C.
+ */
+#define OLED_FIELD_LEN   4
+#define OLED_MAX_FIELDS  8
+
+typedef struct oled_field_struct {
+    uint8_t x, y;
+    uint8_t size;                 /* 1 or 2 */
+    void (*format)(char *buf);    /* writes up to OLED_FIELD_LEN chars */
+} oled_field_t;
+
+static const oled_field_t *oled_fields = NULL;
+static uint8_t oled_nfields = 0;
+static char oled_shown[OLED_MAX_FIELDS][OLED_FIELD_LEN+1];
+
+static void OLED_bind(const oled_field_t *fields, uint8_t n)
+{
+  oled_fields  = fields;
+  oled_nfields = (n < OLED_MAX_FIELDS ? n : OLED_MAX_FIELDS);
+  memset(oled_shown, 0, sizeof(oled_shown));   // nothing drawn yet
+}
+
+static void OLED_draw_fields()
+{
+  char buf[OLED_FIELD_LEN+8];
+
+  for (uint8_t i = 0; i < oled_nfields; i++) {
+    const oled_field_t *fp = &oled_fields[i];
+    char *shown = oled_shown[i];
+    memset(buf, 0, sizeof(buf));
+    (*fp->format)(buf);
+    buf[OLED_FIELD_LEN] = '\0';
+    bool was_drawn = (shown[0] != '\0');
+    for (uint8_t k = 0; k < OLED_FIELD_LEN; k++) {
+      char c = buf[k];
+      if (c == '\0') {
+        if (shown[k] == '\0')
+          break;
+        c = ' ';                  // erase the rest of a longer old value
+      }
+      if (was_drawn && c == shown[k])
+        continue;
+      if (fp->size == 2)
+        u8x8->draw2x2Glyph(fp->x + 2*k, fp->y, c);
+      else
+        u8x8->drawGlyph(fp->x + k, fp->y, c);
+    }
+    strcpy(shown, buf);
+  }
+}
+
+/* right-pads a counter to its field width, as the pages always did */
+static void OLED_count(char *buf, uint32_t value, uint32_t modulo, uint8_t width)
+{
+  itoa(value % modulo, buf, 10);
+  while (strlen(buf) < width)
+    strcat(buf, " ");
+}
+
+static void OLED_fmt_band(char *buf)
+{
+  if (settings->band >= 0 && settings->band < 11)
+    strcpy(buf, ISO3166_CC[settings->band]);
+}
+
+static void OLED_fmt_type(char *buf)
+{
+  if (settings->acft_type >= 0 && settings->acft_type < 17)
+    strcpy(buf, aircraft_type_lbl[settings->acft_type]);
+}
+
+static int32_t OLED_voltage()
+{
+  return (Battery_voltage() > BATTERY_THRESHOLD_INVALID ?
+            (int) (Battery_voltage() * 10.0 + 0.5) : 0);
+}
+
+static void OLED_fmt_volt_int(char *buf)
+{
+  int32_t voltage = OLED_voltage();
+  buf[0] = (voltage ? '0' + (voltage / 10 > 9 ? 9 : voltage / 10) : 'N');
+}
+
+static void OLED_fmt_volt_frac(char *buf)
+{
+  int32_t voltage = OLED_voltage();
+  buf[0] = (voltage ? '0' + voltage % 10 : 'A');
+}
+
+static const oled_field_t settings_fields[] = {
+  {  0, 6, 2, OLED_fmt_band      },
+  {  5, 6, 2, OLED_fmt_type      },
+  { 11, 6, 2, OLED_fmt_volt_int  },
+  { 14, 6, 2, OLED_fmt_volt_frac },
+};
+
 static void OLED_settings()
 {
   char buf[16];
-  uint32_t disp_value;
 
   if (!OLED_display_titles) {
 
@@ -208,81 +296,82 @@ static void OLED_settings()
 
     u8x8->drawGlyph (13, 7, '.');
 
-    prev_uptime_minutes = (uint32_t) -1;
-    prev_voltage        = (uint32_t) -1;
-    prev_band           = -1;
-    prev_type           = -1;
+    // uptime is not important, show band and aircraft type instead
+    OLED_bind(settings_fields, sizeof(settings_fields) / sizeof(oled_field_t));
 
     OLED_display_titles = true;
   }
 
-#if 0
-  uint32_t uptime_minutes = millis() / 60000;
-  if (prev_uptime_minutes != uptime_minutes) {
-    uint32_t uptime_hours = uptime_minutes / 60;
-    disp_value = uptime_hours % 100;
-    if (disp_value < 10) {
-      buf[0] = '0';
-      itoa(disp_value, buf+1, 10);
-    } else {
-      itoa(disp_value, buf, 10);
-    }
-
+  OLED_draw_fields();
+}
 
-    u8x8->draw2x2String(0, 6, buf);
+static void OLED_fmt_acfts(char *buf)
+{
+  uint32_t acrfts_counter = Traffic_Count();
+  OLED_count(buf, (acrfts_counter > 99 ? 99 : acrfts_counter), 100, 2);
+}
 
-    disp_value = uptime_minutes % 60;
-    if (disp_value < 10) {
-      buf[0] = '0';
+static void OLED_fmt_sats(char *buf)
+{
+  uint32_t sats_counter = gnss.satellites.value();
+  OLED_count(buf, (sats_counter > 99 ? 99 : sats_counter), 100, 2);
+}
 
-      itoa(disp_value, buf+1, 10);
-    } else {
-      itoa(disp_value, buf, 10);
-    }
+static void OLED_fmt_fix(char *buf)
+{
+  buf[0] = (isValidGNSSFix()? (leap_seconds_valid()==2? '!' : '+') : '-');
+}
 
-    u8x8->draw2x2String(5, 6, buf);
+static void OLED_fmt_rx(char *buf)
+{
+  if (settings->power_save & POWER_SAVE_NORECEIVE &&
+      (hw_info.rf == RF_IC_SX1276 || hw_info.rf == RF_IC_SX1262))
+    strcpy(buf, "OFF");
+  else
+    OLED_count(buf, rx_packets_counter, 1000, 3);
+}
 
-    prev_uptime_minutes = uptime_minutes;
-  }
-#else
-  // uptime is not important, show band and aircraft type instead:
-  if (prev_band != settings->band) {
-    prev_band = settings->band;
-    if (prev_band >= 0 && prev_band < 11)
-      u8x8->draw2x2String(0, 6, ISO3166_CC[prev_band]);
-  }
-  if (prev_type != settings->acft_type) {
-    prev_type = settings->acft_type;
-    if (prev_type >= 0 && prev_type < 17)
-      u8x8->draw2x2String(5, 6, aircraft_type_lbl[prev_type]);
+/* ADS-B packet count if receiving ADS-B, otherwise max RSSI */
+static void OLED_fmt_rssi(char *buf)
+{
+  if (settings->rx1090 != ADSB_RX_NONE || settings->gdl90_in != DEST_NONE) {
+    if (rx1090found)
+      OLED_count(buf, adsb_packets_counter, 1000, 3);
+    else
+      strcpy(buf, "---");
+  } else if (maxrssi < 0) {
+    int disp_value = (maxrssi < -99 ? -99 : maxrssi);
+    itoa(disp_value, buf, 10);
+    if (disp_value > -10)
+      strcat(buf, " ");
+  } else {
+    strcpy(buf, "---");
   }
-#endif
-
-  int32_t  voltage = Battery_voltage() > BATTERY_THRESHOLD_INVALID ?
-                              (int) (Battery_voltage() * 10.0 + 0.5) : 0;
-
-  if (prev_voltage != voltage) {
-    if (voltage) {
-      disp_value = voltage / 10;
-      disp_value = disp_value > 9 ? 9 : disp_value;
-      u8x8->draw2x2Glyph(11, 6, '0' + disp_value);
-
-      disp_value = voltage % 10;
+}
 
-      u8x8->draw2x2Glyph(14, 6, '0' + disp_value);
-    } else {
-      u8x8->draw2x2Glyph(11, 6, 'N');
-      u8x8->draw2x2Glyph(14, 6, 'A');
-    }
-    prev_voltage = voltage;
-  }
+static void OLED_fmt_tx(char *buf)
+{
+  if (settings->txpower == RF_TX_POWER_OFF)     // winch mode may still transmit
+    tx_packets_counter = 0;
+  if (settings->mode        == SOFTRF_MODE_RECEIVER ||
+      settings->rf_protocol == RF_PROTOCOL_ADSB_UAT ||
+      settings->txpower     == RF_TX_POWER_OFF)       // including winch mode
+    strcpy(buf, "OFF");
+  else
+    OLED_count(buf, tx_packets_counter, 1000, 3);
 }
 
+static const oled_field_t radio_fields[] = {
+  {  1, 1, 2, OLED_fmt_acfts },
+  {  7, 1, 2, OLED_fmt_sats  },
+  { 12, 1, 2, OLED_fmt_fix   },
+  { 10, 4, 2, OLED_fmt_rx    },
+  { 10, 6, 2, OLED_fmt_rssi  },
+  {  0, 5, 2, OLED_fmt_tx    },
+};
+
 static void OLED_radio()
 {
-  char buf[16];
-  uint32_t disp_value;
-
   if (!OLED_display_titles) {
 
     u8x8->clear();
@@ -309,136 +398,56 @@ static void OLED_radio()
         u8x8->drawString(7, 6, "RSS");
     }
 
-    if (settings->power_save & POWER_SAVE_NORECEIVE &&
-        (hw_info.rf == RF_IC_SX1276 || hw_info.rf == RF_IC_SX1262)) {
-      u8x8->draw2x2String(10, 4, "OFF");
-      prev_rx_packets_counter = rx_packets_counter;
-    } else {
-      prev_rx_packets_counter = (uint32_t) -1;
-    }
-
-    prev_adsb_packets_counter = -1;
-
-    if (settings->mode        == SOFTRF_MODE_RECEIVER ||
-        settings->rf_protocol == RF_PROTOCOL_ADSB_UAT ||
-        settings->txpower     == RF_TX_POWER_OFF) {
-      u8x8->draw2x2String(0, 5, "OFF");
-      prev_tx_packets_counter = tx_packets_counter;
-    } else {
-      prev_tx_packets_counter = (uint32_t) -1;
-    }
-
-    prev_acrfts_counter = (uint32_t) -1;
-    prev_sats_counter   = (uint32_t) -1;
-    prev_fix            = ' ';
+    OLED_bind(radio_fields, sizeof(radio_fields) / sizeof(oled_field_t));
 
     OLED_display_titles = true;
   }
 
-  uint32_t acrfts_counter = Traffic_Count();
-  uint32_t sats_counter   = gnss.satellites.value();
-  char fix = (isValidGNSSFix()? (leap_seconds_valid()==2? '!' : '+') : '-');
-
-  if (prev_acrfts_counter != acrfts_counter) {
-    disp_value = acrfts_counter > 99 ? 99 : acrfts_counter;
-    itoa(disp_value, buf, 10);
-    if (disp_value < 10) {
-      strcat_P(buf,PSTR(" "));
-    }
-    u8x8->draw2x2String(1, 1, buf);
-    prev_acrfts_counter = acrfts_counter;
-  }
+  OLED_draw_fields();
+}
 
-  if (prev_sats_counter != sats_counter) {
-    disp_value = sats_counter > 99 ? 99 : sats_counter;
-    itoa(disp_value, buf, 10);
-    if (disp_value < 10) {
-      strcat_P(buf,PSTR(" "));
-    }
-    u8x8->draw2x2String(7, 1, buf);
-    prev_sats_counter = sats_counter;
-  }
+#if !defined(EXCLUDE_OLED_BARO_PAGE)
+static void OLED_fmt_altitude(char *buf)
+{
+  snprintf(buf, OLED_FIELD_LEN+1, "%4d", (int) Baro_altitude());         /* metres */
+}
 
-  if (prev_fix != fix) {
-    u8x8->draw2x2Glyph(12, 1, fix);
-    prev_fix = fix;
-  }
+static void OLED_fmt_temperature(char *buf)
+{
+  snprintf(buf, OLED_FIELD_LEN+1, "%3d", (int) Baro_temperature());      /* Celcius */
+}
 
-  bool show_adsb = false;
-  if (settings->rx1090 != ADSB_RX_NONE || settings->gdl90_in != DEST_NONE)
-      show_adsb = true;
+static void OLED_fmt_pressure(char *buf)
+{
+  snprintf(buf, OLED_FIELD_LEN+1, "%4d", (int) (Baro_pressure() / 100)); /* mbar */
+}
 
-  if (rx_packets_counter != prev_rx_packets_counter) {
-    disp_value = rx_packets_counter % 1000;
-    itoa(disp_value, buf, 10);
-    if (disp_value < 10) {
-      strcat_P(buf,PSTR("  "));
-    } else {
-      if (disp_value < 100) {
-        strcat_P(buf,PSTR(" "));
-      };
-    }
-    //u8x8->draw2x2String(10, ((settings->rx1090 || (settings->gdl90_in != DEST_NONE))? 4 : 5), buf);
-    u8x8->draw2x2String(10, 4, buf);
-    if (! show_adsb) {                     // then show max RSSI instead
-      if (maxrssi != prev_maxrssi) {
-        if (maxrssi < 0) {
-          disp_value = maxrssi;
-          if (disp_value < -99)
-              disp_value = -99;
-          itoa(disp_value, buf, 10);
-          if (disp_value > -10)
-              strcat_P(buf,PSTR(" "));
-          u8x8->draw2x2String(10, 6, buf);
-        } else {
-          u8x8->draw2x2String(10, 6, "---");
-        }
-        prev_maxrssi = maxrssi;
-      }
-    }
-    prev_rx_packets_counter = rx_packets_counter;
-  }
+static int OLED_cdr()
+{
+  int32_t cdr = ThisAircraft.vs;        /* feet per minute */
+  return constrain(cdr, -999, 999);
+}
 
-  if (show_adsb) {
-    if (adsb_packets_counter != prev_adsb_packets_counter || prev_rx1090found != rx1090found) {
-      if (rx1090found) {
-          disp_value = adsb_packets_counter % 1000;
-          itoa(disp_value, buf, 10);
-          if (disp_value < 10) {
-              strcat_P(buf,PSTR("  "));
-          } else if (disp_value < 100) {
-              strcat_P(buf,PSTR(" "));
-          }
-          u8x8->draw2x2String(10, 6, buf);
-      } else {
-          u8x8->draw2x2String(10, 6, "---");
-      }
-      prev_adsb_packets_counter = adsb_packets_counter;
-      prev_rx1090found = rx1090found;
-    }
-  }
+static void OLED_fmt_cdr_sign(char *buf)
+{
+  buf[0] = (OLED_cdr() < 0 ? '_' : ' ');
+}
 
-  if (tx_packets_counter > 0 && settings->txpower == RF_TX_POWER_OFF) {   // for winch mode
-    u8x8->draw2x2String(0, 5, "OFF");
-    prev_tx_packets_counter = tx_packets_counter = 0;
-  } else if (tx_packets_counter != prev_tx_packets_counter) {
-    disp_value = tx_packets_counter % 1000;
-    itoa(disp_value, buf, 10);
-    if (disp_value < 10) {
-        strcat_P(buf,PSTR("  "));
-    } else if (disp_value < 100) {
-        strcat_P(buf,PSTR(" "));
-    }
-    u8x8->draw2x2String(0, 5, buf);
-    prev_tx_packets_counter = tx_packets_counter;
-  }
+static void OLED_fmt_cdr(char *buf)
+{
+  snprintf(buf, OLED_FIELD_LEN+1, "%3d", abs(OLED_cdr()));
 }
 
-#if !defined(EXCLUDE_OLED_BARO_PAGE)
+static const oled_field_t baro_fields[] = {
+  {  0, 2, 2, OLED_fmt_altitude    },
+  { 10, 2, 2, OLED_fmt_temperature },
+  {  0, 6, 2, OLED_fmt_pressure    },
+  {  9, 6, 1, OLED_fmt_cdr_sign    },
+  { 10, 6, 2, OLED_fmt_cdr         },
+};
+
 static void OLED_baro()
 {
-  char buf[16];
-
   if (!OLED_display_titles) {
 
     u8x8->clear();
@@ -451,44 +460,12 @@ static void OLED_baro()
 
     u8x8->drawString( 9, 5, CDR_text);
 
-    prev_altitude     = (int32_t)   -10000;
-    prev_temperature  = prev_altitude;
-    prev_pressure     = (uint32_t)  -1;
-    prev_cdr          = prev_altitude;
+    OLED_bind(baro_fields, sizeof(baro_fields) / sizeof(oled_field_t));
 
     OLED_display_titles = true;
   }
 
-  int32_t altitude    = Baro_altitude();        /* metres */
-  int32_t temperature = Baro_temperature();     /* Celcius */
-  uint32_t pressure   = Baro_pressure() / 100;  /* mbar */
-  int32_t cdr         = ThisAircraft.vs;        /* feet per minute */
-
-  if (prev_altitude != altitude) {
-    snprintf(buf, sizeof(buf), "%4d", altitude);
-    u8x8->draw2x2String(0, 2, buf);
-    prev_altitude = altitude;
-  }
-
-  if (prev_temperature != temperature) {
-    snprintf(buf, sizeof(buf), "%3d", temperature);
-    u8x8->draw2x2String(10, 2, buf);
-    prev_temperature = temperature;
-  }
-
-  if (prev_pressure != pressure) {
-    snprintf(buf, sizeof(buf), "%4d", pressure);
-    u8x8->draw2x2String(0, 6, buf);
-    prev_pressure = pressure;
-  }
-
-  if (prev_cdr != cdr) {
-    int disp_value = constrain(cdr, -999, 999);
-    snprintf(buf, sizeof(buf), "%3d", abs(disp_value));
-    u8x8->drawGlyph    ( 9, 6, disp_value < 0 ? '_' : ' ');
-    u8x8->draw2x2String(10, 6, buf);
-    prev_cdr = cdr;
-  }
+  OLED_draw_fields();
 }
 #endif /* EXCLUDE_OLED_BARO_PAGE */
 
@@ -25,7 +25,7 @@ extern U8X8 *u8x8;
 #define SSD1306_OLED_I2C_ADDR   0x3C
 #define SH1106_OLED_I2C_ADDR    0x3C /* 0x3D */
 
-#define isTimeToOLED()          (millis() - OLEDTimeMarker > 500)
+#define isTimeToOLED()          (millis() - OLEDTimeMarker > Power_OLED_interval())
 
 //byte OLED_setup(void);
 void OLED_loop(void);
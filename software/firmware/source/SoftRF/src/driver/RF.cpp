@@ -54,6 +54,8 @@ uint32_t rx_packets_counter = 0;
 
 int8_t which_rx_try = 0;
 int8_t RF_last_rssi = 0;
+int8_t RF_last_snr = 0;         // as reported by the radio, LoRa only
+uint32_t RF_last_rx_ms = 0;     // millis() when the last packet was received
 uint32_t RF_last_crc = 0;
 uint8_t RF_last_protocol = 0;
 uint8_t current_RX_protocol;
@@ -481,6 +483,106 @@ static bool sx12xx_transmit_complete = false;
 
 static uint8_t sx12xx_channel_prev = RF_CHANNEL_NONE;
 
+/*
+ * Received frames are handed from the radio side to the main loop through
+ * a single-producer single-consumer ring: sx12xx_rx_func() decodes straight
+ * into the slot at the head, and sx12xx_receive() copies the one at the tail
+ * into RxBuffer.  With USE_RADIO_TASK the producer is a separate task that
+ * runs os_runstep() as soon as the radio raises a DIO line (polling every
+ * tick otherwise), so reception no longer waits for the rest of the loop.
+ */
+typedef struct sx12xx_rx_frame_struct {
+  byte     data[MAX_PKT_SIZE] __attribute__((aligned(sizeof(uint32_t))));
+  uint32_t crc;
+  uint32_t ms;          /* millis() at the end of the frame */
+  uint8_t  protocol;
+  int8_t   rssi;
+  int8_t   snr;
+} sx12xx_rx_frame_t;
+
+#define SX12XX_RXQ_SIZE  4    /* power of 2, holds one less */
+#define SX12XX_RXQ_MASK  (SX12XX_RXQ_SIZE - 1)
+
+static sx12xx_rx_frame_t sx12xx_rxq[SX12XX_RXQ_SIZE];
+static volatile uint8_t  sx12xx_rxq_head = 0;   /* written by the radio side only */
+static volatile uint8_t  sx12xx_rxq_tail = 0;   /* written by the main loop only */
+static uint32_t sx12xx_rxq_dropped = 0;       /* ring was full */
+
+static void sx12xx_rxq_push()
+{
+  __sync_synchronize();       /* frame contents before the index */
+  sx12xx_rxq_head = (sx12xx_rxq_head + 1) & SX12XX_RXQ_MASK;
+}
+
+#if defined(USE_RADIO_TASK)
+
+#if CONFIG_FREERTOS_UNICORE
+#define RADIO_TASK_CORE   0
+#else
+#define RADIO_TASK_CORE   (1 - ARDUINO_RUNNING_CORE)   /* away from loop() */
+#endif
+#define RADIO_TASK_STACK  3072
+
+static SemaphoreHandle_t sx12xx_mutex = NULL;
+static TaskHandle_t sx12xx_task_handle = NULL;
+static volatile bool sx12xx_task_run = false;
+
+#define RADIO_LOCK()     xSemaphoreTake(sx12xx_mutex, portMAX_DELAY)
+#define RADIO_UNLOCK()   xSemaphoreGive(sx12xx_mutex)
+
+static void IRAM_ATTR sx12xx_dio_isr()
+{
+  BaseType_t woken = pdFALSE;
+  if (sx12xx_task_handle)
+    vTaskNotifyGiveFromISR(sx12xx_task_handle, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+/* owns the radio while receiving: the main loop only takes it to TX or retune */
+static void sx12xx_radio_task(void *param)
+{
+  for (;;) {
+    (void) ulTaskNotifyTake(pdTRUE, 1);        /* DIO edge, or 1 tick */
+    if (! sx12xx_task_run || ! sx12xx_receive_active)
+      continue;
+    RADIO_LOCK();
+    if (sx12xx_receive_active) {
+      sx12xx_receive_complete = false;
+      os_runstep();
+      if (sx12xx_receive_complete) {           /* set by sx12xx_rx_func() */
+        sx12xx_rxq_push();
+        sx12xx_rx(sx12xx_rx_func);             /* re-arm at once, same channel */
+        sx12xx_receive_active = true;
+      }
+    }
+    RADIO_UNLOCK();
+  }
+}
+
+static void sx12xx_task_start()
+{
+  if (sx12xx_task_handle == NULL) {
+    sx12xx_mutex = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(sx12xx_radio_task, "Radio", RADIO_TASK_STACK, NULL,
+                            configMAX_PRIORITIES - 3, &sx12xx_task_handle,
+                            RADIO_TASK_CORE);
+#if !defined(LMIC_USE_INTERRUPTS)
+    /* the LMIC HAL polls the DIO levels, an edge here just wakes the task */
+    for (int i = 0; i < NUM_DIO; i++) {
+      if (lmic_pins.dio[i] != LMIC_UNUSED_PIN)
+        attachInterrupt(digitalPinToInterrupt(lmic_pins.dio[i]), sx12xx_dio_isr, RISING);
+    }
+#endif
+  }
+  sx12xx_task_run = true;
+}
+
+#else
+#define RADIO_LOCK()
+#define RADIO_UNLOCK()
+#endif /* USE_RADIO_TASK */
+
 #if defined(USE_BASICMAC)
 void os_getDevEui (u1_t* buf) { }
 u1_t os_getRegion (void) { return REGCODE_EU868; }
@@ -608,6 +710,8 @@ static void sx12xx_channel(uint8_t channel)
 {
   if (channel != sx12xx_channel_prev) {
 
+    RADIO_LOCK();
+
     uint32_t frequency = RF_FreqPlan.getChanFrequency(channel);
 
     //Serial.print("frequency: "); Serial.println(frequency);
@@ -636,6 +740,8 @@ static void sx12xx_channel(uint8_t channel)
 
     sx12xx_channel_prev = channel;
 
+    RADIO_UNLOCK();
+
 //Serial.println("sx12xx_channel() set freq");
 //  } else {
 //Serial.println("sx12xx_channel() skipped setting freq");
@@ -745,6 +851,10 @@ static void sx12xx_setup()
   SoC->SPI_begin();
 
   sx12xx_resetup();
+
+#if defined(USE_RADIO_TASK)
+  sx12xx_task_start();
+#endif
 }
 
 static void sx12xx_setvars()
@@ -780,13 +890,18 @@ static void sx12xx_setvars()
 static bool sx12xx_receive()
 {
   bool success = false;
-  sx12xx_receive_complete = false;
 
   //LMIC.protocol = curr_rx_protocol_ptr;  done in set_protocol_for_slot
 
+  RADIO_LOCK();
+
   if (!sx12xx_receive_active) {  // reset by sx12xx_rx_func() or by sx12xx_channel()
     if (settings->power_save & POWER_SAVE_NORECEIVE) {
       LMIC_shutdown();
+    } else if (! Power_alt_rx() && curr_rx_protocol_ptr == altprotocol_ptr
+                                && altprotocol_ptr != mainprotocol_ptr) {
+      // power governor: leave the radio idle in the alt protocol slots
+      LMIC_shutdown();
     } else {
 #if 0
       // redundant since already done in set_protocol_for_slot
@@ -801,18 +916,31 @@ static bool sx12xx_receive()
     sx12xx_receive_active = true;
   }
 
-  if (sx12xx_receive_complete == false) {
-    // execute scheduled jobs and events
-    os_runstep();
-  };
+#if !defined(USE_RADIO_TASK)
+  sx12xx_receive_complete = false;
+  // execute scheduled jobs and events
+  os_runstep();
+  if (sx12xx_receive_complete == true)   // set by sx12xx_rx_func()
+    sx12xx_rxq_push();
+#endif
 
-  if (sx12xx_receive_complete == true) {  // set by sx12xx_rx_func()
-    RF_last_rssi = LMIC.rssi;
+  RADIO_UNLOCK();
+
+  if (sx12xx_rxq_tail != sx12xx_rxq_head) {
+    sx12xx_rx_frame_t *rxf = &sx12xx_rxq[sx12xx_rxq_tail];
+    memcpy(RxBuffer, rxf->data, sizeof(RxBuffer));
+    RF_last_rssi = rxf->rssi;
+    RF_last_snr = rxf->snr;
+    RF_last_rx_ms = rxf->ms;
+    RF_last_protocol = rxf->protocol;
+    RF_last_crc = rxf->crc;
+    __sync_synchronize();       /* done with the slot before releasing it */
+    sx12xx_rxq_tail = (sx12xx_rxq_tail + 1) & SX12XX_RXQ_MASK;
     rx_packets_counter++;
     success = true;
 
 if (settings->debug_flags & DEBUG_DEEPER) {
-uint32_t ms = millis() - ref_time_ms;
+uint32_t ms = RF_last_rx_ms - ref_time_ms;
 if (ms < 300)  ms += 1000;
 Serial.printf("RX in prot %d, time slot %d, sec %d(%d) + %d ms\r\n",
     RF_last_protocol, RF_current_slot, RF_time, (RF_time & 0x0F), ms);
@@ -825,6 +953,8 @@ Serial.printf("RX in prot %d, time slot %d, sec %d(%d) + %d ms\r\n",
 
 static void sx12xx_transmit()
 {
+    RADIO_LOCK();
+
     sx12xx_transmit_complete = false;
     sx12xx_receive_active = false;
 
@@ -848,10 +978,18 @@ static void sx12xx_transmit()
 
       yield();
     };
+
+    RADIO_UNLOCK();
 }
 
 static void sx1276_shutdown()
 {
+#if defined(USE_RADIO_TASK)
+  RADIO_LOCK();
+  sx12xx_task_run = false;
+  RADIO_UNLOCK();
+#endif
+
   LMIC_shutdown();
 
   SPI.end();
@@ -860,6 +998,12 @@ static void sx1276_shutdown()
 #if defined(USE_BASICMAC)
 static void sx1262_shutdown()
 {
+#if defined(USE_RADIO_TASK)
+  RADIO_LOCK();
+  sx12xx_task_run = false;
+  RADIO_UNLOCK();
+#endif
+
   os_init (nullptr);
   sx126x_ll_ops.radio_sleep();
   delay(1);
@@ -893,6 +1037,26 @@ static void sx12xx_rx_func(osjob_t* job) {
   // SX1276 is in SLEEP after IRQ handler, Force it to enter RX mode
   sx12xx_receive_active = false;
 
+  if (((sx12xx_rxq_head + 1) & SX12XX_RXQ_MASK) == sx12xx_rxq_tail) {
+    /* main loop has not taken the earlier frames yet */
+    sx12xx_receive_complete = false;
+    sx12xx_rxq_dropped++;
+    return;
+  }
+  sx12xx_rx_frame_t *rxf = &sx12xx_rxq[sx12xx_rxq_head];
+  byte *rxb = rxf->data;
+  rxf->rssi = LMIC.rssi;
+  /* LMIC.snr is only updated by LoRa receptions, 0 means unknown */
+  rxf->snr  = (LMIC.protocol && LMIC.protocol->modulation_type == RF_MODULATION_TYPE_LORA ?
+               LMIC.snr : 0);
+  rxf->crc  = 0;
+#if defined(USE_BASICMAC)
+  /* the IRQ handler stamped the end of the frame, this may run much later */
+  rxf->ms   = millis() - osticks2ms(os_getTime() - LMIC.rxtime);
+#else
+  rxf->ms   = millis();
+#endif
+
   /* FANET (LoRa) LMIC IRQ handler may deliver empty packets here when CRC is invalid. */
   if (LMIC.dataLen == 0) {
     sx12xx_receive_complete = false;
@@ -907,22 +1071,22 @@ static void sx12xx_rx_func(osjob_t* job) {
       // examine 2 later bytes in the sync word to identify the protocol
       // - that was 4 bytes before Manchester decoding
       if (LMIC.frame[0]==FLR_ID_BYTE_1 && LMIC.frame[1]==FLR_ID_BYTE_2) {
-          RF_last_protocol = RF_PROTOCOL_LATEST;
+          rxf->protocol = RF_PROTOCOL_LATEST;
           crc_type = RF_CHECKSUM_TYPE_CCITT_FFFF;
       } else if (LMIC.frame[0]==ADSL_ID_BYTE_1 && LMIC.frame[1]==ADSL_ID_BYTE_2) {
-          RF_last_protocol = RF_PROTOCOL_ADSL;
+          rxf->protocol = RF_PROTOCOL_ADSL;
           crc_type = RF_CHECKSUM_TYPE_CRC_MODES;
           size -= 2;        // packet 3 bytes shorter but CRC one byte longer than Legacy
       } else {
-          RF_last_protocol = RF_PROTOCOL_NONE;
+          rxf->protocol = RF_PROTOCOL_NONE;
           sx12xx_receive_complete = false;
 //Serial.printf("Unidentified packet protocol 0x%02x 0x%02x\r\n", LMIC.frame[0], LMIC.frame[1]);
           return;
       }
   }
 
-  if (size > sizeof(RxBuffer))
-      size = sizeof(RxBuffer);
+  if (size > sizeof(rxf->data))
+      size = sizeof(rxf->data);
 
 //Serial.print("size=");
 //Serial.println(size);
@@ -937,7 +1101,7 @@ static void sx12xx_rx_func(osjob_t* job) {
       // shift the payload bits as needed
       byte *p = &LMIC.frame[2];
       byte *q = &LMIC.frame[3];
-      byte *r = &RxBuffer[0];
+      byte *r = &rxb[0];
       for (u1_t i=0; i < size; i++) {
           *r++ = (*p << 7) | (*q >> 1);
           ++p;
@@ -947,12 +1111,12 @@ static void sx12xx_rx_func(osjob_t* job) {
       // single protocol, no bit-shifting needed, just copy by bytes
       size -= offset;
       for (u1_t i=0; i < size; i++) {
-         RxBuffer[i] = LMIC.frame[offset+i];
+         rxb[i] = LMIC.frame[offset+i];
       }
-      RF_last_protocol = current_RX_protocol;
+      rxf->protocol = current_RX_protocol;
   }
 
-//Serial.println(Bin2Hex((byte *) RxBuffer, size));
+//Serial.println(Bin2Hex((byte *) rxb, size));
 
   // now can compute and check the CRC
 
@@ -1004,19 +1168,19 @@ static void sx12xx_rx_func(osjob_t* job) {
       case RF_CHECKSUM_TYPE_NONE:
         break;
       case RF_CHECKSUM_TYPE_CRC8_107:
-        update_crc8(&crc8, (u1_t)(RxBuffer[i]));
+        update_crc8(&crc8, (u1_t)(rxb[i]));
         break;
       case RF_CHECKSUM_TYPE_CCITT_FFFF:    // includes FLR packet in FLR_ADSL dual mode
       case RF_CHECKSUM_TYPE_CCITT_0000:
       default:
-        crc16 = update_crc_ccitt(crc16, (u1_t)(RxBuffer[i]));
+        crc16 = update_crc_ccitt(crc16, (u1_t)(rxb[i]));
         break;
       }
 
       switch (LMIC.protocol->whitening)
       {
       case RF_WHITENING_NICERF:
-        RxBuffer[i] ^= pgm_read_byte(&whitening_pattern[i]);
+        rxb[i] ^= pgm_read_byte(&whitening_pattern[i]);
         break;
       case RF_WHITENING_MANCHESTER:
       case RF_WHITENING_NONE:
@@ -1034,25 +1198,25 @@ static void sx12xx_rx_func(osjob_t* job) {
     sx12xx_receive_complete = true;
     break;
   case RF_CHECKSUM_TYPE_GALLAGER:
-    if (LDPC_Check((uint8_t  *) RxBuffer)) {
+    if (LDPC_Check((uint8_t  *) rxb)) {
       sx12xx_receive_complete = false;
     } else {
       sx12xx_receive_complete = true;
     }
     break;
   case RF_CHECKSUM_TYPE_CRC_MODES:    // includes ADSL packet in FLR_ADSL dual mode
-    if (ADSL_Packet::checkPI((uint8_t  *) RxBuffer, size)) {
+    if (ADSL_Packet::checkPI((uint8_t  *) rxb, size)) {
       sx12xx_receive_complete = false;
 Serial.println("ADS-L CRC wrong");
     } else {
-      RF_last_crc = (RxBuffer[size-3] << 16 | RxBuffer[size-2] << 8 | RxBuffer[size-1]);
+      rxf->crc = (rxb[size-3] << 16 | rxb[size-2] << 8 | rxb[size-1]);
       sx12xx_receive_complete = true;
     }
     break;
   case RF_CHECKSUM_TYPE_CRC8_107:
-    pkt_crc8 = RxBuffer[i];
+    pkt_crc8 = rxb[i];
     if (crc8 == pkt_crc8) {
-      RF_last_crc = crc8;
+      rxf->crc = crc8;
       sx12xx_receive_complete = true;
     } else {
       sx12xx_receive_complete = false;
@@ -1061,9 +1225,9 @@ Serial.println("ADS-L CRC wrong");
   case RF_CHECKSUM_TYPE_CCITT_FFFF:    // includes FLR packet in FLR_ADSL dual mode
   case RF_CHECKSUM_TYPE_CCITT_0000:
   default:
-    pkt_crc16 = (RxBuffer[size-2] << 8 | RxBuffer[size-1]);
+    pkt_crc16 = (rxb[size-2] << 8 | rxb[size-1]);
     if (crc16 == pkt_crc16) {
-      RF_last_crc = crc16;
+      rxf->crc = crc16;
       sx12xx_receive_complete = true;
     } else {
       sx12xx_receive_complete = false;
@@ -1075,7 +1239,7 @@ Serial.println("FLR CRC wrong");
 /*
 if (sx12xx_receive_complete && settings->debug_flags) {
 uint8_t protocol = LMIC.protocol->type;
-if (rx_flr_adsl)  protocol = RF_last_protocol;
+if (rx_flr_adsl)  protocol = rxf->protocol;
 Serial.printf("RX in prot %d, time slot %d, sec %d(%d) + %d ms\r\n",
     protocol, RF_current_slot, RF_time, (RF_time & 0x0F), millis()-ref_time_ms);
 }
@@ -2355,10 +2519,42 @@ byte RF_setup(void)
   return RF_IC_NONE;
 }
 
+/*
+ * In the hopping bands (US, AU) the channel for each second and slot,
+ * for both FLARM and OGN hopping, is computed for a whole 16-second
+ * window at once, and then just looked up in each time slot.
+ * Single-channel and EU plans are cheap enough to compute directly.
+ */
+static uint8_t  hop_chan[2][16][2];     // [OGN][second][slot]
+static uint32_t hop_window   = 0;       // first second of the window
+static uint8_t  hop_plan     = RF_BAND_AUTO;
+static uint8_t  hop_channels = 0;       // 0 = table not filled yet
+
+static uint8_t RF_Hop_Channel(uint32_t Time, uint8_t Slot, uint8_t OGN)
+{
+    if (RF_FreqPlan.Plan < RF_BAND_US || RF_FreqPlan.Channels <= 1)
+        return RF_FreqPlan.getChannel(Time, Slot, OGN);
+
+    uint32_t window = Time & ~((uint32_t) 0x0F);
+    if (window != hop_window || RF_FreqPlan.Plan != hop_plan
+                             || RF_FreqPlan.Channels != hop_channels) {
+        for (uint8_t sec=0; sec<16; sec++) {
+            for (uint8_t slot=0; slot<2; slot++) {
+                hop_chan[0][sec][slot] = RF_FreqPlan.getChannel(window+sec, slot, 0);
+                hop_chan[1][sec][slot] = RF_FreqPlan.getChannel(window+sec, slot, 1);
+            }
+        }
+        hop_window   = window;
+        hop_plan     = RF_FreqPlan.Plan;
+        hop_channels = RF_FreqPlan.Channels;
+    }
+    return hop_chan[OGN ? 1 : 0][Time & 0x0F][Slot & 1];
+}
+
 void RF_chip_channel(uint8_t protocol)
 {
     uint8_t OGN = useOGNfreq(protocol);
-    RF_current_chan = RF_FreqPlan.getChannel((time_t)RF_time, RF_current_slot, OGN);
+    RF_current_chan = RF_Hop_Channel((uint32_t) RF_time, RF_current_slot, OGN);
     if (rf_chip)
         rf_chip->channel(RF_current_chan);
 }
@@ -2463,7 +2659,7 @@ void RF_SetChannel(void)
   }
 
   uint8_t OGN = useOGNfreq(settings->rf_protocol);
-  uint8_t chan = RF_FreqPlan.getChannel(Time, Slot, OGN);
+  uint8_t chan = RF_Hop_Channel((uint32_t) Time, Slot, OGN);
 
 #if DEBUG
   int("Plan: "); Serial.println(RF_FreqPlan.Plan);
@@ -3024,6 +3220,9 @@ bool RF_Receive(void)
   bool rval = false;
 
   if (RF_ready && rf_chip) {
+    /* radios that know when the packet actually arrived overwrite these */
+    RF_last_rx_ms = millis();
+    RF_last_snr = 0;
     rval = rf_chip->receive();
   }
 
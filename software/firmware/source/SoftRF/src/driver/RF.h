@@ -158,11 +158,15 @@ extern const char *Protocol_ID[];
 extern const char *dual_protocol_lbl[];
 extern uint32_t RF_last_crc;
 extern int8_t RF_last_rssi;
+extern int8_t RF_last_snr;
+extern uint32_t RF_last_rx_ms;
 extern int8_t which_rx_try;
 extern uint8_t RF_last_protocol;
 
 extern uint32_t rx_packets_counter, tx_packets_counter;
 
+#define RF_RX_BATCH   3    /* most packets parsed in one pass of the main loop */
+
 /* #define TIMETEST */
 #ifdef TIMETEST
 void increment_fake_time(void);
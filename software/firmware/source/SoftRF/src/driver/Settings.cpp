@@ -133,6 +133,7 @@ static void init_stgdesc()
   stgdesc[STG_EXTSSID]    = { "ssid",       settings->ssid,        esp_only(sizeof(settings->ssid)) };
   stgdesc[STG_PSK]        = { "psk",        settings->psk,         esp_only(sizeof(settings->psk)) };
   stgdesc[STG_HOST_IP]    = { "host_ip",    settings->host_ip,     esp_only(sizeof(settings->host_ip)) };
+  stgdesc[STG_BRIDGE_IP]  = { "bridge_ip",  settings->bridge_ip,   esp_only(sizeof(settings->bridge_ip)) };
   stgdesc[STG_TCPMODE]    = { "tcpmode",    (char*)&settings->tcpmode,    esp_only(STG_UINT1) };
   stgdesc[STG_TCPPORT]    = { "tcpport",    (char*)&settings->tcpport,    esp_only(STG_UINT1) };
   stgdesc[STG_BLUETOOTH]  = { "bluetooth",  (char*)&settings->bluetooth,  STG_UINT1 };
@@ -226,6 +227,7 @@ static void init_stgdesc()
   stgcomment[STG_VOLUME]     = "0=off 1=low 2=full 3=ext";
   stgcomment[STG_TCPMODE]    = "0=server 1=client";
   stgcomment[STG_TCPPORT]    = "if client, 0=2000 1=8880";
+  stgcomment[STG_BRIDGE_IP]  = "IP of a SoftRF in bridge mode, empty=off";
   stgcomment[STG_BLUETOOTH]  = "0=off 1=classic 2=BLE";
   stgcomment[STG_BAUD_RATE]  = "0=default(38) 2=9600 3=19200 4=38400 ...";
   stgcomment[STG_NMEA_OUT]   = destinations;
@@ -348,6 +350,7 @@ static void copy_eeprom_settings()
     strcpy(settings->ssid,settingb->ssid);
     strcpy(settings->psk,settingb->psk);
     strcpy(settings->host_ip,settingb->host_ip);
+    settings->bridge_ip[0] = '\0';
     settings->debug_flags = settingb->debug_flags;
 #endif
 #if defined(USE_EPAPER)
@@ -867,6 +870,7 @@ void Settings_defaults(bool keepsome)
     settings->tcpmode = TCP_MODE_SERVER;
     strncpy(settings->host_ip, NMEA_TCP_IP, sizeof(settings->host_ip)-1);
     settings->host_ip[sizeof(settings->host_ip)-1] = '\0';
+    settings->bridge_ip[0] = '\0';    // not listening for bridged packets
     settings->tcpport = 0;   // 2000
     settings->alt_udp    = false;
 
@@ -173,6 +173,7 @@ enum stgidx {
     STG_EXTSSID,
     STG_PSK,
     STG_HOST_IP,
+    STG_BRIDGE_IP,
     STG_TCPMODE,
     STG_TCPPORT,
 //#endif
@@ -403,6 +404,7 @@ typedef struct Settings {
     char    ssid[20];      // if connecting to external network
     char    psk[20];
     char    host_ip[16];
+    char    bridge_ip[16];  // accept bridged packets from here, if not empty
     uint8_t  alt_udp;     // if 1 then use 10111 instead of 10110
     uint8_t  tcpmode;
     uint8_t  tcpport;
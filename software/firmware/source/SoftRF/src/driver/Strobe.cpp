@@ -21,6 +21,7 @@
 
 #if defined(EXCLUDE_STROBE)
 void  Strobe_setup()       {}
+void  Strobe_Notify(int8_t level) {}
 void  Strobe_loop()        {}
 void  Strobe_fini()        {}
 #else
@@ -74,14 +75,12 @@ void Strobe_setup(void)
   StrobeState = false;
   StrobeTimeMarker = 0;
 
-  // one double flash to show it is working
+  // one double flash to show it is working, Strobe_loop() completes it
+  StrobeFlashes = 2;
+  StrobeOnMS = 50;
   digitalWrite(StrobePin, HIGH);
-  delay(50);
-  digitalWrite(StrobePin, LOW);
-  delay(50);
-  digitalWrite(StrobePin, HIGH);
-  delay(50);
-  digitalWrite(StrobePin, LOW);
+  StrobeState = true;
+  StrobeTimeMarker = millis();
 }
 
 void Strobe_Start()
@@ -143,6 +142,24 @@ void Strobe_Continue()
     }
 }
 
+/*
+ * Called when a new alarm is annunciated: start the alarm pattern right
+ * away rather than after the current pause, unless already flashing for
+ * an alarm at least as high.
+ */
+void Strobe_Notify(int8_t level)
+{
+  if (settings->strobe == STROBE_OFF || StrobePin == SOC_UNUSED_PIN)
+      return;
+  if (! alarm_ahead && settings->strobe != STROBE_ALARM)
+      return;
+  if (StrobeTimeMarker != 0 && alarm_level >= level)
+      return;
+  alarm_level = level;
+  StrobeTimeMarker = 0;
+  Strobe_Start();
+}
+
 void Strobe_loop(void)
 {
   if (settings->strobe == STROBE_OFF)
@@ -38,6 +38,7 @@
 #define STROBE_INITIAL_RUN         9
 
 void Strobe_setup(void);
+void Strobe_Notify(int8_t);
 void Strobe_loop(void);
 void Strobe_fini(void);
 
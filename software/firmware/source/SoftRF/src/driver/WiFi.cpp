@@ -168,25 +168,44 @@ bool saveConfig(String *ssid, String *pass)
 } // saveConfig
 #endif
 
-// general UDP receiving (code from SkyView):
-size_t WiFi_Receive_UDP(uint8_t *buf, size_t max_size)
-{
-  int noBytes = Uni_Udp.parsePacket();
-  if ( noBytes ) {
+/*
+ * General UDP receiving, with the frame ring in libraries/UDPRing that is
+ * shared with SkyView:  WiFi_loop() moves all the datagrams waiting in the
+ * network stack into the ring, so that a burst does not overflow the
+ * stack's own small queue while the main loop is busy, and
+ * WiFi_Receive_UDP() hands them out one at a time.
+ */
+#define UDP_INGEST_MAX    16   /* datagrams taken from the stack per pass */
 
-    if (noBytes > max_size) {
-      noBytes = max_size;
+/*
+ * At most UDP_INGEST_MAX per pass, so that a flood cannot stall the loop.
+ * If the ring is full the datagram is counted as dropped.  Whatever was not
+ * read (all of a dropped datagram, the tail of an oversized one) must be
+ * flushed, else on the ESP32 the next parsePacket() returns 0 for good.
+ */
+static void WiFi_Ingest_UDP()
+{
+  for (int n = 0; n < UDP_INGEST_MAX; n++) {
+    int noBytes = Uni_Udp.parsePacket();
+    if (noBytes <= 0)
+      break;
+    uint32_t ip   = (uint32_t) Uni_Udp.remoteIP();
+    uint16_t port = Uni_Udp.remotePort();
+    if (UDP_Ring_Free() == 0) {
+      UDP_Ring_Drop(ip, port, millis());
+    } else {
+      Uni_Udp.read(UDP_Ring_Slot(0), UDP_RING_FRAME_SIZE);
+      UDP_Ring_Commit(ip, port, noBytes, millis());
     }
-
-    // We've received a packet, read the data from it
-    Uni_Udp.read(buf,noBytes); // read the packet into the buffer
-
-    return (size_t) noBytes;
-  } else {
-    return 0;
+    Uni_Udp.flush();
   }
 }
 
+size_t WiFi_Receive_UDP(uint8_t *buf, size_t max_size)
+{
+  return UDP_Ring_Pop(buf, max_size);
+}
+
 #if 0
 // was used only in bridge mode, was called from SoftRF.ino,
 //   - replaced with WiFi_Receive_UDP(buf, MAX_PKT_SIZE)
@@ -209,18 +228,119 @@ size_t Raw_Receive_UDP(uint8_t *buf)
 }
 #endif
 
+/*
+ * In bridge mode the received radio packets are sent to RELAY_DST_PORT in
+ * binary, several to a datagram:
+ *
+ *   'S' 'B' version count, then for each packet:
+ *   protocol rssi age_lo age_hi size payload[size]
+ *
+ * where age is how many ms before the datagram was sent the packet was
+ * received.  A packet waits at most BRIDGE_LATENCY_MS for others to join
+ * it.  A SoftRF in normal mode with the bridge_ip setting filled in listens
+ * on RELAY_DST_PORT and feeds such packets, if they come from that address,
+ * into its own traffic table, as if it had received them itself.
+ */
+#define BRIDGE_MAGIC0       'S'
+#define BRIDGE_MAGIC1       'B'
+#define BRIDGE_VERSION      1
+#define BRIDGE_HDR_SIZE     4
+#define BRIDGE_FRAME_HDR    5
+#define BRIDGE_MAX_FRAMES   8
+#define BRIDGE_LATENCY_MS   100
+
+static uint8_t  bridge_buf[BRIDGE_HDR_SIZE + BRIDGE_MAX_FRAMES * (BRIDGE_FRAME_HDR + MAX_PKT_SIZE)];
+static size_t   bridge_len = 0;
+static uint8_t  bridge_count = 0;
+static uint16_t bridge_age_at[BRIDGE_MAX_FRAMES];   /* offset of each age field */
+static uint32_t bridge_rx_ms[BRIDGE_MAX_FRAMES];
+
+static void Raw_Flush_UDP()
+{
+    if (bridge_count == 0)
+        return;
+    uint32_t now = millis();
+    bridge_buf[0] = BRIDGE_MAGIC0;
+    bridge_buf[1] = BRIDGE_MAGIC1;
+    bridge_buf[2] = BRIDGE_VERSION;
+    bridge_buf[3] = bridge_count;
+    for (int i=0; i < bridge_count; i++) {
+        uint32_t age = now - bridge_rx_ms[i];
+        if (age > 0xFFFF)
+            age = 0xFFFF;
+        bridge_buf[bridge_age_at[i]]   = (uint8_t) age;
+        bridge_buf[bridge_age_at[i]+1] = (uint8_t) (age >> 8);
+    }
+    SoC->WiFi_transmit_UDP(RELAY_DST_PORT, bridge_buf, bridge_len);
+    bridge_len = 0;
+    bridge_count = 0;
+}
+
 void Raw_Transmit_UDP()
 {
     uint8_t rf_protocol = RF_last_protocol;
        // may differ from settings->rf_protocol in dual-protocol mode
     size_t rx_size = RF_Payload_Size(rf_protocol);
     rx_size = rx_size > sizeof(fo_raw) ? sizeof(fo_raw) : rx_size;
-    String str = Bin2Hex(fo_raw, rx_size);
-    size_t len = str.length();
-    // ASSERT(sizeof(UDPpacketBuffer) > 2 * PKT_SIZE + 1)
-    str.toCharArray(UDPpacketBuffer, sizeof(UDPpacketBuffer));
-    UDPpacketBuffer[len] = '\n';
-    SoC->WiFi_transmit_UDP(RELAY_DST_PORT, (byte *)UDPpacketBuffer, len + 1);
+
+    if (bridge_count >= BRIDGE_MAX_FRAMES)
+        Raw_Flush_UDP();
+    if (bridge_count == 0)
+        bridge_len = BRIDGE_HDR_SIZE;
+
+    uint8_t *p = &bridge_buf[bridge_len];
+    p[0] = rf_protocol;
+    p[1] = (uint8_t) RF_last_rssi;
+    bridge_age_at[bridge_count] = bridge_len + 2;
+    bridge_rx_ms[bridge_count]  = RF_last_rx_ms;
+    p[4] = (uint8_t) rx_size;
+    memcpy(p + BRIDGE_FRAME_HDR, fo_raw, rx_size);
+    bridge_len += BRIDGE_FRAME_HDR + rx_size;
+    ++bridge_count;
+}
+
+/* called from bridge() in every loop */
+void Raw_Loop_UDP()
+{
+    if (bridge_count > 0 && millis() - bridge_rx_ms[0] >= BRIDGE_LATENCY_MS)
+        Raw_Flush_UDP();
+}
+
+/* the receiving side, in normal mode */
+static WiFiUDP Bridge_Udp;
+static bool bridge_udp_ready = false;
+static IPAddress bridge_peer;
+
+static void Bridge_Receive_UDP()
+{
+    while (1) {
+        int size = Bridge_Udp.parsePacket();
+        if (size <= 0)
+            return;
+        if (size > (int) sizeof(bridge_buf))
+            size = sizeof(bridge_buf);
+        Bridge_Udp.read(bridge_buf, size);
+        Bridge_Udp.flush();     // any oversized tail, see WiFi_Ingest_UDP()
+        if (Bridge_Udp.remoteIP() != bridge_peer)
+            continue;
+        if (! isValidFix())
+            continue;
+        if (size < BRIDGE_HDR_SIZE
+         || bridge_buf[0] != BRIDGE_MAGIC0 || bridge_buf[1] != BRIDGE_MAGIC1
+         || bridge_buf[2] != BRIDGE_VERSION)
+            continue;
+        int n = bridge_buf[3];
+        int i = BRIDGE_HDR_SIZE;
+        while (n-- > 0 && i + BRIDGE_FRAME_HDR <= size) {
+            uint8_t *p = &bridge_buf[i];
+            int len = p[4];
+            if (i + BRIDGE_FRAME_HDR + len > size)
+                break;
+            ParseData_Bridged(p[0], (int8_t) p[1], (uint16_t) (p[2] | (p[3] << 8)),
+                              p + BRIDGE_FRAME_HDR, len);
+            i += BRIDGE_FRAME_HDR + len;
+        }
+    }
 }
 
 // Extend DHCP Lease time - check and set
@@ -396,6 +516,15 @@ void WiFi_setup()
       udp_is_ready = 1;
   }
 
+  // for packets forwarded by a bridge, only if asked for, and only from there
+  if (settings->mode == SOFTRF_MODE_NORMAL && settings->bridge_ip[0] != '\0'
+        && bridge_peer.fromString(settings->bridge_ip)
+        && Bridge_Udp.begin(RELAY_DST_PORT)) {
+      Serial.print(F("Accepting bridged packets from: "));
+      Serial.println(settings->bridge_ip);
+      bridge_udp_ready = true;
+  }
+
 #if defined(POWER_SAVING_WIFI_TIMEOUT)
   WiFi_No_Clients_Time_ms = millis();
 #endif
@@ -403,6 +532,12 @@ void WiFi_setup()
 
 void WiFi_loop()
 {
+  if (udp_is_ready)
+      WiFi_Ingest_UDP();
+
+  if (bridge_udp_ready)
+      Bridge_Receive_UDP();
+
 #if defined(USE_DNS_SERVER)
   if (dns_active) {
     dnsServer.processNextRequest();
@@ -432,6 +567,10 @@ void WiFi_fini()
 {
   udp_is_ready = 0;
   Uni_Udp.stop();
+  if (bridge_udp_ready) {
+      Bridge_Udp.stop();
+      bridge_udp_ready = false;
+  }
 
   WiFi.mode(WIFI_OFF);
 }
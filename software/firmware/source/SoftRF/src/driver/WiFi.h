@@ -24,6 +24,9 @@
 #if defined(ARDUINO) && !defined(EXCLUDE_WIFI)
 #include <WiFiUdp.h>
 #endif
+#if !defined(EXCLUDE_WIFI)
+#include <UDPRing.h>
+#endif
 
 #define HOSTNAME            SOFTRF_IDENT
 #define UDP_PACKET_BUFSIZE  256
@@ -46,6 +49,7 @@ void WiFi_setup(void);
 void WiFi_loop(void);
 size_t WiFi_Receive_UDP(uint8_t *buf, size_t max_size);
 void Raw_Transmit_UDP(void);
+void Raw_Loop_UDP(void);
 void WiFi_fini(void);
 
 extern String host_name;
@@ -445,7 +445,10 @@ struct rst_info {
 //#define USE_BLE_MIDI
 //#define USE_GDL90_MSL
 #define USE_OGN_ENCRYPTION
-#define USE_EGM96           /* geoid lookup table in SPIFFS file */
+#define USE_EGM96           /* built-in EGM96 geoid grid, 16 KB of flash */
+#define ENABLE_PROFILER     /* main loop stage timing: $PSRFP and /profile web page */
+#define USE_UBX_PVT         /* u-blox 7+: binary NAV-PVT fix instead of GGA & RMC */
+//#define USE_RADIO_TASK      /* sx12xx reception serviced by a task on the other core */
 
 //#define EXCLUDE_GNSS_UBLOX    /* Neo-6/7/8 */
 #define ENABLE_UBLOX_RFS        /* revert factory settings (when necessary)  */
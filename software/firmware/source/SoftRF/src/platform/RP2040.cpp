@@ -33,8 +33,10 @@
 #include "../protocol/data/GDL90.h"
 #include "../protocol/data/D1090.h"
 #include "../protocol/data/JSON.h"
+#include "../TrafficHelper.h"
 
 #include <hardware/watchdog.h>
+#include <hardware/sync.h>
 
 #if !defined(ARDUINO_ARCH_MBED)
 #include "pico/unique_id.h"
@@ -1055,6 +1057,9 @@ void setup1() {
 void loop1()
 {
   USBHost.task();
+#if defined(USE_CORE1_DECODE)
+  ParseData_Worker();
+#endif /* USE_CORE1_DECODE */
 }
 
 //--------------------------------------------------------------------+
@@ -1181,6 +1186,17 @@ void tuh_umount_cb(uint8_t daddr)
 
 #endif /* USE_USB_HOST */
 
+#if defined(USE_CORE1_DECODE) && !defined(USE_USB_HOST)
+/* core1 does nothing but decode packets posted by ParseData_Post() */
+void setup1() { }
+
+void loop1()
+{
+  __wfe();
+  ParseData_Worker();
+}
+#endif /* USE_CORE1_DECODE */
+
 IODev_ops_t RP2040_USBSerial_ops = {
   "RP2040 USB ACM",
   RP2040_USB_setup,
@@ -257,6 +257,9 @@ struct rst_info {
 #if defined(USE_TINYUSB)
 //#define USE_USB_HOST
 #endif /* USE_TINYUSB */
+#if !defined(ARDUINO_ARCH_MBED)
+//#define USE_CORE1_DECODE         /* Latest packets decoded on the second core */
+#endif /* ARDUINO_ARCH_MBED */
 
 #if !defined(ARDUINO_ARCH_MBED)
 #define USE_BOOTSEL_BUTTON
@@ -115,6 +115,7 @@ extern const char *Hardware_Rev[];
 #define EXCLUDE_LK8EX1
 
 #define USE_NMEALIB
+#define USE_EGM96
 //#define USE_EPAPER
 
 #define TAKE_CARE_OF_MILLIS_ROLLOVER
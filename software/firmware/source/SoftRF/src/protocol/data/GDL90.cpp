@@ -625,46 +625,58 @@ Serial.printf("GDL90>%x %s, %f, %f, %.0f\r\n",
   AddTraffic(&fo, (char *) tp->callsign);
 }
 
-// Accummulate bytes in traffic data message - ignore all others
-#define WAIT_FOR_FLAG 128
-#define GOT_FLAG      129
+#define GDL90_MAX_FRAME ((int) (1 + sizeof(GDL90_Msg_Traffic_t) + 2))
+
+// Check the FCS of an unescaped frame (message ID in buf[0]) and hand the
+// message body, in place, to the decoder for its type
+static void GDL90_dispatch(char* buf, int n)
+{
+    if (buf[0] != GDL90_TRAFFIC_MSG_ID)   // only traffic is used
+        return;
+    if (n != GDL90_MAX_FRAME) {
+        Serial.println(F("GDL90 msg rcvd has wrong length"));
+        return;
+    }
+
+    uint16_t fcs = GDL90_calcFCS((uint8_t) buf[0], (uint8_t*)(buf+1), n-3);
+    if ((uint8_t) buf[n-2] == (fcs & 0xFF) && (uint8_t) buf[n-1] == (fcs >> 8)) {
+        process_traffic_message(buf+1);
+    } else {
+        Serial.println(F("GDL90 msg rcvd has invalid checksum"));
+    }
+    NMEA_bridge_sent = true;   // not really sent, but substantial processing
+}
+
+// Accumulate the bytes of a traffic message, unescaping them in place into
+// buf[] (message ID first) - ignore all other message types.
+// n is the byte count, plus ESCAPE_PENDING between 0x7D and the byte it escapes.
+#define WAIT_FOR_FLAG  128
+#define ESCAPE_PENDING 256
 void GDL90_bridge_buf(char c, char* buf, int& n)
 {
-    if (n == WAIT_FOR_FLAG) {
-        if (c == 0x7E)           // wait for a start flag
-            n = GOT_FLAG;
-    } else if (n == GOT_FLAG) {
-        if (c == GDL90_TRAFFIC_MSG_ID)
-            n = 0;               // ready to receive message bytes
-        else if (c != 0x7E)
-            n = WAIT_FOR_FLAG;   // ignore non-traffic messages
-        // else two flags in a row, leave state = GOT_FLAG
-    } else if (n > 31) {
-        if (n > (30+32)) {
-            n = WAIT_FOR_FLAG;   // guard against buffer overrun
-        } else {
-            c ^= 0x20;           // finish escape sequence
-            n -= 32;
-            buf[n++] = c;
-        }
+    if (c == 0x7E) {                // start or stop flag
+        if (n > 0 && n < WAIT_FOR_FLAG)
+            GDL90_dispatch(buf, n);
+        n = 0;                      // a stop flag may also start the next message
+        return;
+    }
+    if (n == WAIT_FOR_FLAG)         // skipping the rest of this message
+        return;
+    if (n >= ESCAPE_PENDING) {
+        n -= ESCAPE_PENDING;
+        c ^= 0x20;                  // finish escape sequence
     } else if (c == 0x7D) {
-        n += 32;                 // start escape sequence
-    } else if (c == 0x7E) {      // Start or stop flag
-        if (n == 29) {           // length of a valid traffic message + checksum
-            uint16_t fcs = GDL90_calcFCS(GDL90_TRAFFIC_MSG_ID, (uint8_t*)buf, 27);
-            uint8_t fcs_lsb = fcs        & 0xFF;
-            uint8_t fcs_msb = (fcs >> 8) & 0xFF;
-            if (buf[28]==fcs_msb && buf[27]==fcs_lsb) {  // valid checksum
-                process_traffic_message(buf);
-            } else {
-                Serial.println(F("GDL90 msg rcvd has invalid checksum"));
-            }
-            NMEA_bridge_sent = true;   // not really sent, but substantial processing
-        } else {
-            Serial.println(F("GDL90 msg rcvd has wrong length"));
-        }
-        n = WAIT_FOR_FLAG;
-    } else {
-       buf[n++] = c;
+        n += ESCAPE_PENDING;        // start escape sequence
+        return;
+    }
+    if (n == 0 && c != GDL90_TRAFFIC_MSG_ID) {
+        n = WAIT_FOR_FLAG;          // ignore non-traffic messages
+        return;
+    }
+    if (n >= GDL90_MAX_FRAME) {
+        n = WAIT_FOR_FLAG;          // guard against buffer overrun
+        Serial.println(F("GDL90 msg rcvd has wrong length"));
+        return;
     }
+    buf[n++] = c;
 }
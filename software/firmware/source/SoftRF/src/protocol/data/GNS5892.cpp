@@ -21,6 +21,7 @@
 #include "../../driver/GNSS.h"
 #include "../../driver/Filesys.h"
 #include "../../TrafficHelper.h"
+#include "../../Wind.h"
 #include "../radio/Legacy.h"
 #include "GNS5892.h"
 #include "NMEA.h"
@@ -832,6 +833,7 @@ static void update_traffic_position(int index)
     cip->timestamp    = OurTime;
     cip->positiontime = OurTime;
     cip->gnsstime_ms  = millis();
+    track_that(cip);
     Traffic_Update(cip);
 
 /* also send data out via NMEA */
@@ -57,34 +57,121 @@ void MAVLinkTimeSync()
   }
 }
 
-void MAVLinkShareTraffic()
+/*
+ * The telemetry link runs at 57600 baud, and an ADSB_VEHICLE message takes
+ * 46 bytes on the wire (MAVLink 1.0), so only a limited number of targets
+ * can be sent each second without crowding the link.  Each target is due
+ * at an interval that depends on its alarm level and distance, targets that
+ * have not moved noticeably since they were last sent wait longer, and the
+ * due targets are sent in order of priority until the byte budget for this
+ * call is used up.  The rest wait for the next call.
+ */
+#define MAV_ADSB_MSG_BYTES    (MAVLINK_MSG_ID_ADSB_VEHICLE_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES)
+#define MAV_TRAFFIC_BUDGET    1800    /* bytes per second, about 1/3 of the link */
+#define MAV_TRAFFIC_BURST     (2 * MAV_TRAFFIC_BUDGET)
+#define MAV_MAX_INTERVAL      10000   /* ms, re-send even if unchanged */
+
+typedef struct mav_sent_struct {
+    uint32_t  addr;
+    uint32_t  time_ms;
+    float     latitude;
+    float     longitude;
+    float     altitude;
+    float     course;
+} mav_sent_t;
+
+static mav_sent_t mav_sent[MAX_TRACKING_OBJECTS];
+static int32_t  mav_budget = 0;
+static uint32_t mav_budget_ms = 0;
+
+static uint32_t mav_interval(container_t *fop)
 {
-    time_t this_moment = OurTime;
+    if (fop->alarm_level > ALARM_LEVEL_NONE)   return 1000;
+    if (fop->distance < 2000)                  return 2000;
+    if (fop->distance < 10000)                 return 4000;
+    return 8000;
+}
 
-    for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
-      if (Container[i].addr && (this_moment - Container[i].timestamp) <= settings->expire) {
-
-        char hexbuf[8];
-        char callsign[8+1];
-
-        snprintf(hexbuf, sizeof(hexbuf), "%06X", Container[i].addr);
-        memcpy(callsign, GDL90_CallSign_Prefix[Container[i].protocol],
-          strlen(GDL90_CallSign_Prefix[Container[i].protocol]));
-        memcpy(callsign + strlen(GDL90_CallSign_Prefix[Container[i].protocol]),
-          hexbuf, strlen(hexbuf) + 1);
-
-        write_mavlink(  Container[i].addr,
-                        Container[i].latitude,
-                        Container[i].longitude,
-                        Container[i].altitude,
-                        Container[i].course,
-                        Container[i].speed * _GPS_MPS_PER_KNOT, /* m/s */
-                        Container[i].vs / (_GPS_FEET_PER_METER * 60.0), /* m/s */
-                        (settings->band == RF_BAND_US ? 1200 : 7000),
-                        callsign,
-                        AT_TO_GDL90(Container[i].aircraft_type));
+/* has the target moved enough since last sent to be worth sending again? */
+static bool mav_changed(container_t *fop, mav_sent_t *sp)
+{
+    if (fabs(fop->altitude - sp->altitude) > 10.0)       return true;
+    float dc = fabs(fop->course - sp->course);
+    if (dc > 5.0 && dc < 355.0)                          return true;
+    /* about 20 meters, ignoring the cos(latitude) factor */
+    if (fabs(fop->latitude  - sp->latitude)  > 0.0002)   return true;
+    if (fabs(fop->longitude - sp->longitude) > 0.0002)   return true;
+    return false;
+}
 
+/* returns 0 if not due, otherwise a priority - higher is more urgent */
+static int mav_priority(int i, uint32_t now)
+{
+    container_t *fop = &Container[i];
+    mav_sent_t *sp = &mav_sent[i];
+    if (sp->addr != fop->addr)      // new target in this slot
+        return (fop->alarm_level + 1) * 100000;
+    uint32_t elapsed = now - sp->time_ms;
+    uint32_t interval = mav_interval(fop);
+    /* an alarm target is refreshed at the alarm rate even if unchanged */
+    if (fop->alarm_level == ALARM_LEVEL_NONE && ! mav_changed(fop, sp))
+        interval = MAV_MAX_INTERVAL;
+    if (elapsed < interval)
+        return 0;
+    int prio = (fop->alarm_level + 1) * 100000 - (int) (fop->distance * 0.1);
+    return (prio > 0 ? prio : 1);
+}
+
+void MAVLinkShareTraffic()
+{
+    time_t this_moment = OurTime;
+    uint32_t now = millis();
+
+    mav_budget += (int32_t) ((now - mav_budget_ms) * MAV_TRAFFIC_BUDGET / 1000);
+    if (mav_budget > MAV_TRAFFIC_BURST)
+        mav_budget = MAV_TRAFFIC_BURST;
+    mav_budget_ms = now;
+
+    while (mav_budget >= MAV_ADSB_MSG_BYTES) {
+
+      int best = -1;
+      int bestprio = 0;
+      for (int i=0; i < MAX_TRACKING_OBJECTS; i++) {
+        if (Container[i].addr && (this_moment - Container[i].timestamp) <= settings->expire) {
+          int prio = mav_priority(i, now);
+          if (prio > bestprio) {
+            bestprio = prio;
+            best = i;
+          }
+        }
       }
+      if (best < 0)
+        break;
+
+      container_t *fop = &Container[best];
+      char callsign[8+1];
+      snprintf(callsign, sizeof(callsign), "%s%06X",
+               GDL90_CallSign_Prefix[fop->protocol], fop->addr);
+
+      write_mavlink(  fop->addr,
+                      fop->latitude,
+                      fop->longitude,
+                      fop->altitude,
+                      fop->course,
+                      fop->speed * _GPS_MPS_PER_KNOT, /* m/s */
+                      fop->vs / (_GPS_FEET_PER_METER * 60.0), /* m/s */
+                      (settings->band == RF_BAND_US ? 1200 : 7000),
+                      callsign,
+                      AT_TO_GDL90(fop->aircraft_type));
+
+      mav_sent_t *sp = &mav_sent[best];
+      sp->addr      = fop->addr;
+      sp->time_ms   = now;
+      sp->latitude  = fop->latitude;
+      sp->longitude = fop->longitude;
+      sp->altitude  = fop->altitude;
+      sp->course    = fop->course;
+      mav_budget -= MAV_ADSB_MSG_BYTES;
     }
 }
 
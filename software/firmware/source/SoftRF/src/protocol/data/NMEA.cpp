@@ -46,6 +46,7 @@
 #include "../../driver/Filesys.h"
 #include "IGC.h"
 #include "../../TrafficHelper.h"
+#include "../../system/Profiler.h"
 
 #if defined(USE_SD_CARD)
 #include <SD.h>
@@ -1245,6 +1246,48 @@ void NMEA_Export()
               1000+(int)Battery_charge());
           NMEAOutC(NMEA_S_LK8);
       }
+#if defined(ESP32) && !defined(CONFIG_IDF_TARGET_ESP32S2)
+      // BLE output queue statistics: sentences sent,dropped per class
+      if (settings->bluetooth == BLUETOOTH_LE_HM10_SERIAL) {
+          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+              PSTR("$PSRFQ,%u,%u,%u,%u,%u,%u,%u,%u*"),
+              BLE_queue_stats.sent[BLEQ_ALARM],   BLE_queue_stats.dropped[BLEQ_ALARM],
+              BLE_queue_stats.sent[BLEQ_TRAFFIC], BLE_queue_stats.dropped[BLEQ_TRAFFIC],
+              BLE_queue_stats.sent[BLEQ_GNSS],    BLE_queue_stats.dropped[BLEQ_GNSS],
+              BLE_queue_stats.sent[BLEQ_OTHER],   BLE_queue_stats.dropped[BLEQ_OTHER]);
+          NMEAOutC(NMEA_D);
+      }
+#endif
+      if (settings->relay != RELAY_OFF) {
+          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+              PSTR("$PSRFY,%u,%u,%u*"),
+              relay_stats.relayed, relay_stats.suppressed, relay_stats.dropped);
+          NMEAOutC(NMEA_D);
+      }
+#if !defined(EXCLUDE_WIFI)
+      // UDP input statistics, per source address
+      for (int i = 0; udp_is_ready && i < UDP_MAX_SOURCES; i++) {
+          udp_source_t *sp = &udp_sources[i];
+          if (sp->packets + sp->dropped == 0)
+              continue;
+          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+              PSTR("$PSRFU,%s,%u,%u,%u,%u,%u*"),
+              IPAddress(sp->ip).toString().c_str(), sp->port,
+              sp->packets, UDP_Source_Rate(sp, millis()), sp->dropped, sp->truncated);
+          NMEAOutC(NMEA_D);
+      }
+#endif
+      if (settings->power_save & POWER_SAVE_GOVERNOR) {
+          snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+              PSTR("$PSRFW,%d,%d,%d,%u,%u,%u,%u*"),
+              power_profile, 1, (int) Power_mAh(),
+              power_profile_secs[POWER_PROFILE_GROUND], power_profile_secs[POWER_PROFILE_SPARSE],
+              power_profile_secs[POWER_PROFILE_DENSE],  power_profile_secs[POWER_PROFILE_LOWBAT]);
+          NMEAOutC(NMEA_D);
+      }
+#if defined(ENABLE_PROFILER)
+      Profiler_report();
+#endif
     }
 #endif /* EXCLUDE_SOFTRF_HEARTBEAT */
 
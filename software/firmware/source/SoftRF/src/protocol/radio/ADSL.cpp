@@ -150,7 +150,7 @@ bool adsl_decode(void *pkt, container_t *this_aircraft, ufo_t *fop) {
 
   fop->addr_type = r.getAddrTypeOGN();
   fop->timestamp = (uint32_t) RF_time;      // this_aircraft->timestamp;
-  fop->gnsstime_ms = millis();
+  fop->gnsstime_ms = RF_last_rx_ms;
 
   fop->airborne = (r.FlightState != 1);    // >>> ads-l.h lacks a method to read the "flight state" field?
 
@@ -235,7 +235,7 @@ bool fanet_decode(void *fanet_pkt, container_t *this_aircraft, ufo_t *fop) {
     fop->protocol = RF_PROTOCOL_FANET;
     fop->addr_type = ADDR_TYPE_FLARM;    // i.e., device - was ADDR_TYPE_FANET
     fop->timestamp = this_aircraft->timestamp;
-    fop->gnsstime_ms = millis();
+    fop->gnsstime_ms = RF_last_rx_ms;
 
 #if defined(FANET_DEPRECATED)
     fop->latitude  = payload_compressed2coord(pkt->latitude, this_aircraft->latitude);
@@ -247,6 +247,32 @@ void make_key(uint32_t key[4], uint32_t timestamp, uint32_t address) {
     }
 }
 
+/*
+ * The key only depends on the address and on (timestamp >> 6), so for
+ * any one aircraft it stays the same for 64 seconds.  Keep the keys of
+ * the last few addresses seen, for both encoding (ownship and relayed)
+ * and decoding.  Only used from the main loop (core0).
+ */
+#define KEY_CACHE_SIZE  8       /* power of 2 */
+
+static struct {
+    uint32_t epoch;             /* (timestamp >> 6) + 1, 0 = empty */
+    uint32_t address;
+    uint32_t key[4];
+} key_cache[KEY_CACHE_SIZE];
+
+static const uint32_t *cached_key(uint32_t timestamp, uint32_t address)
+{
+    uint32_t epoch = (timestamp >> 6) + 1;
+    uint8_t ndx = (address ^ (address >> 8) ^ (address >> 16)) & (KEY_CACHE_SIZE-1);
+    if (key_cache[ndx].epoch != epoch || key_cache[ndx].address != address) {
+        make_key(key_cache[ndx].key, timestamp, address);
+        key_cache[ndx].epoch   = epoch;
+        key_cache[ndx].address = address;
+    }
+    return key_cache[ndx].key;
+}
+
 // lookup the divisor for latitude for new protocol
 int londiv(int ilat)
 {
@@ -324,7 +350,7 @@ bool latest_decode(void* buffer, container_t* this_aircraft, ufo_t* fop)
 {
     //uint32_t timestamp = (uint32_t) this_aircraft->timestamp;
     //uint32_t timestamp = (uint32_t) OurTime;
-    uint32_t timestamp = (uint32_t) RF_time;   // incremented in RF.cpp 300 ms after PPS
+    uint32_t timestamp = (uint32_t) fop->timestamp;   // RF_time, from legacy_decode_header()
 
 #if 0
     if (settings->nmea_d || settings->nmea2_d) {
@@ -506,7 +532,14 @@ bool latest_decode(void* buffer, container_t* this_aircraft, ufo_t* fop)
     return true;
 }
 
-bool legacy_decode(void *buffer, container_t *this_aircraft, ufo_t *fop) {
+/*
+ * The plain-text header of the packet, checked against the traffic table
+ * for duplicates, and the time of reception.  This is all of the decoding
+ * that depends on the current state of the main loop (Container[] and the
+ * RF_last_* metadata of the packet), so with USE_CORE1_DECODE it is done
+ * on core0 before the rest of the packet is handed to core1.
+ */
+bool legacy_decode_header(void *buffer, ufo_t *fop) {
 
     legacy_packet_t *pkt = (legacy_packet_t *) buffer;
 
@@ -554,7 +587,18 @@ bool legacy_decode(void *buffer, container_t *this_aircraft, ufo_t *fop) {
     //uint32_t timestamp = (uint32_t) OurTime;
     uint32_t timestamp = (uint32_t) RF_time;   // incremented in RF.cpp 300 ms after PPS
     fop->timestamp = timestamp;
-    fop->gnsstime_ms = millis();
+    fop->gnsstime_ms = RF_last_rx_ms;    // when received, not when decoded
+
+    return true;
+}
+
+bool legacy_decode(void *buffer, container_t *this_aircraft, ufo_t *fop) {
+
+    if (! legacy_decode_header(buffer, fop))
+        return false;
+
+    legacy_packet_t *pkt = (legacy_packet_t *) buffer;
+    uint32_t timestamp = (uint32_t) fop->timestamp;
 
     if (pkt->msg_type == 2)
         return latest_decode(buffer, this_aircraft, fop);
@@ -580,11 +624,10 @@ bool legacy_decode(void *buffer, container_t *this_aircraft, ufo_t *fop) {
 
     // decrypt and decode old legacy protocol:
 
-    uint32_t key[4];
     int ndx;
     uint8_t pkt_parity=0;
 
-    make_key(key, timestamp, (pkt->addr << 8) & 0xffffff);
+    const uint32_t *key = cached_key(timestamp, (pkt->addr << 8) & 0xffffff);
     btea((uint32_t *) pkt + 1, -5, key);
 
     for (ndx = 0; ndx < sizeof (legacy_packet_t); ndx++) {
@@ -951,7 +994,6 @@ size_t legacy_encode(void *pkt_buffer, container_t *aircraft)
 
     int ndx;
     uint8_t pkt_parity;
-    uint32_t key[4];
 
     float lat = aircraft->latitude;
     float lon = aircraft->longitude;
@@ -1082,7 +1124,7 @@ size_t legacy_encode(void *pkt_buffer, container_t *aircraft)
 
     //uint32_t timestamp = (uint32_t) aircraft->timestamp;
     uint32_t timestamp = (uint32_t) RF_time;   // incremented in RF.cpp 300 ms after PPS
-    make_key(key, timestamp , (pkt->addr << 8) & 0xffffff);
+    const uint32_t *key = cached_key(timestamp, (pkt->addr << 8) & 0xffffff);
     uint32_t *wp = (uint32_t *) pkt_buffer;
     btea(wp+1, 5, key);
 
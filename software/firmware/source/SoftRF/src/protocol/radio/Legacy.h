@@ -194,6 +194,7 @@ typedef struct latest_packet
     byte lastbyte;
 } __attribute__((packed)) latest_packet_t;
 
+bool legacy_decode_header(void *, ufo_t *);
 bool legacy_decode(void *, container_t *, ufo_t *);
 bool latest_decode(void *, container_t *, ufo_t *);
 bool flr_adsl_decode(void *, container_t *, ufo_t *);
@@ -133,7 +133,7 @@ bool ogntp_decode(void *pkt, container_t *this_aircraft, ufo_t *fop) {
   fop->addr_type =
       (ogn_rx_pkt.Packet.Header.AddrType == ADDR_TYPE_ICAO ? ADDR_TYPE_ICAO : ADDR_TYPE_FLARM);
   fop->timestamp = this_aircraft->timestamp;
-  fop->gnsstime_ms = millis();
+  fop->gnsstime_ms = RF_last_rx_ms;
 
   fop->stealth   = ogn_rx_pkt.Packet.Position.Stealth;
   fop->no_track  = 0;
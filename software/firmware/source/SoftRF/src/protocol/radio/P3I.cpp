@@ -88,7 +88,7 @@ bool p3i_decode(void *p3i_pkt, container_t *this_aircraft, ufo_t *fop) {
 
   fop->addr_type = ADDR_TYPE_ICAO;     // was ADDR_TYPE_P3I but can't report that?
   fop->timestamp = timestamp;
-  fop->gnsstime_ms = millis();
+  fop->gnsstime_ms = RF_last_rx_ms;
 
   fop->latitude = pkt->latitude;
   fop->longitude = pkt->longitude;
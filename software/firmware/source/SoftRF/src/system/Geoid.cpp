@@ -0,0 +1,85 @@
+/*
+ * Geoid.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SoC.h"
+#include "Geoid.h"
+
+#if defined(USE_EGM96)
+
+#include <egm96s.h>
+
+#define GEOID_CELL_E7   20000000    /* 2 degrees in 1e-7 degree units */
+#define GEOID_STEP_E7      78125    /* 1/256 of a cell */
+
+/* corners of the most recently used cell - consecutive fixes share it */
+static struct {
+  int16_t row;
+  int16_t col;
+  int16_t v[4];                     /* NW, NE, SW, SE - meters */
+} geoid_cell = { -1, -1, { 0, 0, 0, 0 } };
+
+static inline int16_t geoid_node(int row, int col)
+{
+  return (int16_t) pgm_read_byte(&egm96s_dem[row * GEOID_COLS + col]) - 127;
+}
+
+int16_t Geoid_Separation_cm(int32_t lat_e7, int32_t lon_e7)
+{
+  if (lat_e7 >  900000000)  lat_e7 =  900000000;
+  if (lat_e7 < -900000000)  lat_e7 = -900000000;
+
+  /* distance south of 90N, and east of 0E, both non-negative */
+  uint32_t y = (uint32_t) (900000000 - lat_e7);
+  uint32_t x = (lon_e7 < 0 ? (uint32_t) (lon_e7 + 1800000000) + 1800000000u
+                           : (uint32_t) lon_e7);
+
+  int row = y / GEOID_CELL_E7;
+  int32_t wy = (y % GEOID_CELL_E7) / GEOID_STEP_E7;        /* 0..255 */
+  if (row >= GEOID_ROWS - 1) {      /* south of 88S: no row further south */
+    row = GEOID_ROWS - 2;
+    wy = 256;
+  }
+  int col = (x / GEOID_CELL_E7) % GEOID_COLS;
+  int32_t wx = (x % GEOID_CELL_E7) / GEOID_STEP_E7;
+
+  if (row != geoid_cell.row || col != geoid_cell.col) {
+    int col2 = (col == GEOID_COLS - 1 ? 0 : col + 1);    /* wrap at 0E */
+    geoid_cell.v[0] = geoid_node(row,   col);
+    geoid_cell.v[1] = geoid_node(row,   col2);
+    geoid_cell.v[2] = geoid_node(row+1, col);
+    geoid_cell.v[3] = geoid_node(row+1, col2);
+    geoid_cell.row = row;
+    geoid_cell.col = col;
+  }
+
+  const int16_t *v = geoid_cell.v;
+  int32_t n = v[0] * (256 - wx) + v[1] * wx;
+  int32_t s = v[2] * (256 - wx) + v[3] * wx;
+  int32_t sep = n * (256 - wy) + s * wy;                    /* meters * 65536 */
+
+  sep *= 100;                                               /* fits: |sep| < 2^30 */
+  return (int16_t) ((sep + (sep < 0 ? -32768 : 32768)) / 65536);
+}
+
+float Geoid_Separation(float lat, float lon)
+{
+  return 0.01f * (float) Geoid_Separation_cm((int32_t) (lat * 1e7f),
+                                             (int32_t) (lon * 1e7f));
+}
+
+#endif /* USE_EGM96 */
@@ -0,0 +1,36 @@
+/*
+ * Geoid.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEOID_H
+#define GEOID_H
+
+/*
+ * EGM96 geoid separation (height of the geoid above the WGS84 ellipsoid).
+ * The 2-degree grid in libraries/Geoid/egm96s.h (from XCSoar) has 90 rows,
+ * 90N down to 88S, of 180 columns, 0E eastwards, one byte each: meters + 127.
+ * It is read from flash (RAM on RPi) and interpolated bilinearly, so the
+ * result changes smoothly with position rather than in 2-degree steps.
+ */
+
+#define GEOID_ROWS   90
+#define GEOID_COLS  180
+
+int16_t Geoid_Separation_cm(int32_t lat_e7, int32_t lon_e7);   /* 1e-7 deg */
+float   Geoid_Separation(float lat, float lon);                 /* meters */
+
+#endif /* GEOID_H */
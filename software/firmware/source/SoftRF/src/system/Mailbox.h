@@ -0,0 +1,86 @@
+/*
+ * Mailbox.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdint.h>
+
+/*
+ * Hand-off of one job at a time from one core to the other, as used for
+ * decoding on the second core of the RP2040 (see ParseData_Post()).  The
+ * job's data is kept by the user next to the mailbox, and belongs to the
+ * poster while idle, to the worker from Mailbox_Post() to Mailbox_Done(),
+ * and to the poster again once Mailbox_Collect() returns.  The worker
+ * must not look at anything else the poster may be changing meanwhile.
+ * Only the compiler's builtins are used, so this also runs between two
+ * threads on a host, see tests/test_mailbox.cpp.
+ */
+
+#if !defined(MAILBOX_WAKE)
+#define MAILBOX_WAKE()          /* e.g. __sev(), if the worker does __wfe() */
+#endif
+
+#if !defined(MAILBOX_SPIN)
+#define MAILBOX_SPIN()          /* e.g. sched_yield() on a host */
+#endif
+
+enum
+{
+    MAILBOX_IDLE = 0,
+    MAILBOX_POSTED,
+    MAILBOX_DONE
+};
+
+typedef struct mailbox_struct {
+    uint8_t state;              /* only through the __atomic builtins */
+} mailbox_t;
+
+/* poster: hand the job over - it must be idle (collected) */
+static inline void Mailbox_Post(mailbox_t *mb)
+{
+    /* release: the job data is out before the state */
+    __atomic_store_n(&mb->state, MAILBOX_POSTED, __ATOMIC_RELEASE);
+    MAILBOX_WAKE();
+}
+
+/* worker: whether there is a job to do */
+static inline bool Mailbox_Take(mailbox_t *mb)
+{
+    /* acquire: the state is in before the job data */
+    return (__atomic_load_n(&mb->state, __ATOMIC_ACQUIRE) == MAILBOX_POSTED);
+}
+
+/* worker: done, the results are in the job data */
+static inline void Mailbox_Done(mailbox_t *mb)
+{
+    __atomic_store_n(&mb->state, MAILBOX_DONE, __ATOMIC_RELEASE);
+}
+
+/* poster: wait for the job to be done, false if none was posted */
+static inline bool Mailbox_Collect(mailbox_t *mb)
+{
+    if (__atomic_load_n(&mb->state, __ATOMIC_RELAXED) == MAILBOX_IDLE)
+        return false;
+    while (__atomic_load_n(&mb->state, __ATOMIC_ACQUIRE) != MAILBOX_DONE)
+        MAILBOX_SPIN();         /* typically long done by now */
+    __atomic_store_n(&mb->state, MAILBOX_IDLE, __ATOMIC_RELAXED);
+    return true;
+}
+
+#endif /* MAILBOX_H */
@@ -0,0 +1,137 @@
+/*
+ * Profiler.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SoC.h"
+#include "Profiler.h"
+
+#if defined(ENABLE_PROFILER)
+
+#include "../driver/Settings.h"
+#include "../protocol/data/NMEA.h"
+
+prof_stage_t prof_stages[PROF_STAGES];
+
+const char *prof_stage_names[PROF_STAGES] = {
+  [PROF_BARO]     = "Baro",
+  [PROF_GNSS]     = "GNSS",
+  [PROF_WIND]     = "Wind",
+  [PROF_TX]       = "RF TX",
+  [PROF_RX]       = "RF RX",
+  [PROF_PARSE]    = "Parse",
+  [PROF_TRAFFIC]  = "Traffic",
+  [PROF_LOG]      = "Flight log",
+  [PROF_SOUND]    = "Sound",
+  [PROF_EXPORT]   = "Export",
+  [PROF_NMEA_IN]  = "NMEA in",
+  [PROF_DISPLAY]  = "Display",
+  [PROF_WIFI]     = "WiFi+Web",
+  [PROF_SERIAL]   = "BT/USB/UART",
+  [PROF_LOOP]     = "Loop period",
+  [PROF_RX_ALARM] = "RX to alarm"
+};
+
+static uint32_t loop_start_us = 0;
+static uint32_t rx_mark_us = 0;
+static bool rx_pending = false;
+
+void Profiler_record(uint8_t stage, uint32_t us)
+{
+  prof_stage_t *p = &prof_stages[stage];
+
+  ++p->count;
+  if (us > p->peak_us)
+      p->peak_us = us;
+
+  int bucket = 0;
+  if (us >> PROF_BUCKET0_LOG2) {
+      bucket = (31 - __builtin_clz(us)) - (PROF_BUCKET0_LOG2 - 1);
+      if (bucket >= PROF_BUCKETS)
+          bucket = PROF_BUCKETS - 1;
+  }
+  ++p->hist[bucket];
+
+  ++p->win_count;
+  p->win_sum_us += us;
+  if (us > p->win_max_us)
+      p->win_max_us = us;
+}
+
+void Profiler_loop_start()
+{
+  uint32_t now_us = micros();
+  if (loop_start_us != 0)
+      Profiler_record(PROF_LOOP, now_us - loop_start_us);
+  loop_start_us = now_us;
+}
+
+/* called when a packet came in - keeps the oldest one not yet alarmed on */
+void Profiler_rx_mark()
+{
+  if (! rx_pending) {
+      rx_mark_us = micros();
+      rx_pending = true;
+  }
+}
+
+void Profiler_alarm_done()
+{
+  if (rx_pending) {
+      Profiler_record(PROF_RX_ALARM, micros() - rx_mark_us);
+      rx_pending = false;
+  }
+}
+
+static uint32_t win_max(uint8_t stage)
+{
+  uint32_t us = prof_stages[stage].win_max_us;
+  return (us > 999999 ? 999999 : us);
+}
+
+/*
+ * $PSRFP,<loop avg>,<loop max>,<rx-to-alarm max>,<max of each normal() stage>
+ *   - all in microseconds, over the time since the previous $PSRFP
+ */
+void Profiler_report()
+{
+  prof_stage_t *lp = &prof_stages[PROF_LOOP];
+  uint32_t loop_avg = (lp->win_count ? lp->win_sum_us / lp->win_count : 0);
+
+  snprintf_P(NMEABuffer, sizeof(NMEABuffer),
+      PSTR("$PSRFP,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u*"),
+      loop_avg, win_max(PROF_LOOP), win_max(PROF_RX_ALARM),
+      win_max(PROF_BARO),    win_max(PROF_GNSS),  win_max(PROF_WIND),
+      win_max(PROF_TX),      win_max(PROF_RX),    win_max(PROF_PARSE),
+      win_max(PROF_TRAFFIC), win_max(PROF_LOG),   win_max(PROF_SOUND),
+      win_max(PROF_EXPORT),  win_max(PROF_NMEA_IN));
+  NMEAOutC(NMEA_D);
+
+  for (int i=0; i<PROF_STAGES; i++) {
+      prof_stages[i].win_count  = 0;
+      prof_stages[i].win_sum_us = 0;
+      prof_stages[i].win_max_us = 0;
+  }
+}
+
+void Profiler_reset()
+{
+  memset(prof_stages, 0, sizeof(prof_stages));
+  loop_start_us = 0;
+  rx_pending = false;
+}
+
+#endif /* ENABLE_PROFILER */
@@ -0,0 +1,84 @@
+/*
+ * Profiler.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+ * Main loop timing: per-stage execution time, loop period, and the latency
+ * from a packet being received to the end of the alarm (sound) stage.
+ * Compiled out entirely unless ENABLE_PROFILER is defined for the platform.
+ */
+
+#if defined(ENABLE_PROFILER)
+
+enum
+{
+  PROF_BARO,
+  PROF_GNSS,
+  PROF_WIND,
+  PROF_TX,
+  PROF_RX,
+  PROF_PARSE,
+  PROF_TRAFFIC,
+  PROF_LOG,
+  PROF_SOUND,
+  PROF_EXPORT,
+  PROF_NMEA_IN,
+  PROF_DISPLAY,
+  PROF_WIFI,
+  PROF_SERIAL,
+  PROF_LOOP,        /* time between starts of loop() */
+  PROF_RX_ALARM,    /* packet received -> end of sound stage */
+  PROF_STAGES
+};
+
+/* log2 buckets: <128us, <256us, ... <128ms, >=128ms */
+#define PROF_BUCKETS      12
+#define PROF_BUCKET0_LOG2  7
+
+typedef struct {
+  uint32_t count;
+  uint32_t peak_us;                 /* since boot */
+  uint32_t hist[PROF_BUCKETS];      /* since boot */
+  uint32_t win_count;               /* since the last $PSRFP report */
+  uint32_t win_sum_us;
+  uint32_t win_max_us;
+} prof_stage_t;
+
+extern prof_stage_t prof_stages[PROF_STAGES];
+extern const char *prof_stage_names[PROF_STAGES];
+
+void Profiler_record(uint8_t stage, uint32_t us);
+void Profiler_loop_start(void);
+void Profiler_rx_mark(void);
+void Profiler_alarm_done(void);
+void Profiler_report(void);     /* $PSRFP, restarts the report window */
+void Profiler_reset(void);
+
+#define PROF_START(t)       uint32_t t = micros()
+#define PROF_END(stage, t)  Profiler_record((stage), micros() - (t))
+
+#else
+
+#define PROF_START(t)
+#define PROF_END(stage, t)
+
+#endif /* ENABLE_PROFILER */
+
+#endif /* PROFILER_H */
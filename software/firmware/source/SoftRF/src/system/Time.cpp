@@ -181,6 +181,149 @@ void Time_setup()
 #endif /* EXCLUDE_WIFI */
 #endif /* EXCLUDE_NTP */
 
+/*
+ * Disciplined clock for the Legacy-family time slots.
+ *
+ * Rather than jumping ref_time_ms to each new PPS (or to a fixed guess of the
+ * NMEA delay) and free-running on an assumed 1000 ms second in between, track
+ * the start of the GNSS second with a 2nd-order loop: phase (to 1 us) and the
+ * local oscillator period, i.e. its drift against GNSS time.  PPS edges are
+ * weighted heavily, NMEA-only fixes lightly.  The NMEA delay after the PPS is
+ * learned while PPS is present, so that on PPS dropouts the clock coasts on
+ * the learned drift and is steered by fixes corrected for the learned delay.
+ */
+
+#define CLK_PERIOD_NOM   1000000   /* us */
+#define CLK_PERIOD_TOL      1000   /* +- 1000 ppm */
+#define CLK_STEP_PPS       20000   /* phase errors larger than this (us) are */
+#define CLK_STEP_NMEA     150000   /*  outliers, or - if persistent - a step */
+
+static struct {
+  uint32_t ref_ms;          /* local millis() at the start of the current second */
+  int32_t  frac_us;         /* plus this, 0..999 */
+  int32_t  period_us;       /* local microseconds per GNSS second */
+  int32_t  latency_us[2];   /* fix committed this long after PPS: GGA first, RMC first */
+  uint8_t  latency_n[2];    /* samples behind latency_us, saturates */
+  uint8_t  state;           /* 0 = not set, 1 = phase set, 2 = tracking */
+  uint8_t  outliers;        /* consecutive */
+  uint16_t secs;            /* seconds since the last measurement */
+} clk = { 0, 0, CLK_PERIOD_NOM, {0, 0}, {0, 0}, 0, 0, 0 };
+
+static void Clock_shift(int32_t us)
+{
+  int32_t t = clk.frac_us + us;
+  int32_t ms = t / 1000;
+  t -= ms * 1000;
+  if (t < 0) {
+    t += 1000;
+    --ms;
+  }
+  clk.ref_ms += ms;
+  clk.frac_us = t;
+}
+
+/* microseconds from the start of the current second to local time ms,
+   64-bit as an int32_t overflows once the clock has gone 35 minutes unset */
+static inline int64_t Clock_since(uint32_t ms)
+{
+  return (int64_t) (int32_t) (ms - clk.ref_ms) * 1000 - clk.frac_us;
+}
+
+/* measurement: a second started at local time ms + adj_us */
+static void Clock_measure(uint32_t ms, int32_t adj_us, bool pps)
+{
+  if (clk.state == 0) {
+    clk.ref_ms = ms;
+    clk.frac_us = 0;
+    Clock_shift(adj_us);
+    clk.state = 1;
+    clk.secs = 0;
+    return;
+  }
+
+  /* offset from the nearest predicted second boundary */
+  int64_t d = Clock_since(ms) + adj_us;
+  int64_t n = (d >= 0 ? d + clk.period_us / 2 : d - clk.period_us / 2) / clk.period_us;
+  int32_t e = (int32_t) (d - n * clk.period_us);
+
+  if (abs(e) > (pps ? CLK_STEP_PPS : CLK_STEP_NMEA)) {
+    if (clk.state == 1 || ++clk.outliers >= 3) {   /* e.g. GNSS module restarted */
+      Clock_shift(e);
+      clk.state = 1;
+      clk.outliers = 0;
+      clk.secs = 0;
+    }
+    return;
+  }
+  clk.outliers = 0;
+
+  /* phase gain 1/4 (PPS) or 1/16 (NMEA), period gain critically damped */
+  Clock_shift(pps ? e / 4 : e / 16);
+  if (clk.state == 2 && clk.secs > 0) {
+    int32_t f = e / (int32_t) clk.secs;
+    clk.period_us += (pps ? f / 64 : f / 1024);
+    if (clk.period_us > CLK_PERIOD_NOM + CLK_PERIOD_TOL)
+        clk.period_us = CLK_PERIOD_NOM + CLK_PERIOD_TOL;
+    if (clk.period_us < CLK_PERIOD_NOM - CLK_PERIOD_TOL)
+        clk.period_us = CLK_PERIOD_NOM - CLK_PERIOD_TOL;
+  }
+  clk.state = 2;
+  clk.secs = 0;
+}
+
+/* a new fix was committed at commit_ms, pps_ms is the PPS before it, or 0 */
+static void Clock_fix(uint32_t commit_ms, uint32_t pps_ms, bool from_rmc)
+{
+  int i = (from_rmc ? 1 : 0);
+
+  if (pps_ms) {
+    int32_t lat = (int32_t) (commit_ms - pps_ms) * 1000;
+    if (clk.latency_n[i] == 0)
+      clk.latency_us[i] = lat;
+    else
+      clk.latency_us[i] += (lat - clk.latency_us[i]) / 16;
+    if (clk.latency_n[i] < 255)
+      ++clk.latency_n[i];
+    /* millis() truncates, the edge is on average half a ms after pps_ms */
+    Clock_measure(pps_ms, ADJ_FOR_FLARM_RECEPTION * 1000 + 500, true);
+  } else if (clk.latency_n[i] >= 8) {
+    /* PPS dropout: NMEA delay learned from the PPS history */
+    Clock_measure(commit_ms, ADJ_FOR_FLARM_RECEPTION * 1000 + 500 - clk.latency_us[i], false);
+  } else {
+    /* no PPS seen yet: module-specific guess of the NMEA delay */
+    uint16_t assumed_ms = 100;
+    if (gnss_chip)
+        assumed_ms = (from_rmc ? gnss_chip->rmc_ms : gnss_chip->gga_ms);
+    Clock_measure(commit_ms, -1000 * (int32_t) assumed_ms, false);
+  }
+}
+
+/* move to the second that contains now_ms, return the number of seconds passed */
+static int32_t Clock_advance(uint32_t now_ms)
+{
+  int32_t n = 0;
+
+  if (clk.state == 0)
+    return 0;
+  while (Clock_since(now_ms) >= clk.period_us) {
+    Clock_shift(clk.period_us);
+    ++n;
+  }
+  /* a correction may have moved the start of the second past now */
+  while (Clock_since(now_ms) < 0) {
+    Clock_shift(-clk.period_us);
+    --n;
+  }
+  if (n > 0 && clk.secs < 0xFFFF - n)
+    clk.secs += n;
+  return n;
+}
+
+static inline uint32_t Clock_ref_ms()
+{
+  return clk.ref_ms + (clk.frac_us >= 500 ? 1 : 0);
+}
+
 
 /* Experimental code by Moshe Braner, specific to Legacy and related protocols */
 void Time_loop()
@@ -226,7 +369,6 @@ void Time_loop()
 
     uint32_t gnss_age;
     uint32_t pps_btime_ms;
-    uint32_t newtime;
     uint32_t time_corr_neg;   // ms from PPS to commit_time
 
     bool newfix = false;
@@ -259,16 +401,8 @@ void Time_loop()
 
     } else {
 
-// also compute as if PPS not available, for a test
-uint32_t no_pps_corr;
-uint32_t no_pps_time;
-
     if (newfix) {
 
-        uint16_t assumed_ms = 100;
-        if (gnss_chip)
-            assumed_ms = (gnss_time_from_rmc? gnss_chip->rmc_ms : gnss_chip->gga_ms);
-
         if (latest_Commit_Time == 0)       // should not happen
             latest_Commit_Time = now_ms;
 
@@ -276,76 +410,48 @@ uint32_t no_pps_time;
         if (pps_btime_ms > 0) {
           if (latest_Commit_Time < pps_btime_ms)
               pps_btime_ms -= 1000;
-          newtime = pps_btime_ms + ADJ_FOR_FLARM_RECEPTION;   // seems to receive FLARM better
-          time_corr_neg = latest_Commit_Time - pps_btime_ms;
-/*
-          if (settings->debug_flags & DEBUG_DEEPER) {
-              Serial.print("New time at: ");
-              Serial.print(now_ms - pps_btime_ms);                   
-              Serial.print(" ms after PPS, gnss_age=");
-              Serial.println(gnss_age);
-          }
-*/
-no_pps_corr = assumed_ms;
-no_pps_time = latest_Commit_Time - no_pps_corr;
-
-        } else {   /* PPS not available */
-          time_corr_neg = assumed_ms;
-          newtime = latest_Commit_Time - time_corr_neg;
+          if (latest_Commit_Time - pps_btime_ms >= 1000)
+              pps_btime_ms = 0;            /* stale - PPS signal lost */
         }
-    
-        if ( /* newfix && */ gnss_age < 2500 && newtime > base_time_ms
-            && (pps_btime_ms == 0 || latest_Commit_Time > pps_btime_ms)) {
-            /* new data arrived from GNSS */
-/*
-            if (settings->debug_flags & DEBUG_DEEPER) {
-                Serial.print("New fix at: ");
-                Serial.print(now_ms - pps_btime_ms);                   
-                Serial.print(" ms after PPS at: ");
-                Serial.println(pps_btime_ms);
-            }
-*/
-        } else {
+
+        if (gnss_age < 2500)
+            Clock_fix(latest_Commit_Time, pps_btime_ms, gnss_time_from_rmc);
+        else
             newfix = false;
-        }
     }
 
-    bool freerun = false;
+    int32_t secs = Clock_advance(now_ms);
+
     if (now_ms - last_utc < 11111)
         newfix = false;   // keep on free-running
 
-    /* between fixes (but not before first fix): free-running clock */
+    /* between fixes (but not before first fix): the disciplined clock coasts */
     if (! newfix) {
-        if (ref_time_ms > 0 && now_ms >= ref_time_ms + 1000) {
-          OurTime += 1;
-          ref_time_ms += 1000;
+        if (ref_time_ms > 0) {
+          OurTime += secs;
+          ref_time_ms = Clock_ref_ms();
         }
         return;
     }
 
-    if (pps_btime_ms > 0) {
-      if (now_ms > pps_btime_ms + 1000) {
-        pps_btime_ms += 1000;
-        newtime += 1000;
-      }
-      //ref_time_ms = base_time_ms = newtime;  // = pps_btime_ms + ADJ_FOR_FLARM_RECEPTION
-      /* the adjusted time seems to better fit actual FLARM time slots */
-
-//if (settings->debug_flags & DEBUG_DEEPER) {
-////if ((OurTime & 0x03) == 0) {
-//int32_t diff = (int32_t)no_pps_time - (int32_t)newtime;
-//Serial.print("no-PPS error: ");
-//Serial.println(diff);
-////}
-//}
-    //} else {
-      //uint32_t last_RMC_Commit = now_ms - gnss.date.age();
-      //time_corr_neg = gnss_chip ? gnss_chip->rmc_ms : 100;
-      //ref_time_ms = base_time_ms = newtime;
+    ref_time_ms = base_time_ms = Clock_ref_ms();
+
+    /* time from the start of the second of the fix to its commit */
+    time_corr_neg = latest_Commit_Time - ref_time_ms;
+    if (latest_Commit_Time < ref_time_ms)
+        time_corr_neg += 1000;
+
+    if (settings->debug_flags & DEBUG_DEEPER) {
+        Serial.print(F("Clock: drift "));
+        Serial.print((int) (clk.period_us - CLK_PERIOD_NOM));
+        Serial.print(F(" ppm, NMEA delay "));
+        Serial.print((int) (clk.latency_us[0] / 1000));
+        Serial.print('/');
+        Serial.print((int) (clk.latency_us[1] / 1000));
+        Serial.print(F(" ms, PPS "));
+        Serial.println(pps_btime_ms ? "yes" : "no");
     }
 
-    ref_time_ms = base_time_ms = newtime;
-
     }   // end of if (settings->debug_flags & DEBUG_SIMULATE)
 
     int yr = gnss.date.year();
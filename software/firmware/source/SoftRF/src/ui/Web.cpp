@@ -57,6 +57,7 @@ void Web_fini()     {}
 #include "../protocol/data/GDL90.h"
 #include "../protocol/data/D1090.h"
 #include "../protocol/data/GNS5892.h"
+#include "../system/Profiler.h"
 
 #if defined(ENABLE_AHRS)
 #include "../driver/AHRS.h"
@@ -323,19 +324,6 @@ void anyUpload(bool toSD)
   yield();
 }
 
-#if defined(USE_EGM96)
-void egmUpload()   // into SPIFFS
-{
-    //Serial.println(F("Loading egm96s.dem into SPIFFS..."));
-    anyUpload(false);
-}
-#else
-void egmUpload()
-{
-    Serial.println(F("egm96s.dem ignored..."));
-}
-#endif
-
 void wavUpload()   // into SPIFFS
 {
     //Serial.println(F("Replacing waves.tar in SPIFFS..."));
@@ -2050,9 +2038,6 @@ void list_files(int mode)
   <tr>\
    <td><input type=button onClick=\"location.href='/clralrmlog'\" value='Clear Alarm Log'></td>\
    <td><input type=button onClick=\"location.href='/wavupload'\" value='Upload waves.tar'></td>"
-#if defined(USE_EGM96)
-  "<td><input type=button onClick=\"location.href='/egmupload'\" value='Upload egm96s.dem'></td>"
-#endif
   "<td><input type=button onClick=\"location.href='/format'\" value='FORMAT flash filesystem'></td>\
   </tr>\
  </table>"));
@@ -2267,6 +2252,118 @@ void confdelalarmlog()
     confirmDelete(FILE_OP_DELALRMLOG);
 }
 
+#if defined(ENABLE_PROFILER)
+// main loop timing: per-stage counts, average, peak and log2 histogram (since boot or reset)
+void handleProfile() {
+
+  if (server.hasArg("reset"))
+      Profiler_reset();
+
+  size_t size = 5000;
+  char *Prof_temp = (char *) malloc(size);
+  if (Prof_temp == NULL) {
+      Serial.println(F(">>> not enough RAM"));
+      return;
+  }
+
+  char *p = Prof_temp;
+  char *end = Prof_temp + size;
+  p += snprintf_P(p, end-p, PSTR("<html>\
+<head><meta name='viewport' content='width=device-width, initial-scale=1'>\
+<title>Loop timing</title><style>td{text-align:right}</style></head><body>\
+<h2 align=center>Main loop timing (microseconds)</h2>\
+<table width=100%%><tr><th align=left>Stage</th><th>Count</th><th>Avg</th><th>Peak</th>\
+<th>&lt;128</th><th>&lt;256</th><th>&lt;512</th><th>&lt;1ms</th><th>&lt;2ms</th><th>&lt;4ms</th>\
+<th>&lt;8ms</th><th>&lt;16ms</th><th>&lt;32ms</th><th>&lt;64ms</th><th>&lt;128ms</th><th>more</th></tr>"));
+
+  for (int i=0; i<PROF_STAGES && p < end; i++) {
+      prof_stage_t *sp = &prof_stages[i];
+      p += snprintf_P(p, end-p, PSTR("<tr><th align=left>%s</th><td>%u</td><td>%u</td><td>%u</td>"),
+                      prof_stage_names[i], sp->count,
+                      (sp->win_count ? sp->win_sum_us / sp->win_count : 0), sp->peak_us);
+      for (int b=0; b<PROF_BUCKETS && p < end; b++)
+          p += snprintf_P(p, end-p, PSTR("<td>%u</td>"), sp->hist[b]);
+      if (p < end)
+          p += snprintf_P(p, end-p, PSTR("</tr>"));
+  }
+  if (p < end)
+      snprintf_P(p, end-p, PSTR("</table><p>Avg is since the last $PSRFP report (every 10 sec).</p>\
+<p align=center><input type=button onClick=\"location.href='/profile?reset'\" value='Reset'>\
+ <input type=button onClick=\"location.href='/'\" value='Back'></p></body></html>"));
+
+  serve_html(Prof_temp);
+  free(Prof_temp);
+}
+#endif /* ENABLE_PROFILER */
+
+void coveragedownload()
+{
+    Coverage_save();     // fold in the journal of the current flight
+    if (! SPIFFS.exists("/coverage.bin")) {
+        server.send(404, textplain, "no coverage data yet");
+        return;
+    }
+    File file = SPIFFS.open("/coverage.bin", FILE_READ);
+    if (file) {
+        serve_file(file, "coverage.bin");
+        file.close();
+    }
+}
+
+void handleCoverage() {
+
+  static const char *cov_names[COV_PROTOCOLS] = { "FLARM", "ADS-L", "OGNTP", "FANET/P3I", "ADS-B" };
+  static const char *band_names[COV_BANDS] = { "&lt;-300", "-300..0", "0..300", "&gt;300" };
+
+  size_t size = 12000;
+  char *Cov_temp = (char *) malloc(size);
+  if (Cov_temp == NULL) {
+      Serial.println(F(">>> not enough RAM"));
+      return;
+  }
+
+  char *p = Cov_temp;
+  char *end = Cov_temp + size;
+  p += snprintf_P(p, end-p, PSTR("<html>\
+<head><meta name='viewport' content='width=device-width, initial-scale=1'>\
+<title>Coverage</title><style>td{text-align:right}</style></head><body>\
+<h2 align=center>Reception range, km (samples)</h2>\
+<p>By relative altitude (m) and direction relative to our heading (o'clock).</p>"));
+
+  for (int i=0; i<COV_PROTOCOLS && p < end; i++) {
+      int n = 0;
+      for (int b=0; b<COV_BANDS; b++)
+          for (int s=0; s<COV_SECTORS; s++)
+              n += coverage[i][b][s].n;
+      if (n == 0)
+          continue;
+      p += snprintf_P(p, end-p, PSTR("<h3>%s</h3><table width=100%%><tr><th align=left>alt</th>"),
+                      cov_names[i]);
+      for (int s=0; s<COV_SECTORS && p < end; s++)
+          p += snprintf_P(p, end-p, PSTR("<th>%d</th>"), (s==0? 12 : s));
+      for (int b=COV_BANDS-1; b>=0 && p < end; b--) {
+          p += snprintf_P(p, end-p, PSTR("</tr><tr><th align=left>%s</th>"), band_names[b]);
+          for (int s=0; s<COV_SECTORS && p < end; s++) {
+              cov_cell_t *cp = &coverage[i][b][s];
+              if (cp->n)
+                  p += snprintf_P(p, end-p, PSTR("<td>%.0f (%u)</td>"),
+                                  exp2((float) cp->range / (64.0 * 32.0)), cp->n);
+              else
+                  p += snprintf_P(p, end-p, PSTR("<td>-</td>"));
+          }
+      }
+      if (p < end)
+          p += snprintf_P(p, end-p, PSTR("</tr></table>"));
+  }
+  if (p < end)
+      snprintf_P(p, end-p, PSTR("<p align=center>\
+<input type=button onClick=\"location.href='/coveragebin'\" value='Download coverage.bin'>\
+ <input type=button onClick=\"location.href='/'\" value='Back'></p></body></html>"));
+
+  serve_html(Cov_temp);
+  free(Cov_temp);
+}
+
 void Web_setup()
 {
   server.on ( "/", handleRoot );
@@ -2283,6 +2380,12 @@ void Web_setup()
     serve_html(about_html);
   } );
 
+#if defined(ENABLE_PROFILER)
+  server.on ( "/profile", handleProfile );
+#endif
+  server.on ( "/coverage",    handleCoverage );
+  server.on ( "/coveragebin", coveragedownload );
+
   server.on ( "/show", []() {
     // put custom code here for debugging, for example:
     if (settings->rx1090)
@@ -2345,16 +2448,6 @@ void Web_setup()
     wavUpload                          // Receive and save the file
   );
 
-  server.on ( "/egmupload", []() {
-    char buf[320];
-    set_upload(buf, "egm96s.dem", "/doegmupld");
-    serve_html(buf);
-  } );
-  server.on ("/doegmupld", HTTP_POST,  // if the client posts to the upload page
-    [](){ server.send(200); },         // Send 200 to tell the client we are ready to receive
-    egmUpload                          // Receive and save the file
-  );
-
 #if defined(USE_SD_CARD)
   server.on ( "/logupload", []() {
     char buf[320];
@@ -430,6 +430,43 @@ const char *TinyGPSPlus::cardinal(float course)
 
 #endif
 
+void TinyGPSPlus::commitFix(const ymd_t *fixDate, const hmsc_t *fixTime, FixQuality quality,
+                            float lat, float lng, float alt, float sep,
+                            float knots, float deg, uint32_t sats, float dop)
+{
+  if (fixDate)
+  {
+    date.newDate = *fixDate;
+    date.commit();
+  }
+  if (fixTime)
+  {
+    time.newTime = *fixTime;
+    time.commit();
+  }
+  if (quality != Invalid)
+  {
+    ++sentencesWithFixCount;
+    location.NewLatitude = lat;
+    location.NewLongitude = lng;
+    location.newFixQuality = quality;
+    location.newFixMode = (quality == DGPS ? D : A);
+    location.commit();
+    altitude.newval = alt;
+    altitude.commit();
+    separation.newval = sep;
+    separation.commit();
+    speed.newval = knots;
+    speed.commit();
+    course.newval = deg;
+    course.commit();
+  }
+  satellites.newval = sats;
+  satellites.commit();
+  hdop.newval = dop;
+  hdop.commit();
+}
+
 void TinyGPSLocation::commit()
 {
    Latitude = NewLatitude;
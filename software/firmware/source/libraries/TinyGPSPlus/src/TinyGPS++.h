@@ -269,6 +269,12 @@ public:
   bool encode(char c); // process one character received from GPS
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
 
+  // commit a fix decoded elsewhere (e.g. u-blox binary NAV-PVT) as a GGA + RMC
+  // pair would: NULL date or time if not valid, quality Invalid if no fix
+  void commitFix(const ymd_t *fixDate, const hmsc_t *fixTime, FixQuality quality,
+                 float lat, float lng, float alt, float sep,
+                 float knots, float deg, uint32_t sats, float dop);
+
   TinyGPSLocation location;
   TinyGPSDate date;
   TinyGPSTime time;
@@ -0,0 +1,131 @@
+/*
+ * UDPRing.cpp
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "UDPRing.h"
+
+typedef struct udp_frame_struct {
+    uint16_t size;
+    uint8_t  source;
+    bool     truncated;
+} udp_frame_t;
+
+static uint8_t     udp_ring_buf[UDP_RING_FRAMES][UDP_RING_FRAME_SIZE];
+static udp_frame_t udp_ring[UDP_RING_FRAMES];
+static uint8_t     udp_ring_head = 0;    /* next slot to fill */
+static uint8_t     udp_ring_tail = 0;    /* next slot to read */
+static uint8_t     udp_ring_count = 0;
+
+udp_source_t udp_sources[UDP_MAX_SOURCES];
+
+/* find the source, or take over the one not heard from the longest */
+static uint8_t UDP_Source(uint32_t ip, uint16_t port)
+{
+  uint8_t oldest = 0;
+  for (uint8_t i = 0; i < UDP_MAX_SOURCES; i++) {
+    udp_source_t *sp = &udp_sources[i];
+    if (sp->packets + sp->dropped > 0 && sp->ip == ip && sp->port == port)
+      return i;
+    if (sp->last_ms < udp_sources[oldest].last_ms)
+      oldest = i;
+  }
+  memset(&udp_sources[oldest], 0, sizeof(udp_source_t));
+  udp_sources[oldest].ip   = ip;
+  udp_sources[oldest].port = port;
+  return oldest;
+}
+
+static udp_source_t *UDP_Count(uint32_t ip, uint16_t port, uint32_t now, uint8_t *index)
+{
+  uint8_t i = UDP_Source(ip, port);
+  udp_source_t *sp = &udp_sources[i];
+
+  if (now - sp->window_ms >= 1000) {
+    sp->pps = (now - sp->window_ms < 2000 ? sp->window_count : 0);
+    sp->window_ms = now;
+    sp->window_count = 0;
+  }
+  sp->window_count++;
+  sp->last_ms = now;
+  if (index)
+    *index = i;
+  return sp;
+}
+
+int UDP_Ring_Free()
+{
+  return UDP_RING_FRAMES - udp_ring_count;
+}
+
+/* buffer of the k-th free slot, k < UDP_Ring_Free(), UDP_RING_FRAME_SIZE long */
+uint8_t *UDP_Ring_Slot(int k)
+{
+  return udp_ring_buf[(udp_ring_head + k) % UDP_RING_FRAMES];
+}
+
+/*
+ * Queue the datagram just written into UDP_Ring_Slot(0).
+ * Size is as received, and may exceed the slot.
+ */
+void UDP_Ring_Commit(uint32_t ip, uint16_t port, size_t size, uint32_t now)
+{
+  uint8_t source;
+  udp_source_t *sp = UDP_Count(ip, port, now, &source);
+
+  bool truncated = (size > UDP_RING_FRAME_SIZE);
+  sp->packets++;
+  if (truncated) {
+    sp->truncated++;
+    size = UDP_RING_FRAME_SIZE;
+  }
+  udp_ring[udp_ring_head].size      = size;
+  udp_ring[udp_ring_head].source    = source;
+  udp_ring[udp_ring_head].truncated = truncated;
+  udp_ring_head = (udp_ring_head + 1) % UDP_RING_FRAMES;
+  udp_ring_count++;
+}
+
+/* a datagram was discarded because the ring was full */
+void UDP_Ring_Drop(uint32_t ip, uint16_t port, uint32_t now)
+{
+  UDP_Count(ip, port, now, NULL)->dropped++;
+}
+
+size_t UDP_Ring_Pop(uint8_t *buf, size_t max_size)
+{
+  if (udp_ring_count == 0)
+    return 0;
+
+  udp_frame_t *fp = &udp_ring[udp_ring_tail];
+  size_t size = fp->size;
+  if (size > max_size) {
+    if (! fp->truncated)
+      udp_sources[fp->source].truncated++;
+    size = max_size;
+  }
+  memcpy(buf, udp_ring_buf[udp_ring_tail], size);
+  udp_ring_tail = (udp_ring_tail + 1) % UDP_RING_FRAMES;
+  udp_ring_count--;
+  return size;
+}
+
+/* packets per second, zero once the source has gone quiet */
+uint16_t UDP_Source_Rate(const udp_source_t *sp, uint32_t now)
+{
+  return (now - sp->last_ms < 2000 ? sp->pps : 0);
+}
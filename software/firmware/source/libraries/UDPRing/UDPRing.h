@@ -0,0 +1,59 @@
+/*
+ * UDPRing.h
+ * Copyright (C) 2024 Moshe Braner
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDPRING_H
+#define UDPRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Incoming UDP datagrams, as used by both SoftRF and SkyView:  they are
+ * drained from the network stack into a ring of whole frames as soon as
+ * they are seen, and handed to the parsers from there.  The platform code
+ * fills the ring (from WiFiUDP, or with recvmmsg() on the RPi), and all
+ * datagrams are counted against the source address they came from.
+ * The caller supplies the time, so this has no platform dependencies.
+ */
+
+#define UDP_RING_FRAMES      8
+#define UDP_RING_FRAME_SIZE  256    /* same as UDP_PACKET_BUFSIZE */
+#define UDP_MAX_SOURCES      4
+
+typedef struct udp_source_struct {
+    uint32_t ip;            /* in network byte order */
+    uint16_t port;
+    uint16_t pps;           /* packets in the last full second */
+    uint32_t packets;
+    uint32_t dropped;       /* ring was full */
+    uint32_t truncated;     /* longer than the frame or the reader's buffer */
+    uint32_t last_ms;
+    uint32_t window_ms;
+    uint16_t window_count;
+} udp_source_t;
+
+int      UDP_Ring_Free(void);
+uint8_t *UDP_Ring_Slot(int);
+void     UDP_Ring_Commit(uint32_t, uint16_t, size_t, uint32_t);
+void     UDP_Ring_Drop(uint32_t, uint16_t, uint32_t);
+size_t   UDP_Ring_Pop(uint8_t *, size_t);
+uint16_t UDP_Source_Rate(const udp_source_t *, uint32_t);
+
+extern udp_source_t udp_sources[UDP_MAX_SOURCES];
+
+#endif /* UDPRING_H */
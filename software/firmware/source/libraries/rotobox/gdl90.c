@@ -48,6 +48,8 @@ uint16_t crc16table[256] PROGMEM = {
 };
 #endif
 
+static void unpack_gdl90_traffic_report(gdl_message_t *rawMsg, gdl90_msg_traffic_report_t *decodedMsg);
+
 void decode_gdl90_message(gdl_message_t *rawMsg) {
     gdl90_msg_heartbeat heartbeatMsg;
     gdl90_msg_traffic_report_t trafficReportMsg;
@@ -419,6 +421,12 @@ void print_gdl90_traffic_report(gdl90_msg_traffic_report_t *decodedMsg) {
 bool decode_gdl90_traffic_report(gdl_message_t *rawMsg, gdl90_msg_traffic_report_t *decodedMsg) {
     bool rval = gdl90_verifyCrc(rawMsg, GDL90_MSG_LEN_TRAFFIC_REPORT);
 
+    unpack_gdl90_traffic_report(rawMsg, decodedMsg);
+
+    return rval;
+}
+
+static void unpack_gdl90_traffic_report(gdl_message_t *rawMsg, gdl90_msg_traffic_report_t *decodedMsg) {
     decodedMsg->trafficAlertStatus = GDL90_DECODE_TRAFFIC_ALERT(rawMsg->data);
     decodedMsg->addressType = GDL90_DECODE_ADDRESS_TYPE(rawMsg->data);
     decodedMsg->address = GDL90_DECODE_ADDRESS(rawMsg->data);
@@ -443,8 +451,6 @@ bool decode_gdl90_traffic_report(gdl_message_t *rawMsg, gdl90_msg_traffic_report
     }
 
     decodedMsg->emergencyCode = GDL90_DECODE_EMERGENCY_CODE(rawMsg->data);
-
-    return rval;
 }
 
 void encode_gdl90_traffic_report(gdl_message_t *rawMsg, gdl90_msg_traffic_report_t *decodedMsg) {
@@ -540,12 +546,17 @@ void encode_gdl90_traffic_report(gdl_message_t *rawMsg, gdl90_msg_traffic_report
     rawMsg->data[GDL90_MSG_LEN_TRAFFIC_REPORT + 2] = GDL90_FLAG_BYTE;
 }
 
-bool decode_gdl90_ownship_geo_altitude(gdl_message_t *rawMsg, gdl90_msg_ownship_geo_altitude *decodedMsg) {
-    bool rval = gdl90_verifyCrc(rawMsg, GDL90_MSG_LEN_OWNSHIP_GEOMETRIC);
+static void unpack_gdl90_ownship_geo_altitude(gdl_message_t *rawMsg, gdl90_msg_ownship_geo_altitude *decodedMsg) {
     // pg 34 of GDL90 ICD
     decodedMsg->ownshipGeoAltitude = ((int16_t)((rawMsg->data[0] << 8) + rawMsg->data[1])) * GDL90_GEO_ALTITUDE_FACTOR;
     decodedMsg->verticalWarningIndicator = (bool)(rawMsg->data[2] >> 7);
     decodedMsg->verticalFigureOfMerit = (float)((rawMsg->data[2] << 8) + (rawMsg->data[3]) & 0x7FFF);
+}
+
+bool decode_gdl90_ownship_geo_altitude(gdl_message_t *rawMsg, gdl90_msg_ownship_geo_altitude *decodedMsg) {
+    bool rval = gdl90_verifyCrc(rawMsg, GDL90_MSG_LEN_OWNSHIP_GEOMETRIC);
+
+    unpack_gdl90_ownship_geo_altitude(rawMsg, decodedMsg);
 
     return rval;
 }
@@ -573,9 +584,7 @@ void encode_gdl90_ownship_geo_altitude(gdl_message_t *rawMsg, gdl90_msg_ownship_
     rawMsg->data[GDL90_MSG_LEN_OWNSHIP_GEOMETRIC + 2] = GDL90_FLAG_BYTE;
 }
 
-bool decode_gdl90_heartbeat(gdl_message_t *rawMsg, gdl90_msg_heartbeat *decodedMsg) {
-    bool rval = gdl90_verifyCrc(rawMsg, GDL90_MSG_LEN_HEARTBEAT);
-
+static void unpack_gdl90_heartbeat(gdl_message_t *rawMsg, gdl90_msg_heartbeat *decodedMsg) {
     decodedMsg->gpsPosValid = (bool)(rawMsg->data[0] >> 7);
     decodedMsg->maintReq = (bool)(rawMsg->data[0] >> 6);
     decodedMsg->ident = (bool)(rawMsg->data[0] >> 5);
@@ -593,6 +602,12 @@ bool decode_gdl90_heartbeat(gdl_message_t *rawMsg, gdl90_msg_heartbeat *decodedM
                                         (rawMsg->data[2]        << 8) +
                                         rawMsg->data[3]);
     decodedMsg->messageCounts = (uint16_t)((rawMsg->data[4] << 8) + rawMsg->data[5]);
+}
+
+bool decode_gdl90_heartbeat(gdl_message_t *rawMsg, gdl90_msg_heartbeat *decodedMsg) {
+    bool rval = gdl90_verifyCrc(rawMsg, GDL90_MSG_LEN_HEARTBEAT);
+
+    unpack_gdl90_heartbeat(rawMsg, decodedMsg);
 
     return rval;
 }
@@ -815,3 +830,123 @@ void gdl90_escape_message_for_tx(gdl_message_t *rawMsg, gdl_message_escaped_t *e
     // Update the length of our now escaped message
     escapedMsg->length = paddedIndex - 1;
 }
+
+void gdl90_stream_init(gdl90_stream_t *stream) {
+    memset(stream, 0, sizeof(gdl90_stream_t));
+    stream->msg.flag0 = GDL90_FLAG_BYTE;
+}
+
+// Payload length for the message IDs we decode, 0 for everything else
+static uint16_t gdl90_stream_payload_len(uint8_t messageId) {
+    switch (messageId) {
+        case(MSG_ID_HEARTBEAT):         return GDL90_MSG_LEN_HEARTBEAT;
+        case(MSG_ID_OWNSHIP_REPORT):    return GDL90_MSG_LEN_OWNSHIP_REPORT;
+        case(MSG_ID_OWNSHIP_GEOMETRIC): return GDL90_MSG_LEN_OWNSHIP_GEOMETRIC;
+        case(MSG_ID_TRAFFIC_REPORT):    return GDL90_MSG_LEN_TRAFFIC_REPORT;
+        default:                        return 0;
+    }
+}
+
+static void gdl90_stream_dispatch(gdl90_stream_t *stream, const gdl90_callbacks_t *callbacks) {
+    gdl_message_t *rawMsg = &stream->msg;
+    uint16_t payload_len = gdl90_stream_payload_len(rawMsg->messageId);
+
+    if (payload_len == 0)
+        return;
+
+    if (stream->length != payload_len + 3) {
+        stream->lengthErrors++;
+        return;
+    }
+
+    /* FCS covers the message ID and payload, sent LSB first */
+    uint16_t calc_crc = gdl90_crcCompute(&(rawMsg->messageId), payload_len + 1);
+    uint16_t rx_crc = (rawMsg->data[payload_len + 1] << 8) + rawMsg->data[payload_len];
+    if (calc_crc != rx_crc) {
+        stream->crcErrors++;
+        return;
+    }
+
+    stream->frames++;
+
+    switch (rawMsg->messageId) {
+        case(MSG_ID_HEARTBEAT):
+            if (callbacks->heartbeat) {
+                gdl90_msg_heartbeat heartbeat;
+                unpack_gdl90_heartbeat(rawMsg, &heartbeat);
+                callbacks->heartbeat(&heartbeat);
+            }
+            break;
+
+        case(MSG_ID_OWNSHIP_REPORT):
+        case(MSG_ID_TRAFFIC_REPORT):
+            {
+                void (*cb)(gdl90_msg_traffic_report_t *) =
+                    (rawMsg->messageId == MSG_ID_TRAFFIC_REPORT) ?
+                        callbacks->traffic : callbacks->ownship;
+                if (cb) {
+                    gdl90_msg_traffic_report_t report;
+                    unpack_gdl90_traffic_report(rawMsg, &report);
+                    cb(&report);
+                }
+            }
+            break;
+
+        case(MSG_ID_OWNSHIP_GEOMETRIC):
+            if (callbacks->ownship_geo_altitude) {
+                gdl90_msg_ownship_geo_altitude geo_altitude;
+                unpack_gdl90_ownship_geo_altitude(rawMsg, &geo_altitude);
+                callbacks->ownship_geo_altitude(&geo_altitude);
+            }
+            break;
+    }
+}
+
+void gdl90_stream_parse(gdl90_stream_t *stream, const uint8_t *buf, size_t len,
+                        const gdl90_callbacks_t *callbacks) {
+    /* room after the message ID: the longest message we decode plus its FCS */
+    const uint16_t max_length = 1 + GDL90_MSG_LEN_OWNSHIP_REPORT + 2;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = buf[i];
+
+        if (c == GDL90_FLAG_BYTE) {
+            // a closing flag may double as the opening flag of the next frame
+            if (stream->inFrame && !stream->escape && stream->length > 0) {
+                gdl90_stream_dispatch(stream, callbacks);
+            }
+            stream->inFrame = true;
+            stream->escape = false;
+            stream->length = 0;
+            continue;
+        }
+
+        if (!stream->inFrame) {
+            continue;
+        }
+
+        if (stream->escape) {
+            c ^= GDL90_ESCAPE_BYTE;
+            stream->escape = false;
+        } else if (c == GDL90_CONTROL_ESCAPE) {
+            stream->escape = true;
+            continue;
+        }
+
+        if (stream->length == 0) {
+            // skip uplink and other messages we do not decode up front
+            if (gdl90_stream_payload_len(c) == 0) {
+                stream->inFrame = false;
+                continue;
+            }
+            stream->msg.messageId = c;
+        } else if (stream->length < max_length) {
+            stream->msg.data[stream->length - 1] = c;
+        } else {
+            stream->lengthErrors++;
+            stream->inFrame = false;
+            continue;
+        }
+        stream->length++;
+    }
+}
@@ -263,4 +263,32 @@ void encode_gdl90_basic_uat_report(gdl_message_t *rawMsg, uint8_t *payload, uint
 void encode_gdl90_long_uat_report(gdl_message_t *rawMsg, uint8_t *payload, uint8_t payload_size);
 void gdl90_escape_message_for_tx(gdl_message_t *rawMsg, gdl_message_escaped_t *escapedMsg);
 
+/*
+ * Streaming receiver: feed it raw (escaped, flag-framed) bytes as they arrive.
+ * Each frame is unescaped in place into msg, its FCS is checked once with the
+ * CRC table when the closing flag arrives, and the decoded message is handed
+ * to the matching callback.  Callbacks may be NULL to ignore a message type.
+ */
+typedef struct {
+    void (*heartbeat)(gdl90_msg_heartbeat *decodedMsg);
+    void (*ownship)(gdl90_msg_traffic_report_t *decodedMsg);
+    void (*ownship_geo_altitude)(gdl90_msg_ownship_geo_altitude *decodedMsg);
+    void (*traffic)(gdl90_msg_traffic_report_t *decodedMsg);
+} gdl90_callbacks_t;
+
+typedef struct {
+    gdl_message_t msg;      // msg.messageId onwards holds the unescaped frame
+    uint16_t length;        // bytes stored: message ID + payload + FCS
+    bool inFrame;
+    bool escape;
+
+    uint32_t frames;        // frames with a good FCS
+    uint32_t crcErrors;
+    uint32_t lengthErrors;  // known message ID with the wrong payload length
+} gdl90_stream_t;
+
+void gdl90_stream_init(gdl90_stream_t *stream);
+void gdl90_stream_parse(gdl90_stream_t *stream, const uint8_t *buf, size_t len,
+                        const gdl90_callbacks_t *callbacks);
+
 #endif  // GDL90_H_
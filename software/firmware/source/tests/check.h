@@ -0,0 +1,32 @@
+/*
+ * check.h
+ * Minimal checks for the host tests - no test framework needed.
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+#define CHECK(cond)                                                       \
+  do {                                                                    \
+    if (!(cond)) {                                                        \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      check_failures++;                                                   \
+    }                                                                     \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tol)  CHECK(((a) - (b)) <= (tol) && ((b) - (a)) <= (tol))
+
+static inline int check_report(const char *name)
+{
+  if (check_failures)
+    printf("%s: %d check(s) FAILED\n", name, check_failures);
+  else
+    printf("%s: ok\n", name);
+  return (check_failures ? 1 : 0);
+}
+
+#endif /* CHECK_H */
@@ -0,0 +1,27 @@
+/*
+ * Arduino.h
+ * Just enough of the Arduino API for the host tests.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+#define PROGMEM
+#define pgm_read_byte(p)  (*(const uint8_t *) (p))
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+extern uint32_t host_millis;        /* set by the test */
+static inline uint32_t millis(void) { return host_millis; }
+
+#endif /* ARDUINO_H */
@@ -0,0 +1,114 @@
+/*
+ * test_mailbox.cpp
+ * Host test of the core-to-core job hand-off used for decoding on the
+ * second core of the RP2040, with a thread standing in for core1.  The
+ * poster changes its "globals" (packet buffer and metadata) right after
+ * each post, as RF_Receive() does, so a worker that read them instead of
+ * its job data would get the wrong packet's values.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define MAILBOX_SPIN()  sched_yield()     /* in case of a single CPU */
+#include <system/Mailbox.h>
+
+#include "check.h"
+
+#define JOBS        2000
+#define RAW_SIZE    24
+
+/* stand-ins for fo_raw and RF_last_* */
+static uint8_t  rx_raw[RAW_SIZE];
+static uint32_t rx_ms;
+static int8_t   rx_rssi;
+
+static struct {
+  mailbox_t box;
+  uint8_t   raw[RAW_SIZE];
+  uint32_t  ms;
+  int8_t    rssi;
+  uint32_t  sum;        /* result from the worker */
+} job;
+
+static bool quit = false;
+
+static void *worker(void *)
+{
+  while (!__atomic_load_n(&quit, __ATOMIC_RELAXED)) {
+    if (!Mailbox_Take(&job.box)) {
+      sched_yield();
+      continue;
+    }
+    uint32_t sum = job.ms;
+    for (int i = 0; i < RAW_SIZE; i++) {
+      sum = sum * 31 + job.raw[i];
+      if ((i & 7) == 0)
+        sched_yield();      /* give the poster a chance to race us */
+    }
+    job.sum = sum;
+    Mailbox_Done(&job.box);
+  }
+  return NULL;
+}
+
+static uint32_t expected(const uint8_t *raw, uint32_t ms)
+{
+  uint32_t sum = ms;
+  for (int i = 0; i < RAW_SIZE; i++)
+    sum = sum * 31 + raw[i];
+  return sum;
+}
+
+static void receive(int n)
+{
+  memset(rx_raw, (uint8_t) n, sizeof(rx_raw));
+  rx_raw[0] = (uint8_t) (n >> 8);
+  rx_ms     = 1000 + n;
+  rx_rssi   = (int8_t) (-(n % 100));
+}
+
+int main()
+{
+  pthread_t thread;
+  int collected = 0;
+  uint8_t  want_raw[RAW_SIZE];
+  uint32_t want_ms = 0;
+  int8_t   want_rssi = 0;
+
+  CHECK(!Mailbox_Collect(&job.box));        /* nothing posted yet */
+
+  pthread_create(&thread, NULL, worker, NULL);
+
+  for (int n = 0; n < JOBS; n++) {
+    receive(n);
+    /* ParseData_Post(): collect the previous job, then post this one */
+    if (Mailbox_Collect(&job.box)) {
+      CHECK(job.sum == expected(want_raw, want_ms));
+      CHECK(job.rssi == want_rssi);
+      collected++;
+    }
+    memcpy(job.raw, rx_raw, sizeof(job.raw));
+    job.ms   = rx_ms;
+    job.rssi = rx_rssi;
+    memcpy(want_raw, rx_raw, sizeof(want_raw));
+    want_ms   = rx_ms;
+    want_rssi = rx_rssi;
+    Mailbox_Post(&job.box);
+    /* the next packet arrives while the worker is busy */
+    receive(n + JOBS);
+  }
+  if (Mailbox_Collect(&job.box)) {
+    CHECK(job.sum == expected(want_raw, want_ms));
+    collected++;
+  }
+  CHECK(!Mailbox_Collect(&job.box));
+  CHECK(collected == JOBS);
+
+  __atomic_store_n(&quit, true, __ATOMIC_RELAXED);
+  pthread_join(thread, NULL);
+
+  return check_report("test_mailbox");
+}
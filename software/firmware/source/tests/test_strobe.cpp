@@ -0,0 +1,78 @@
+/*
+ * test_strobe.cpp
+ * Host test of the SkyStrobe threat arithmetic: the time to the closest
+ * approach, and the flash pattern interpolated by the threat demand.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "Threat.h"
+#include "Strobe.h"
+
+#include "check.h"
+
+static const strobe_pattern_t noalarm = { STROBE_FLASHES_NOALARM, STROBE_MS_NOALARM,
+                                          STROBE_MS_GAP, 0, STROBE_PERIOD_NOALARM };
+static const strobe_pattern_t alarm   = { STROBE_FLASHES_ALARM, STROBE_MS_ALARM,
+                                          STROBE_MS_GAP, 0, STROBE_PERIOD_ALARM };
+
+int main()
+{
+  strobe_pattern_t p;
+  float miss;
+
+  /* head-on, 1000 m apart, closing at 50 m/s */
+  CHECK_NEAR(Threat_TCPA(1000, 0, 30, 180, 20, 0, &miss), 20.0f, 0.01f);
+  CHECK_NEAR(miss, 0.0f, 0.01f);
+
+  /* the same, 100 m to the side */
+  CHECK_NEAR(Threat_TCPA(1000, 100, 30, 180, 20, 0, &miss), 20.0f, 0.01f);
+  CHECK_NEAR(miss, 100.0f, 0.1f);
+
+  /* crossing from the right at the same speed */
+  CHECK_NEAR(Threat_TCPA(0, 1000, 25, 270, 25, 0, &miss), 20.0f, 0.01f);
+  CHECK_NEAR(miss, 1000.0f / sqrtf(2.0f), 0.5f);
+
+  /* diverging, or flying in formation */
+  CHECK(Threat_TCPA(-1000, 0, 30, 180, 20, 0, &miss) < 0);
+  CHECK(Threat_TCPA(200, 0, 25, 90, 25, 90, &miss) < 0);
+
+  /* the ends of the range are the configured patterns */
+  Threat_Pattern(0, &noalarm, &alarm, &p);
+  CHECK(p.flashes == STROBE_FLASHES_NOALARM && p.on_ms == STROBE_MS_NOALARM);
+  CHECK(p.period_ms == STROBE_PERIOD_NOALARM && p.pause_ms == STROBE_MS_PAUSE_NOALARM);
+  Threat_Pattern(100, &noalarm, &alarm, &p);
+  CHECK(p.flashes == STROBE_FLASHES_ALARM && p.on_ms == STROBE_MS_ALARM);
+  CHECK(p.period_ms == STROBE_PERIOD_ALARM && p.pause_ms == STROBE_MS_PAUSE_ALARM);
+
+  /* in between, and a rising demand never slows the strobe */
+  Threat_Pattern(50, &noalarm, &alarm, &p);
+  CHECK(p.on_ms == 45 && p.period_ms == 1575);
+  int last = STROBE_PERIOD_NOALARM;
+  for (int d = 0; d <= 100; d++) {
+    Threat_Pattern(d, &noalarm, &alarm, &p);
+    CHECK(p.period_ms <= last);
+    CHECK(p.flashes * p.on_ms * 100 <= p.period_ms * STROBE_MAX_DUTY);
+    last = p.period_ms;
+  }
+
+  /* at most 100 bursts a minute, and a 20% duty cycle */
+  strobe_pattern_t fast = { 2, 50, 50, 0, 300 };
+  Threat_Pattern(100, &noalarm, &fast, &p);
+  CHECK(p.period_ms == STROBE_MIN_PERIOD);
+  strobe_pattern_t bright = { 5, 100, 50, 0, 1000 };
+  Threat_Pattern(100, &noalarm, &bright, &p);
+  CHECK(p.period_ms == 2500);
+  CHECK(p.pause_ms == 2500 - 5 * 150 + 50);
+
+  /* at least one flash, and a pause no shorter than the gap */
+  strobe_pattern_t none = { 0, 50, 50, 0, 600 };
+  Threat_Pattern(100, &noalarm, &none, &p);
+  CHECK(p.flashes == 1);
+  strobe_pattern_t full = { 6, 20, 100, 0, 600 };
+  Threat_Pattern(100, &noalarm, &full, &p);
+  CHECK(p.pause_ms == p.gap_ms);
+
+  return check_report("test_strobe");
+}
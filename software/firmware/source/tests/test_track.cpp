@@ -0,0 +1,78 @@
+/*
+ * test_track.cpp
+ * Host test of track_that(), the least-squares fit over the recent reports
+ * from another aircraft, and of the quality it assigns to the fit.
+ */
+
+#include <Arduino.h>
+#include <TinyGPS++.h>
+
+#include "../SoftRF/SoftRF.h"
+#include "../SoftRF/src/Wind.h"
+
+#include "check.h"
+
+uint32_t host_millis = 0;
+
+static void report(container_t *fop, uint32_t t_ms, float course, float speed, float alt)
+{
+  fop->gnsstime_ms = t_ms;
+  fop->course   = course;
+  fop->speed    = speed;
+  fop->altitude = alt;
+  track_that(fop);
+}
+
+int main()
+{
+  static container_t c;
+  history_t *hp = &c.history;
+
+  /* circling at 20 deg/s through north, climbing 2 m/s, one report per second */
+  memset(&c, 0, sizeof(c));
+  for (int i = 0; i < 6; i++)
+    report(&c, 10000 + 1000 * i, fmodf(300.0f + 20.0f * i, 360.0f), 50.0f, 1000.0f + 2.0f * i);
+  CHECK(hp->used == 6);
+  CHECK(hp->quality == HISTORY_QUALITY_GOOD);
+  CHECK_NEAR(hp->turnrate, 20.0f, 0.1f);
+  CHECK_NEAR(hp->course, 40.0f, 0.5f);
+  CHECK_NEAR(hp->speed, 50.0f, 0.1f);
+  CHECK_NEAR(hp->vs, 2.0f * _GPS_FEET_PER_METER * 60.0f, 5.0f);
+  c.vs = 0;
+  CHECK_NEAR(that_vs(&c), hp->vs, 0.01f);
+
+  /* a relayed copy of the latest report replaces it, an older one is ignored */
+  report(&c, 15000 + 200, 40.0f, 50.0f, 1010.0f);
+  CHECK(hp->count == 6);
+  report(&c, 14000, 20.0f, 50.0f, 1008.0f);
+  CHECK(hp->count == 6);
+
+  /* after a long gap the history starts over */
+  report(&c, 30000, 90.0f, 50.0f, 1000.0f);
+  CHECK(hp->count == 1);
+  CHECK(hp->quality == HISTORY_QUALITY_NONE);
+
+  /* 3 reports within 1.4 s: a fit, but not good enough to replace the
+     two-point turn rate or skip the staleness check (see project_that()) */
+  memset(&c, 0, sizeof(c));
+  for (int i = 0; i < 3; i++)
+    report(&c, 10000 + 700 * i, 90.0f + 30.0f * i, 50.0f, 1000.0f);
+  CHECK(hp->quality == HISTORY_QUALITY_LOW);
+  c.vs = 123.0f;
+  CHECK(that_vs(&c) == 123.0f);
+
+  /* too close together for any fit */
+  memset(&c, 0, sizeof(c));
+  for (int i = 0; i < 3; i++)
+    report(&c, 10000 + 500 * i, 90.0f, 50.0f, 1000.0f);
+  CHECK(hp->quality == HISTORY_QUALITY_NONE);
+
+  /* enough reports, but a scattered course */
+  memset(&c, 0, sizeof(c));
+  for (int i = 0; i < 6; i++)
+    report(&c, 10000 + 1000 * i, 90.0f + ((i & 1) ? 20.0f : -20.0f), 50.0f, 1000.0f);
+  CHECK(hp->course_rms > 10.0f);
+  CHECK(hp->quality == HISTORY_QUALITY_LOW);
+
+  return check_report("test_track");
+}
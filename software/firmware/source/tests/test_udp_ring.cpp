@@ -0,0 +1,95 @@
+/*
+ * test_udp_ring.cpp
+ * Host test of the UDP frame ring shared by SoftRF and SkyView.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <UDPRing.h>
+
+#include "check.h"
+
+static const uint32_t IP_A = 0x0104A8C0;     /* 192.168.4.1 */
+static const uint32_t IP_B = 0x0204A8C0;
+
+static void put(uint32_t ip, uint16_t port, uint8_t fill, size_t size, uint32_t now)
+{
+  if (UDP_Ring_Free() == 0) {
+    UDP_Ring_Drop(ip, port, now);
+    return;
+  }
+  size_t n = (size > UDP_RING_FRAME_SIZE ? UDP_RING_FRAME_SIZE : size);
+  memset(UDP_Ring_Slot(0), fill, n);
+  UDP_Ring_Commit(ip, port, size, now);
+}
+
+static udp_source_t *source(uint32_t ip, uint16_t port)
+{
+  for (int i = 0; i < UDP_MAX_SOURCES; i++)
+    if (udp_sources[i].ip == ip && udp_sources[i].port == port)
+      return &udp_sources[i];
+  return NULL;
+}
+
+int main()
+{
+  uint8_t buf[UDP_RING_FRAME_SIZE];
+
+  /* frames come out whole and in order */
+  CHECK(UDP_Ring_Free() == UDP_RING_FRAMES);
+  for (int i = 0; i < 3; i++)
+    put(IP_A, 4000, 'a' + i, 10 + i, 100);
+  for (int i = 0; i < 3; i++) {
+    CHECK(UDP_Ring_Pop(buf, sizeof(buf)) == (size_t) (10 + i));
+    CHECK(buf[0] == 'a' + i && buf[9 + i] == 'a' + i);
+  }
+  CHECK(UDP_Ring_Pop(buf, sizeof(buf)) == 0);
+
+  /* a full ring drops, and counts, the excess - then recovers */
+  for (int i = 0; i < UDP_RING_FRAMES + 3; i++)
+    put(IP_B, 4000, (uint8_t) i, 20, 200);
+  CHECK(UDP_Ring_Free() == 0);
+  udp_source_t *sp = source(IP_B, 4000);
+  CHECK(sp != NULL && sp->packets == UDP_RING_FRAMES && sp->dropped == 3);
+  for (int i = 0; i < UDP_RING_FRAMES; i++) {
+    CHECK(UDP_Ring_Pop(buf, sizeof(buf)) == 20);
+    CHECK(buf[0] == i);
+  }
+  put(IP_B, 4000, 'z', 5, 300);
+  CHECK(UDP_Ring_Pop(buf, sizeof(buf)) == 5 && buf[0] == 'z');
+
+  /* oversized datagrams, and small reader buffers, count as truncated */
+  put(IP_A, 4000, 'x', UDP_RING_FRAME_SIZE + 40, 400);
+  CHECK(UDP_Ring_Pop(buf, sizeof(buf)) == UDP_RING_FRAME_SIZE);
+  put(IP_A, 4000, 'y', 100, 400);
+  CHECK(UDP_Ring_Pop(buf, 50) == 50);
+  CHECK(source(IP_A, 4000)->truncated == 2);
+
+  /* the ring wraps around many times without losing anything */
+  for (int i = 0; i < 10 * UDP_RING_FRAMES; i++) {
+    put(IP_A, 4000, (uint8_t) i, 1 + (i % 50), 500);
+    CHECK(UDP_Ring_Pop(buf, sizeof(buf)) == (size_t) (1 + (i % 50)));
+    CHECK(buf[0] == (uint8_t) i);
+  }
+
+  /* rate over the last full second, zero once the source goes quiet */
+  memset(udp_sources, 0, sizeof(udp_sources));
+  for (int i = 0; i < 5; i++) {
+    put(IP_A, 5000, 0, 1, 10000 + 100 * i);
+    UDP_Ring_Pop(buf, sizeof(buf));
+  }
+  put(IP_A, 5000, 0, 1, 11000);
+  UDP_Ring_Pop(buf, sizeof(buf));
+  sp = source(IP_A, 5000);
+  CHECK(UDP_Source_Rate(sp, 11500) == 5);
+  CHECK(UDP_Source_Rate(sp, 13500) == 0);
+
+  /* more sources than slots: the one not heard from longest is replaced */
+  for (int i = 0; i < UDP_MAX_SOURCES; i++)
+    UDP_Ring_Drop(IP_B, 6000 + i, 20000 + i);
+  UDP_Ring_Drop(IP_B, 7000, 21000);
+  CHECK(source(IP_B, 6000) == NULL);
+  CHECK(source(IP_B, 6001) != NULL && source(IP_B, 7000) != NULL);
+
+  return check_report("udp_ring");
+}